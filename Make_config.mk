@@ -28,6 +28,11 @@ TSYS=linux
 OUT=rrpge
 #
 #
+# Output executable's name of the headless batch runner (make batch).
+#
+OUTB=rrpge_batch
+#
+#
 # A few paths in case they would be necessary. Leave them alone unless
 # it is necessary to modify.
 #
@@ -46,3 +51,10 @@ CC=gcc
 # symbols enabled.
 #
 GO=
+#
+#
+# Extra compiler flags. For example -DRRPGE_M_NOTHREADED builds the CPU
+# emulation with the function table dispatch instead of the threaded one,
+# which may be compared using the batch runner's benchmark (see batch.c).
+#
+CFEXT=
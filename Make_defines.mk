@@ -63,11 +63,13 @@ DIRSP?=/
 
 LINKB?=
 LINK= $(LINKB) -lSDLmain -lSDL
+LINKBAT= -lpthread
 
 OBB=_obj_
 OBD=$(OBB)$(DIRSP)
 
 CFLAGS+= -Wall -pipe -pedantic -Wno-unused-function
+CFLAGS+= $(CFEXT)
 ifneq ($(CC_BIN),)
 CFLAGS+= -B$(CC_BIN)
 endif
@@ -0,0 +1,1187 @@
+/**
+**  \file
+**  \brief     Headless batch runner
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.12
+**
+**
+**  Runs a number of emulation instances of one application on a pool of
+**  threads for a fixed number of frames as fast as possible, without any
+**  display or audio output, then reports the emulation throughput. The
+**  displayed lines are discarded, the audio is only summed into a checksum
+**  for each instance (instances of the same application should produce
+**  identical checksums).
+**
+**  Instead of an application, "-bench" may be given to run a built-in
+**  benchmark application: a 12 instruction ALU and data move loop counting
+**  its iterations in Data memory, so the emulated CPU instructions per second
+**  can be reported as well. Rendering is disabled for it. The figures given
+**  for the CPU dispatch methods (rgm_cpu.c) were measured by
+**
+**  make batch && ./rrpge_batch -bench 1 1 2000
+**
+**  then repeating it after "make clean", building with "make batch
+**  CFEXT=-DRRPGE_M_NOTHREADED" for the function table dispatch.
+**
+**  Instead of an application, "-native" may be given to check the native
+**  realizations of User Library routines (rgm_cpuh.c) against the emulated
+**  User Library: each routine is entered from random register and stack
+**  states both emulated and native, then the cycles, halt causes and the
+**  resulting emulation states are compared. The optional second parameter
+**  is the number of random states to try for each routine. The native runs
+**  are done in clones, so it also checks that a clone does not take over
+**  the frame buffer and frame callback of an instance rendering frames.
+**
+**  With "-check" before the application, the instances are run first on a
+**  single thread, then on the given number of threads, and the results of
+**  each instance (frames, cycles, audio checksum, halt cause and a checksum
+**  of its final emulation state by rrpge_snapshot()) are compared between
+**  the two runs and with the first instance. This is a stress test for the
+**  independence of concurrently running instances: any state shared between
+**  them shows up as mismatches.
+**
+**  Instead of an application, "-reinit" may be given to check initializing
+**  an instance again with an other application: an instance of the built-in
+**  benchmark application is run, then initialized with the benchmark having
+**  different initial data. Its memories are compared with those of an
+**  instance initialized directly with the latter.
+**
+**  With "-profile" before the application (which may be "-bench"), an
+**  instance of it is single stepped for the given number of frames (600 if
+**  omitted) counting the executed instruction pairs and triples by opcode
+**  group, then the most frequent ones are reported along with the share of
+**  instructions executed in the User Library and the share of skips
+**  followed by a JMS. With "-native" instead of the application, the
+**  emulated User Library routines are profiled from the states of the
+**  native check. This is the profile to find candidates for
+**  superinstructions (instructions fused with the next in the dispatch),
+**  such as by
+**
+**  make batch && ./rrpge_batch -profile -native 1000
+**
+**  The native check also reports the wall time of the emulated routines,
+**  to compare the dispatch of builds on the same workload.
+*/
+
+
+
+#include "host/types.h"
+#include "host/filels.h"
+
+#include "librrpge/rrpge.h"
+#include "librrpge/rrpge_db.h"
+
+#include "version.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <string.h>
+
+
+
+/* Maximal number of instances and threads */
+#define BATCH_INST_MAX 4096U
+#define BATCH_THR_MAX  256U
+
+/* Data memory location of the benchmark's 32 bit iteration counter, and the
+** number of instructions in its loop */
+#define BATCH_BENCH_CNT 0x2000U
+#define BATCH_BENCH_INS 12U
+
+/* Stack of the built-in application in Data memory (native check only uses
+** it), and the Code memory address of its supervisor op. used as return
+** address by the native check (halts with invalid op.) */
+#define BATCH_STK_BAS   0x4000U
+#define BATCH_STK_SIZ   0x0400U
+#define BATCH_NAT_RET   0x0010U
+
+/* Number of natively realized User Library entry points, the maximal fill
+** word count used for checking them (so they fit in a video line), and the
+** count of timed emulated runs from each state */
+#define BATCH_NAT_CNT   17U
+#define BATCH_NAT_FIL   41U
+#define BATCH_NAT_REP   64U
+
+/* Size of the initial data given to the built-in application for the
+** re-initialization check (in words, spanning several Data memory pages),
+** and the fill values of the two applications */
+#define BATCH_RIN_DSZ   0x0200U
+#define BATCH_RIN_FLA   0x1111U
+#define BATCH_RIN_FLB   0x2222U
+
+/* Number of the most frequent instruction pairs and triples reported by the
+** profile, and the User Library's start in the Code ROM */
+#define BATCH_PRF_TOP   16U
+#define BATCH_PRF_ULB   0xE000U
+
+
+/* Emulation instance's run results */
+typedef struct{
+ auint  frm;           /* Frames emulated */
+ double cyc;           /* Emulated CPU cycles */
+ auint  aud;           /* Checksum of the audio output */
+ auint  hlt;           /* Halt cause ending the run early (0: Completed) */
+ double ins;           /* Emulated CPU instructions (benchmark only) */
+ auint  sta;           /* Checksum of the final emulation state (check only) */
+ double wtm;           /* Wall time of the run in seconds */
+}batch_inst_t;
+
+
+/* Prototype for binary load kernel task */
+static void batch_loadbin(rrpge_object_t* hnd, rrpge_iuint tsh, const void* par);
+
+/* Prototype for the line callback */
+static void batch_line(rrpge_object_t* hnd, rrpge_iuint ln, rrpge_uint8 const* buf);
+
+/* Frame callback of the clone check, counting the frames in batch_nfrc */
+static void batch_frame(rrpge_object_t* hnd, void const* buf);
+static auint batch_nfrc = 0U;
+
+/* The application's binary, loaded entirely for initializing the first
+** emulation instance */
+static uint8* batch_app = NULL;
+static auint  batch_appsiz = 0U;
+
+/* The loaded application image, the instances are created over it */
+static rrpge_app_t* batch_img = NULL;
+
+/* Run parameters */
+static auint  batch_ninst = 1U;
+static auint  batch_nthr  = 1U;
+static auint  batch_nfrm  = 600U;
+static auint  batch_bench = 0U;
+static auint  batch_natck = 0U;
+static auint  batch_check = 0U;
+static auint  batch_rinck = 0U;
+static auint  batch_prfck = 0U;
+
+/* Instance results, and the single threaded results for the check */
+static batch_inst_t batch_inst[BATCH_INST_MAX];
+static batch_inst_t batch_iref[BATCH_INST_MAX];
+
+/* Next instance to run by the thread pool, with its lock */
+static auint  batch_next = 0U;
+static pthread_mutex_t batch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Application name string */
+static char const* batch_appname = "RRPGE headless batch runner. Version: " EMULATOR_VERSION;
+
+/* Other elements */
+static char const* batch_appauth = "By: Sandor Zsuga (Jubatian)\n";
+static char const* batch_copyrig = "Copyright: 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public\nLicense) extended as RRPGEvt (temporary version of the RRPGE License):\nsee LICENSE.GPLv3 and LICENSE.RRPGEvt in the project root.\n";
+
+
+/* Code of the benchmark application: sets X3 to 1, then runs the loop
+** (the memory accessing instructions take two words). It is followed by a
+** supervisor op. (0x9000) for the native check. */
+static const uint16 batch_bench_code[17] = {
+ 0x03C1U,           /* MOV X3, 1 */
+ 0x0A37U,           /* ADD A, X3 (loop start) */
+ 0x7270U,           /* XOR B, A */
+ 0x02F1U,           /* MOV D, B */
+ 0x2EC3U,           /* SHL D, 3 */
+ 0x0AF0U,           /* ADD D, A */
+ 0x0333U,           /* MOV X0, D */
+ 0x0F31U,           /* SUB X0, B */
+ 0xB307U,           /* AND X0, 7 */
+ 0x0128U, 0x2002U,  /* MOV [0x2002], X0 */
+ 0x49E8U, 0x2000U,  /* ADD C:[0x2000], X3 (iteration counter, low) */
+ 0x08A8U, 0x2001U,  /* ADD [0x2001], C (iteration counter, high) */
+ 0x8FF2U,           /* JMS -14 (to loop start) */
+ 0x9000U            /* Supervisor op. (invalid op. in user mode) */
+};
+
+/* Natively realized User Library entry points (rgm_cpuh.c), and the stack
+** offset of their fill word count parameter (0xFF: none) */
+static const uint16 batch_nat_ent[BATCH_NAT_CNT] = {
+ 0xE000U, 0xE002U, 0xE004U, 0xE006U, 0xE008U, 0xE00AU, 0xE00CU, 0xE00EU,
+ 0xE010U, 0xE012U, 0xE014U, 0xE016U, 0xE018U, 0xE01AU, 0xE01CU,
+ 0xE028U, 0xE02AU};
+static const uint8  batch_nat_fil[BATCH_NAT_CNT] = {
+ 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+ 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+ 3U,    2U};
+
+
+/* Tasks */
+static const rrpge_cbd_tsk_t batch_cbtsk[1] = {
+ { RRPGE_CB_LOADBIN,   &batch_loadbin      }
+};
+
+/* Callback structure for the emulator: only binary loading and the line
+** callback (the palette is not needed without display) */
+static const rrpge_cbpack_t batch_cbpack={
+ &batch_line,
+ 1,                           /* Task callbacks */
+ &batch_cbtsk[0],
+ 0,                           /* Subroutine callbacks */
+ NULL,
+ 0,                           /* Function callbacks */
+ NULL
+};
+
+
+
+/* Loads binary page, kernel task callback. Areas beyond the end of the
+** application's binary are zero filled. */
+static void batch_loadbin(rrpge_object_t* hnd, rrpge_iuint tsh, const void* par)
+{
+ const rrpge_cbp_loadbin_t* p = (const rrpge_cbp_loadbin_t*)(par);
+ auint i;
+ auint l;
+ auint o = (p->sow) << 1;
+
+ if (o < batch_appsiz){ l = batch_appsiz - o; }
+ else                 { l = 0U; }
+ if (l > ((p->scw) << 1)){ l = (p->scw) << 1; }
+
+ if (l != 0U){ rrpge_conv_b2w(&batch_app[o], (p->buf), l); }
+ for (i = (l + 1U) >> 1; i < (p->scw); i++){
+  (p->buf)[i] = 0U;
+ }
+ rrpge_taskend(hnd, tsh, 0x8000U);
+}
+
+
+
+/* Builds the benchmark application's binary into batch_app: the header,
+** the descriptor at 0x0040 and the code at 0x0050 (words). If "fil" is
+** nonzero, initial data of BATCH_RIN_DSZ words of this value follows the
+** code, otherwise there is no data. The stack is within Data memory, so the
+** native check can set it up. */
+static void batch_mkbench(auint fil)
+{
+ static char const hdr[] =
+  "RPA\n\nAppAuth: Jubatian        \n"
+  "AppName: Batch runner benchmark            \n"
+  "Version: 00.000.001\n"
+  "EngSpec: 00.015.000\n"
+  "DescOff: 0040";
+ static uint16 dsc[12] = {
+  0x0000U, 0x0070U,  /* Size of the binary (without data) */
+  0x0000U, 0x0050U,  /* Code offset */
+  0x0000U, 0x0070U,  /* Data offset */
+  0x0011U,           /* Code size */
+  0x0000U,           /* Data size (if none) */
+  BATCH_STK_SIZ,     /* Stack size */
+  BATCH_STK_BAS,     /* Stack base */
+  0x0000U, 0x0000U
+ };
+ auint i;
+ auint d = (fil != 0U) ? BATCH_RIN_DSZ : 0U;
+
+ dsc[1] = 0x70U + d;
+ dsc[7] = d;
+ batch_appsiz = (0x70U + d) << 1;
+ batch_app = malloc(batch_appsiz);
+ if (batch_app == NULL){
+  printf("Failed to allocate memory for the application\n");
+  exit(1);
+ }
+ memset(batch_app, 0, batch_appsiz);
+ memcpy(batch_app, hdr, sizeof(hdr) - 1U);
+ for (i = 0U; i < 12U; i++){
+  batch_app[((0x40U + i) << 1)     ] = (uint8)(dsc[i] >> 8);
+  batch_app[((0x40U + i) << 1) + 1U] = (uint8)(dsc[i]);
+ }
+ for (i = 0U; i < 17U; i++){
+  batch_app[((0x50U + i) << 1)     ] = (uint8)(batch_bench_code[i] >> 8);
+  batch_app[((0x50U + i) << 1) + 1U] = (uint8)(batch_bench_code[i]);
+ }
+ for (i = 0U; i < d; i++){
+  batch_app[((0x70U + i) << 1)     ] = (uint8)(fil >> 8);
+  batch_app[((0x70U + i) << 1) + 1U] = (uint8)(fil);
+ }
+}
+
+
+
+/* Line callback: the lines are discarded */
+static void batch_line(rrpge_object_t* hnd, rrpge_iuint ln, rrpge_uint8 const* buf)
+{
+}
+
+
+
+/* Frame callback: only counts the frames */
+static void batch_frame(rrpge_object_t* hnd, void const* buf)
+{
+ batch_nfrc ++;
+}
+
+
+
+/* Wrapper for malloc to fix type */
+static void* batch_malloc(rrpge_iuint siz)
+{
+ return malloc(siz);
+}
+
+
+
+/* Returns a monotonic wall time in seconds */
+static double batch_time(void)
+{
+ struct timespec t;
+ clock_gettime(CLOCK_MONOTONIC, &t);
+ return (double)(t.tv_sec) + ((double)(t.tv_nsec) / 1000000000.0);
+}
+
+
+
+/* Returns a checksum of the complete emulation state of an instance, using
+** a snapshot of it */
+static auint batch_stasum(rrpge_object_t* emu)
+{
+ auint  i;
+ auint  s = 0U;
+ auint  siz = rrpge_snapsize();
+ uint8* snp = calloc(siz, 1U);
+
+ if (snp == NULL){ return 0U; }
+ rrpge_snapshot(emu, snp);
+ for (i = 0U; i < siz; i++){
+  s = ((s * 33U) ^ (auint)(snp[i])) & 0xFFFFFFFFU;
+ }
+ free(snp);
+
+ return s;
+}
+
+
+
+/* Creates, runs and deletes one emulation instance, filling in its results */
+static void batch_run(batch_inst_t* ins)
+{
+ auint   i;
+ auint   t;
+ uint16  lbuf[512];
+ uint16  rbuf[512];
+ rrpge_object_t* emu;
+
+ ins->frm = 0U;
+ ins->cyc = 0.0;
+ ins->aud = 0U;
+ ins->hlt = 0U;
+ ins->ins = 0.0;
+ ins->sta = 0U;
+ ins->wtm = batch_time();
+
+ emu = rrpge_new_emu_app(&batch_cbpack, batch_img);
+ if (emu == NULL){
+  ins->hlt = RRPGE_HLT_FAULT;
+  ins->wtm = 0.0;
+  return;
+ }
+ if (batch_bench != 0U){ rrpge_enarender(emu, 0U); }
+
+ while ((ins->hlt == 0U) && (ins->frm < batch_nfrm)){
+
+  ins->cyc += (double)(rrpge_run(emu, RRPGE_RUN_FREE));
+  t = rrpge_gethaltcause(emu);
+
+  if ((t & RRPGE_HLT_AUDIO) != 0U){
+   rrpge_getaudio(emu, &lbuf[0], &rbuf[0]);
+   for (i = 0U; i < 512U; i++){
+    ins->aud = ((ins->aud * 33U) ^
+                (((auint)(lbuf[i]) << 16) | (auint)(rbuf[i]))) & 0xFFFFFFFFU;
+   }
+  }
+
+  if ((t & RRPGE_HLT_FRAME) != 0U){ ins->frm ++; }
+
+  ins->hlt = t & (RRPGE_HLT_EXIT |
+                  RRPGE_HLT_STACK |
+                  RRPGE_HLT_INVKCALL |
+                  RRPGE_HLT_INVOP |
+                  RRPGE_HLT_FAULT |
+                  RRPGE_HLT_DETACHED |
+                  RRPGE_HLT_WAIT);
+ }
+
+ if (batch_check != 0U){
+  ins->sta = batch_stasum(emu);
+ }
+
+ if (batch_bench != 0U){
+  ins->ins = ((double)(rrpge_get_dram(emu, BATCH_BENCH_CNT)) +
+              ((double)(rrpge_get_dram(emu, BATCH_BENCH_CNT + 1U)) * 65536.0)) *
+             (double)(BATCH_BENCH_INS);
+ }
+
+ rrpge_delete(emu);
+
+ ins->wtm = batch_time() - ins->wtm;
+}
+
+
+
+/* Thread pool worker: runs instances until none remain */
+static void* batch_worker(void* par)
+{
+ auint i;
+
+ while (1){
+  pthread_mutex_lock(&batch_lock);
+  i = batch_next;
+  if (i < batch_ninst){ batch_next ++; }
+  pthread_mutex_unlock(&batch_lock);
+  if (i >= batch_ninst){ break; }
+  batch_run(&batch_inst[i]);
+ }
+
+ return NULL;
+}
+
+
+
+/* Runs all instances on the given number of threads. Returns the number of
+** threads which could be created, exits if none. */
+static auint batch_pool(auint nthr)
+{
+ auint     i;
+ auint     n;
+ pthread_t thr[BATCH_THR_MAX];
+
+ batch_next = 0U;
+ for (n = 0U; n < nthr; n++){
+  if (pthread_create(&thr[n], NULL, &batch_worker, NULL) != 0){ break; }
+ }
+ if (n == 0U){
+  printf("Failed to create threads\n");
+  exit(1);
+ }
+ for (i = 0U; i < n; i++){
+  pthread_join(thr[i], NULL);
+ }
+
+ return n;
+}
+
+
+
+/* Compares the results of an instance with a reference, returns nonzero if
+** they differ (the timing related fields are not compared) */
+static auint batch_differs(batch_inst_t const* ins, batch_inst_t const* ref)
+{
+ return ( (ins->frm != ref->frm) ||
+          (ins->cyc != ref->cyc) ||
+          (ins->aud != ref->aud) ||
+          (ins->hlt != ref->hlt) ||
+          (ins->sta != ref->sta) );
+}
+
+
+
+/* Returns the next 16 bit value of the native check's random generator */
+static auint batch_rnd(auint* sed)
+{
+ *sed = ((*sed * 1103515245U) + 12345U) & 0xFFFFFFFFU;
+ return ((*sed) >> 8) & 0xFFFFU;
+}
+
+
+
+/* Prepares an instance to enter the "e"th native User Library routine from
+** the "n"th random state: random registers and stack frame, returning to
+** the supervisor op. */
+static void batch_natset(rrpge_object_t* emu, auint e, auint n)
+{
+ auint   i;
+ auint   bp;
+ auint   sed;
+
+ /* Random registers and stack frame. The frame returns to the supervisor
+ ** op., its previous base pointer is within the stack. */
+
+ sed = (e << 20) + n;
+ for (i = 0U; i < 10U; i++){
+  rrpge_set_state(emu, RRPGE_STA_VARS + i, batch_rnd(&sed));
+ }
+ bp = BATCH_STK_BAS + 0x100U + (batch_rnd(&sed) & 0xFFU);
+ rrpge_set_dram(emu, bp - 2U, BATCH_NAT_RET);
+ rrpge_set_dram(emu, bp - 1U, BATCH_STK_BAS + 0x40U);
+ for (i = 0U; i < 8U; i++){
+  rrpge_set_dram(emu, bp + i, batch_rnd(&sed));
+ }
+ if (batch_nat_fil[e] != 0xFFU){
+  rrpge_set_dram(emu, bp + batch_nat_fil[e], batch_rnd(&sed) % BATCH_NAT_FIL);
+ }
+ rrpge_set_state(emu, RRPGE_STA_VARS + 0x0AU, batch_nat_ent[e]);
+ rrpge_set_state(emu, RRPGE_STA_VARS + 0x0BU, 8U);
+ rrpge_set_state(emu, RRPGE_STA_VARS + 0x0CU, bp);
+}
+
+
+
+/* Creates an instance of the benchmark application, prepared by
+** batch_natset(). Exits on failure. */
+static rrpge_object_t* batch_natnew(auint e, auint n)
+{
+ rrpge_object_t* emu;
+
+ emu = rrpge_new_emu_app(&batch_cbpack, batch_img);
+ if (emu == NULL){
+  printf("Failed to allocate emulator state\n");
+  exit(1);
+ }
+ rrpge_enarender(emu, 0U);
+
+ /* Step the first instruction, so the run starts within a video line
+ ** (otherwise no native routine fits in the remaining cycles). */
+
+ rrpge_run(emu, RRPGE_RUN_SINGLE);
+
+ batch_natset(emu, e, n);
+
+ return emu;
+}
+
+
+
+/* Native check: enters each native User Library routine from random states
+** in an instance and in its clone with native routines enabled, and runs
+** both until the return to the supervisor op. (or any other halt). The
+** cycles, halt causes and emulation states must match. Returns the number
+** of mismatches. Then the emulated routine is entered again from the same
+** state in the (by now decoded) instance, the wall time and cycles of these
+** runs are accumulated in "wtm" and "cyc". */
+static auint batch_native(auint ntr, double* wtm, double* cyc)
+{
+ auint   e;
+ auint   n;
+ auint   i;
+ auint   cya;
+ auint   cyb;
+ auint   hla;
+ auint   hlb;
+ auint   bad = 0U;
+ auint   siz = rrpge_snapsize();
+ void*   sna = malloc(siz);
+ void*   snb = malloc(siz);
+ rrpge_object_t* emu;
+ rrpge_object_t* nat;
+
+ if ((sna == NULL) || (snb == NULL)){
+  printf("Failed to allocate snapshot buffers\n");
+  exit(1);
+ }
+
+ for (e = 0U; e < BATCH_NAT_CNT; e++){
+  for (n = 0U; n < ntr; n++){
+
+   /* Run emulated and native from the same state */
+
+   emu = batch_natnew(e, n);
+
+   nat = rrpge_clone(emu);
+   if (nat == NULL){
+    printf("Failed to clone emulator state\n");
+    exit(1);
+   }
+   rrpge_enanative(nat, 1U);
+
+   cya = rrpge_run(emu, RRPGE_RUN_FREE);
+   hla = rrpge_gethaltcause(emu);
+   cyb = rrpge_run(nat, RRPGE_RUN_FREE);
+   hlb = rrpge_gethaltcause(nat);
+
+   rrpge_enanative(nat, 0U);
+   rrpge_snapshot(emu, sna);
+   rrpge_snapshot(nat, snb);
+
+   if ( (cya != cyb) ||
+        (hla != hlb) ||
+        (memcmp(sna, snb, siz) != 0) ){
+    printf("Mismatch: entry 0x%04X, state %u (cycles %u / %u, halt %04X / %04X)\n",
+           batch_nat_ent[e], n, cya, cyb, hla, hlb);
+    bad ++;
+   }
+
+   for (i = 0U; i < BATCH_NAT_REP; i++){
+    batch_natset(emu, e, n);
+    *wtm -= batch_time();
+    *cyc += (double)(rrpge_run(emu, RRPGE_RUN_FREE));
+    *wtm += batch_time();
+   }
+
+   rrpge_delete(nat);
+   rrpge_delete(emu);
+  }
+ }
+
+ free(sna);
+ free(snb);
+
+ return bad;
+}
+
+
+
+/* Runs an instance for the given count of frames, or until it halts other
+** than for frame or audio. */
+static void batch_runfrm(rrpge_object_t* emu, auint nfrm)
+{
+ auint   t;
+ auint   frm = 0U;
+ uint16  lbuf[512];
+ uint16  rbuf[512];
+
+ while (frm < nfrm){
+  (void)(rrpge_run(emu, RRPGE_RUN_FREE));
+  t = rrpge_gethaltcause(emu);
+  if ((t & RRPGE_HLT_AUDIO) != 0U){ rrpge_getaudio(emu, &lbuf[0], &rbuf[0]); }
+  if ((t & RRPGE_HLT_FRAME) != 0U){ frm ++; }
+  if ((t & (~(auint)(RRPGE_HLT_FRAME | RRPGE_HLT_AUDIO))) != 0U){ break; }
+ }
+}
+
+
+
+/* Clone check of frame rendering: the frame buffer and the frame callback
+** of an instance are not cloned, so its clone has to render through the
+** line callback, leaving the source's frame buffer alone. The source then
+** has to render in it, showing the check is effective. Returns the number
+** of mismatches. */
+static auint batch_clonefrm(void)
+{
+ auint   i;
+ auint   bad = 0U;
+ uint16* fbuf = malloc(640U * 400U * sizeof(uint16));
+ rrpge_object_t* emu;
+ rrpge_object_t* cln;
+
+ if (fbuf == NULL){
+  printf("Failed to allocate frame buffer\n");
+  exit(1);
+ }
+ for (i = 0U; i < (640U * 400U); i++){ fbuf[i] = 0x5A5AU; }
+
+ emu = rrpge_new_emu_app(&batch_cbpack, batch_img);
+ if (emu == NULL){
+  printf("Failed to allocate emulator state\n");
+  exit(1);
+ }
+ rrpge_setframe(emu, fbuf, 640U * sizeof(uint16), RRPGE_PIX_RGB565, &batch_frame);
+ cln = rrpge_clone(emu);
+ if (cln == NULL){
+  printf("Failed to clone emulator state\n");
+  exit(1);
+ }
+
+ batch_nfrc = 0U;
+ batch_runfrm(cln, 3U);
+ for (i = 0U; i < (640U * 400U); i++){
+  if (fbuf[i] != 0x5A5AU){ break; }
+ }
+ if ((batch_nfrc != 0U) || (i != (640U * 400U))){
+  printf("Mismatch: the clone rendered in the source's frame buffer (%u frame callbacks)\n",
+         batch_nfrc);
+  bad ++;
+ }
+
+ batch_runfrm(emu, 3U);
+ for (i = 0U; i < (640U * 400U); i++){
+  if (fbuf[i] != 0x5A5AU){ break; }
+ }
+ if ((batch_nfrc == 0U) || (i == (640U * 400U))){
+  printf("Mismatch: the source did not render in its frame buffer (%u frame callbacks)\n",
+         batch_nfrc);
+  bad ++;
+ }
+
+ rrpge_delete(cln);
+ rrpge_delete(emu);
+ free(fbuf);
+
+ return bad;
+}
+
+
+
+/* Creates an emulator instance, and initializes it with the application in
+** batch_app. Note that the app. binary load callback is blocking, so no need
+** to implement any waiting here using rrpge_init_run(). Exits on failure. */
+static rrpge_object_t* batch_newinit(void)
+{
+ auint t;
+ rrpge_object_t* emu = rrpge_new_emu(&batch_cbpack);
+
+ if (emu == NULL){
+  printf("Failed to allocate emulator state\n");
+  exit(1);
+ }
+ t = rrpge_init_run(emu, RRPGE_INI_RESET);
+ if (t != RRPGE_ERR_OK){
+  printf("Failed to initialize emulator, RRPGE error: 0x%04X\n", t);
+  exit(1);
+ }
+
+ return emu;
+}
+
+
+
+/* Re-initialization check: runs an instance of the benchmark application,
+** then initializes it again with the benchmark having different initial
+** data. Its memories must match those of an instance initialized directly
+** with the latter. Returns the number of mismatching words. */
+static auint batch_reinit(auint nfrm)
+{
+ auint   i;
+ auint   t;
+ auint   bad = 0U;
+ rrpge_object_t* emu;
+ rrpge_object_t* ref;
+
+ batch_mkbench(BATCH_RIN_FLA);
+ emu = batch_newinit();
+ rrpge_enarender(emu, 0U);
+ for (i = 0U; i < nfrm; i++){
+  (void)(rrpge_run(emu, RRPGE_RUN_FREE));
+  if ((rrpge_gethaltcause(emu) & (~(auint)(RRPGE_HLT_FRAME | RRPGE_HLT_AUDIO))) != 0U){ break; }
+ }
+ free(batch_app);
+
+ batch_mkbench(BATCH_RIN_FLB);
+ t = rrpge_init_run(emu, RRPGE_INI_RESET);
+ if (t != RRPGE_ERR_OK){
+  printf("Failed to initialize emulator again, RRPGE error: 0x%04X\n", t);
+  exit(1);
+ }
+ ref = batch_newinit();
+ free(batch_app);
+ batch_app = NULL;
+
+ for (i = 0U; i < 0x10000U; i++){
+  if (rrpge_get_dram(emu, i) != rrpge_get_dram(ref, i)){
+   if (bad == 0U){
+    printf("Mismatch: Data memory 0x%04X (0x%04X / 0x%04X)\n",
+           i, rrpge_get_dram(emu, i), rrpge_get_dram(ref, i));
+   }
+   bad ++;
+  }
+ }
+ for (i = 0U; i < 0x100000U; i++){
+  if (rrpge_get_pram(emu, i) != rrpge_get_pram(ref, i)){
+   if (bad == 0U){
+    printf("Mismatch: Peripheral RAM 0x%05X (0x%08X / 0x%08X)\n",
+           i, rrpge_get_pram(emu, i), rrpge_get_pram(ref, i));
+   }
+   bad ++;
+  }
+ }
+
+ rrpge_delete(ref);
+ rrpge_delete(emu);
+
+ return bad;
+}
+
+
+
+/* Reports the most frequent sequences of instruction opcode groups from
+** their counts ("len" groups in a sequence, 7 bits each, the first is the
+** highest). "tot" is the number of instructions executed. */
+static void batch_prftop(auint const* cnt, auint len, double tot)
+{
+ auint   i;
+ auint   j;
+ auint   k;
+ auint   n = (auint)(1U) << (len * 7U);
+ auint   pc = 0xFFFFFFFFU;
+ auint   pi = 0U;
+ auint   bc;
+ auint   bi;
+
+ for (k = 0U; k < BATCH_PRF_TOP; k++){
+
+  /* Next most frequent, ordering equal counts by their index */
+  bc = 0U;
+  bi = n;
+  for (i = 0U; i < n; i++){
+   if ( (cnt[i] > bc) &&
+        ( (cnt[i] < pc) ||
+          ((cnt[i] == pc) && (i > pi)) ) ){
+    bc = cnt[i];
+    bi = i;
+   }
+  }
+  if (bi == n){ break; }
+  pc = bc;
+  pi = bi;
+
+  printf(" ");
+  for (j = len; j != 0U; j--){
+   printf(" %04X", ((bi >> ((j - 1U) * 7U)) & 0x7FU) << 9);
+  }
+  printf("  %12u  %6.2f%%\n", bc, (tot > 0.0) ? (((double)(bc) * 100.0) / tot) : 0.0);
+ }
+}
+
+
+
+/* Single steps an instance for the instruction pair and triple profile
+** until the given count of frames is emulated or it halts otherwise.
+** Updates the pair and triple counts, the total instruction count and the
+** count of those executed in the User Library. Returns the halt cause ending
+** it, zero if the frames completed. */
+static auint batch_prfrun(rrpge_object_t* emu, auint nfrm, auint* pai, auint* tri,
+                          double* tot, double* ulb)
+{
+ auint   t;
+ auint   g;
+ auint   pc;
+ auint   frm = 0U;
+ auint   cnt = 0U;
+ auint   seq = 0U;
+ uint16  lbuf[512];
+ uint16  rbuf[512];
+
+ while (frm < nfrm){
+
+  pc = rrpge_get_state(emu, RRPGE_STA_VARS + 0x0AU);
+  g  = (rrpge_get_code(emu, pc) >> 9) & 0x7FU;
+
+  if (rrpge_run(emu, RRPGE_RUN_SINGLE) != 0U){
+   cnt ++;
+   *tot += 1.0;
+   if (pc >= BATCH_PRF_ULB){ *ulb += 1.0; }
+   seq = ((seq << 7) | g) & 0x1FFFFFU;
+   if (cnt >= 2U){ pai[seq & 0x3FFFU] ++; }
+   if (cnt >= 3U){ tri[seq] ++; }
+  }
+
+  t = rrpge_gethaltcause(emu);
+  if ((t & RRPGE_HLT_AUDIO) != 0U){ rrpge_getaudio(emu, &lbuf[0], &rbuf[0]); }
+  if ((t & RRPGE_HLT_FRAME) != 0U){ frm ++; }
+  t &= ~(RRPGE_HLT_AUDIO | RRPGE_HLT_FRAME);
+  if (t != 0U){ return t; }
+ }
+
+ return 0U;
+}
+
+
+
+/* Instruction pair and triple profile: single steps an instance of the
+** application for the given count of frames, or with the native check, the
+** emulated User Library routines from each of the given count of states.
+** Reports the most frequent pairs and triples by opcode group, the share of
+** instructions executed in the User Library, and the share of skips
+** followed by a JMS (the candidates for superinstructions). */
+static void batch_profile(auint nfrm)
+{
+ auint   e;
+ auint   n;
+ auint   t;
+ auint   i;
+ double  tot = 0.0;
+ double  ulb = 0.0;
+ double  skj = 0.0;
+ auint*  pai = calloc((size_t)(1U) << 14, sizeof(auint));
+ auint*  tri = calloc((size_t)(1U) << 21, sizeof(auint));
+ rrpge_object_t* emu;
+
+ if ((pai == NULL) || (tri == NULL)){
+  printf("Failed to allocate profile\n");
+  exit(1);
+ }
+
+ if (batch_natck != 0U){
+
+  /* Each routine runs until the return to the supervisor op. */
+
+  for (e = 0U; e < BATCH_NAT_CNT; e++){
+   for (n = 0U; n < batch_ninst; n++){
+    emu = batch_natnew(e, n);
+    batch_prfrun(emu, 0x7FFFFFFFU, pai, tri, &tot, &ulb);
+    rrpge_delete(emu);
+   }
+  }
+  printf("\nInstructions executed in %u routine(s) from %u state(s) each: %.0f\n",
+         BATCH_NAT_CNT, batch_ninst, tot);
+
+ }else{
+
+  emu = rrpge_new_emu_app(&batch_cbpack, batch_img);
+  if (emu == NULL){
+   printf("Failed to allocate emulator state\n");
+   exit(1);
+  }
+  rrpge_enarender(emu, 0U);
+  t = batch_prfrun(emu, nfrm, pai, tri, &tot, &ulb);
+  if (t != 0U){ printf("Halted, halt cause: %04X\n", t); }
+  rrpge_delete(emu);
+  printf("\nInstructions executed: %.0f\n", tot);
+
+ }
+
+ /* Skips (opcode groups 0x50 - 0x5F) followed by a JMS (0x46 - 0x47) */
+
+ for (i = 0U; i < (1U << 14); i++){
+  if ( (((i >> 7) & 0x70U) == 0x50U) && ((i & 0x7EU) == 0x46U) ){
+   skj += (double)(pai[i]);
+  }
+ }
+
+ printf("In the User Library: %.0f (%.2f%%)\n", ulb,
+        (tot > 0.0) ? ((ulb * 100.0) / tot) : 0.0);
+ printf("Skip + JMS pairs: %.0f (%.2f%%)\n", skj,
+        (tot > 0.0) ? ((skj * 100.0) / tot) : 0.0);
+ printf("\nMost frequent pairs (opcode groups by first opcode word):\n");
+ batch_prftop(pai, 2U, tot);
+ printf("\nMost frequent triples:\n");
+ batch_prftop(tri, 3U, tot);
+
+ free(pai);
+ free(tri);
+}
+
+
+
+/* Parses a numeric argument within limits, exits on failure */
+static auint batch_arg(char const* str, char const* nam, auint max)
+{
+ long v = strtol(str, NULL, 0);
+
+ if ((v < 1L) || (v > (long)(max))){
+  printf("Error: %s must be between 1 and %u!\n", nam, max);
+  exit(1);
+ }
+
+ return (auint)(v);
+}
+
+
+
+int main(int argc, char** argv)
+{
+ auint   i;
+ auint   n;
+ auint   t;
+ auint   a = 1U;
+ long    s;
+ double  wtm;
+ double  cyc = 0.0;
+ double  frm = 0.0;
+ double  ins = 0.0;
+ FILE*   app;
+ rrpge_object_t* emu;
+
+
+
+ /* Init message */
+ printf("\n");
+ printf("%s", batch_appname);
+ printf("\n\n");
+ printf("%s", batch_appauth);
+ printf("%s", batch_copyrig);
+ printf("\n");
+
+
+
+ /* Check arguments: need an application, optionally followed by the count
+ ** of instances, threads and frames to emulate. "-bench" selects the
+ ** built-in benchmark application, "-native" the native routine check
+ ** (optionally followed by the count of states to try), "-reinit" the
+ ** re-initialization check (optionally followed by the count of frames to
+ ** run before). "-check" before the application selects the single versus
+ ** multiple threads check, "-profile" the instruction pair and triple
+ ** profile (only the count of frames may follow the application, or with
+ ** "-native", the count of states). */
+ if ((argc > 1) && (strcmp(argv[1], "-check") == 0)){
+  batch_check = 1U;
+  a = 2U;
+ }
+ if ((argc > 1) && (strcmp(argv[1], "-profile") == 0)){
+  batch_prfck = 1U;
+  a = 2U;
+ }
+ if (argc <= (int)(a)){
+  printf("Error: need an application to run as parameter!\n");
+  printf("Usage: %s [-check] application|-bench [instances [threads [frames]]]\n", argv[0]);
+  printf("       %s -profile application|-bench [frames]\n", argv[0]);
+  printf("       %s -profile -native [states]\n", argv[0]);
+  printf("       %s -native [states]\n", argv[0]);
+  printf("       %s -reinit [frames]\n", argv[0]);
+  exit(1);
+ }
+ if ((batch_check == 0U) && (strcmp(argv[a], "-native") == 0)){
+  batch_natck = 1U;
+  batch_ninst = 100U;
+  if (argc > (int)(a + 1U)){ batch_ninst = batch_arg(argv[a + 1U], "States", 0x7FFFFFFFU); }
+ }
+ else if (batch_prfck != 0U){
+  if (argc > 3){ batch_nfrm = batch_arg(argv[3], "Frames", 0x7FFFFFFFU); }
+ }
+ else if ((batch_check == 0U) && (strcmp(argv[a], "-reinit") == 0)){
+  batch_rinck = 1U;
+  batch_nfrm  = 10U;
+  if (argc > 2){ batch_nfrm = batch_arg(argv[2], "Frames", 0x7FFFFFFFU); }
+ }
+ else if (argc > (int)(a + 1U)){ batch_ninst = batch_arg(argv[a + 1U], "Instances", BATCH_INST_MAX); }
+ if ((batch_prfck == 0U) && (argc > (int)(a + 2U))){ batch_nthr  = batch_arg(argv[a + 2U], "Threads", BATCH_THR_MAX); }
+ if ((batch_prfck == 0U) && (argc > (int)(a + 3U))){ batch_nfrm  = batch_arg(argv[a + 3U], "Frames", 0x7FFFFFFFU); }
+ if (batch_nthr > batch_ninst){ batch_nthr = batch_ninst; }
+
+
+
+ /* Load the application's binary, or build the benchmark */
+ if (batch_natck != 0U){
+  printf("Checking the native User Library routines\n");
+  batch_mkbench(0U);
+ }else if (batch_rinck != 0U){
+  printf("Checking initializing an instance again\n");
+ }else if (strcmp(argv[a], "-bench") == 0){
+  printf("Running the built-in benchmark\n");
+  batch_bench = 1U;
+  batch_mkbench(0U);
+ }else{
+  printf("Opening %s...\n", argv[a]);
+  app = fopen(argv[a], "rb");
+  if (app == NULL){
+   perror("Failed to open file");
+   exit(1);
+  }
+  fseek(app, 0L, SEEK_END);
+  s = ftell(app);
+  if (s < 0L){
+   perror("Failed to read file");
+   exit(1);
+  }
+  batch_appsiz = (auint)(s);
+  batch_app = malloc(batch_appsiz + 1U);
+  if (batch_app == NULL){
+   printf("Failed to allocate memory for the application\n");
+   exit(1);
+  }
+  filels_read(app, 0U, batch_appsiz, batch_app);
+  fclose(app);
+ }
+
+
+
+ /* Initialize emulator library */
+ rrpge_init_lib(&batch_malloc, &free);
+
+
+
+ /* Re-initialization check, if requested */
+ if (batch_rinck != 0U){
+  t = batch_reinit(batch_nfrm);
+  printf("Initialized again after %u frame(s), mismatches: %u\n",
+         batch_nfrm, t);
+  exit((t == 0U) ? 0 : 1);
+ }
+
+
+
+ /* Load and check the application once in an emulator instance, then take
+ ** its application image for creating the instances to run. */
+ emu = batch_newinit();
+ batch_img = rrpge_getapp(emu);
+ rrpge_delete(emu);
+ free(batch_app);
+ batch_app = NULL;
+
+
+
+ /* Instruction pair and triple profile, if requested */
+ if (batch_prfck != 0U){
+  if (batch_natck == 0U){ printf("Profiling %u frame(s)\n", batch_nfrm); }
+  batch_profile(batch_nfrm);
+  rrpge_delete(batch_img);
+  exit(0);
+ }
+
+
+
+ /* Native check, if requested */
+ if (batch_natck != 0U){
+  wtm = 0.0;
+  t = batch_native(batch_ninst, &wtm, &cyc);
+  printf("%u routine(s) from %u state(s) each, mismatches: %u\n",
+         BATCH_NAT_CNT, batch_ninst, t);
+  printf("Emulated routines: %.0f cycles in %.3f ms\n", cyc, wtm * 1000.0);
+  i = batch_clonefrm();
+  printf("Clone of an instance rendering frames, mismatches: %u\n", i);
+  rrpge_delete(batch_img);
+  exit(((t + i) == 0U) ? 0 : 1);
+ }
+
+
+
+
+ /* For the check, run the instances on a single thread first, giving the
+ ** reference results */
+ if (batch_check != 0U){
+  printf("Running %u instance(s) on 1 thread for %u frame(s)\n",
+         batch_ninst, batch_nfrm);
+  (void)(batch_pool(1U));
+  for (i = 0U; i < batch_ninst; i++){
+   batch_iref[i] = batch_inst[i];
+  }
+ }
+
+
+
+ /* Run the instances on the thread pool */
+ printf("Running %u instance(s) on %u thread(s) for %u frame(s)\n",
+        batch_ninst, batch_nthr, batch_nfrm);
+
+ wtm = batch_time();
+ n = batch_pool(batch_nthr);
+ wtm = batch_time() - wtm;
+
+
+
+ /* Report */
+ printf("\nInstance    Frames      CPU cycles  Wall time (s)  Audio sum  Halt\n");
+ for (i = 0U; i < batch_ninst; i++){
+  printf("%8u  %8u  %14.0f  %13.3f  %08X   %04X\n",
+         i, batch_inst[i].frm, batch_inst[i].cyc, batch_inst[i].wtm,
+         batch_inst[i].aud, batch_inst[i].hlt);
+  cyc += batch_inst[i].cyc;
+  frm += (double)(batch_inst[i].frm);
+  ins += batch_inst[i].ins;
+ }
+ printf("\nThreads used: %u\n", n);
+ printf("Total wall time: %.3f s\n", wtm);
+ if (wtm > 0.0){
+  printf("Emulated CPU cycles per second: %.0f\n", cyc / wtm);
+  printf("Emulated frames per second: %.1f\n", frm / wtm);
+  if (batch_bench != 0U){
+   printf("Emulated CPU instructions per second: %.0f\n", ins / wtm);
+  }
+ }
+
+ rrpge_delete(batch_img);
+
+
+
+ /* Check: each instance has to match its single threaded run and the first
+ ** instance (all instances run the same application from the same state) */
+ if (batch_check != 0U){
+  t = 0U;
+  for (i = 0U; i < batch_ninst; i++){
+   if ( (batch_differs(&batch_inst[i], &batch_iref[i]) != 0U) ||
+        (batch_differs(&batch_inst[i], &batch_iref[0]) != 0U) ){
+    printf("Mismatch: instance %u (frames %u / %u, audio sum %08X / %08X, state sum %08X / %08X)\n",
+           i, batch_inst[i].frm, batch_iref[i].frm,
+           batch_inst[i].aud, batch_iref[i].aud,
+           batch_inst[i].sta, batch_iref[i].sta);
+    t ++;
+   }
+  }
+  printf("\nCheck: %u instance(s) on 1 and %u thread(s), mismatches: %u\n",
+         batch_ninst, n, t);
+  exit((t == 0U) ? 0 : 1);
+ }
+
+ exit(0);
+}
@@ -6,7 +6,7 @@
 #           root.
 #
 
-OBJECTS+= $(OBD)screen.o   $(OBD)audio.o    $(OBD)filels.o
+OBJECTS+= $(OBD)screen.o   $(OBD)audio.o    $(OBD)filels.o   $(OBD)prof.o
 
 $(OBD)screen.o: host/screen.c host/*.h
 	$(CC) -c host/screen.c -o $(OBD)screen.o $(CFSIZ)
@@ -16,3 +16,6 @@ $(OBD)audio.o: host/audio.c host/*.h
 
 $(OBD)filels.o: host/filels.c host/*.h
 	$(CC) -c host/filels.c -o $(OBD)filels.o $(CFSIZ)
+
+$(OBD)prof.o: host/prof.c host/*.h
+	$(CC) -c host/prof.c -o $(OBD)prof.o $(CFSIZ)
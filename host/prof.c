@@ -0,0 +1,122 @@
+/**
+**  \file
+**  \brief     Execution profile dump.
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.09.24
+*/
+
+
+
+#include "prof.h"
+
+
+
+/* Number of addresses listed in the flat profile */
+#define PROF_TOPA  32U
+
+/* Number of address ranges listed */
+#define PROF_TOPR  16U
+
+/* Size of address ranges in words (power of 2) */
+#define PROF_RSIZ  64U
+
+
+/* Profile retrieved from the emulator */
+static auint prof_cnt[65536U];
+static auint prof_cyc[65536U];
+static auint prof_cys[65536U];
+
+/* Cycles by address range */
+static auint prof_rcy[65536U / PROF_RSIZ];
+
+
+
+/* Selects the indices of the largest elements of an array into the top list
+** in descending order. Zero elements are not selected. Returns the number of
+** elements selected. */
+static auint prof_top(auint const* arr, auint len, auint* top, auint tlen)
+{
+ auint i;
+ auint j;
+ auint n = 0U;
+
+ for (i = 0U; i < len; i++){
+  if (arr[i] == 0U){ continue; }
+  if ((n == tlen) && (arr[top[n - 1U]] >= arr[i])){ continue; }
+  if (n < tlen){ n++; }
+  j = n - 1U;
+  while ((j != 0U) && (arr[top[j - 1U]] < arr[i])){
+   top[j] = top[j - 1U];
+   j--;
+  }
+  top[j] = i;
+ }
+
+ return n;
+}
+
+
+
+/* Returns the percentage of a part of a total */
+static double prof_pct(auint v, double tot)
+{
+ if (tot == 0.0){ return 0.0; }
+ return ((double)(v) * 100.0) / tot;
+}
+
+
+
+/* Prints the execution profile accumulated by the emulator (see
+** rrpge_enaprofile()) to the given file: a flat profile of the addresses
+** consuming the most cycles, then the address ranges consuming the most
+** cycles. */
+void  prof_dump(rrpge_object_t* emu, FILE* f)
+{
+ auint  i;
+ auint  n;
+ auint  a;
+ auint  top[PROF_TOPA];
+ double tcy = 0.0;
+ double tcs = 0.0;
+ double tcn = 0.0;
+
+ for (i = 0U; i < (65536U / PROF_RSIZ); i++){
+  prof_rcy[i] = 0U;
+ }
+ for (i = 0U; i < 65536U; i++){
+  prof_cnt[i] = rrpge_getprofile(emu, i, &prof_cyc[i], &prof_cys[i]);
+  prof_rcy[i / PROF_RSIZ] += prof_cyc[i];
+  tcn += (double)(prof_cnt[i]);
+  tcy += (double)(prof_cyc[i]);
+  tcs += (double)(prof_cys[i]);
+ }
+
+ fprintf(f, "Execution profile\n");
+ fprintf(f, "Instructions: %.0f; CPU cycles: %.0f; Peripheral bus stalls: %.0f\n",
+         tcn, tcy, tcs);
+
+ /* Flat profile */
+
+ fprintf(f, "\nAddress   Executions    CPU cycles       %%  Bus stalls\n");
+ n = prof_top(&prof_cyc[0], 65536U, &top[0], PROF_TOPA);
+ for (i = 0U; i < n; i++){
+  a = top[i];
+  fprintf(f, "0x%04X  %12u  %12u  %5.1f%%  %10u\n",
+          a, prof_cnt[a], prof_cyc[a], prof_pct(prof_cyc[a], tcy), prof_cys[a]);
+ }
+
+ /* Hottest address ranges */
+
+ fprintf(f, "\nAddress range      CPU cycles       %%\n");
+ n = prof_top(&prof_rcy[0], 65536U / PROF_RSIZ, &top[0], PROF_TOPR);
+ for (i = 0U; i < n; i++){
+  a = top[i];
+  fprintf(f, "0x%04X - 0x%04X  %12u  %5.1f%%\n",
+          a * PROF_RSIZ, (a * PROF_RSIZ) + (PROF_RSIZ - 1U),
+          prof_rcy[a], prof_pct(prof_rcy[a], tcy));
+ }
+}
@@ -0,0 +1,30 @@
+/**
+**  \file
+**  \brief     Execution profile dump.
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.09.24
+*/
+
+
+#ifndef PROF_H
+#define PROF_H
+
+
+#include "types.h"
+#include "../librrpge/rrpge.h"
+#include <stdio.h>
+
+
+
+/* Prints the execution profile accumulated by the emulator (see
+** rrpge_enaprofile()) to the given file: a flat profile of the addresses
+** consuming the most cycles, then the address ranges consuming the most
+** cycles. */
+void  prof_dump(rrpge_object_t* emu, FILE* f);
+
+
+#endif
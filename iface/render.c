@@ -6,13 +6,14 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.05
+**  \date      2015.10.11
 **
 **
-** Graphics rendering: produces the graphics output from the lines provided by
-** the emulator. It also provides the palette callback to set the colors. When
-** resetting or starting, the palette has to be filled. It also automatically
-** updates display when reaching line 399 after outputting it.
+** Graphics rendering: sets up the emulator to render whole frames directly
+** in the display's surface in its pixel format (the emulator keeps the
+** colors in sync with the palette), and updates the display once for every
+** completed frame. When resetting or starting, the frame rendering has to be
+** set up after the display is set.
 */
 
 
@@ -21,82 +22,37 @@
 
 
 
-/* Palette in -RGB format suitable for the display */
-static uint32 render_col[256U];
-
-
-
 /*
-** Line callback service routine.
+** Internal: frame callback service routine. The frame is already in the
+** display's surface, so it only needs updating.
 */
-void render_line(rrpge_object_t* hnd, rrpge_iuint ln, rrpge_uint8 const* buf)
+static void render_frame(rrpge_object_t* hnd, void const* buf)
 {
- uint32* sln;
- auint   j;
-
- if (ln  >  399U){ return; }  /* Should not happen */
-
- sln = screen_lock();
- if (sln == NULL){ return; }  /* Display not available for rendering */
-
- sln += screen_pitch() * ln;  /* Position to the appropriate line */
-
- for (j = 0U; j < 640U; j += 8U){
-  sln[j + 0U] = render_col[buf[j + 0U]];
-  sln[j + 1U] = render_col[buf[j + 1U]];
-  sln[j + 2U] = render_col[buf[j + 2U]];
-  sln[j + 3U] = render_col[buf[j + 3U]];
-  sln[j + 4U] = render_col[buf[j + 4U]];
-  sln[j + 5U] = render_col[buf[j + 5U]];
-  sln[j + 6U] = render_col[buf[j + 6U]];
-  sln[j + 7U] = render_col[buf[j + 7U]];
- }
-
- screen_unlock();
-
- if (ln == 399U){             /* Last line - update display too */
-  screen_update(0, 0, 640, 400);
- }
-}
-
-
-
-/*
-** Internal: convert palette entry
-** Treats the RRPGE source as an 5R-5G-1x-5B color
-*/
-static auint render_palconv(auint scol)
-{
- return ((scol & 0x0F00U) << 12) |
-        ((scol & 0x0F00U) <<  8) |
-        ((scol & 0x00F0U) <<  8) |
-        ((scol & 0x00F0U) <<  4) |
-        ((scol & 0x000FU) <<  4) |
-        ((scol & 0x000FU)      );
-}
-
-
-
-/*
-** Palette callback service routine.
-*/
-void render_pal(rrpge_object_t* hnd, const void* par)
-{
- rrpge_cbp_setpal_t const* col = (rrpge_cbp_setpal_t const*)(par);
- render_col[(col->id) & 0xFFU] = render_palconv(col->col);
+ screen_update(0, 0, 640, 400);
 }
 
 
 
 /*
 ** Initializes or resets rendering subsystem by the given emulator object.
-** This sets the initial palette.
+** This sets up the emulator to render whole frames in the display's surface,
+** so the display has to be set before.
 */
 void render_reset(rrpge_object_t* hnd)
 {
- auint i;
+ uint32* sln;
+ auint   pit;
 
- for (i = 0U; i < 256U; i++){
-  render_col[i] = render_palconv(rrpge_getpalentry(hnd, i));
+ /* The display's surface is a software surface in -RGB format, which stays
+ ** in place when unlocked, so the emulator may render in it any time. */
+
+ sln = screen_lock();
+ if (sln == NULL){            /* Display not available for rendering */
+  rrpge_setframe(hnd, NULL, 0U, RRPGE_PIX_IDX8, NULL);
+  return;
  }
+ pit = screen_pitch();
+ screen_unlock();
+
+ rrpge_setframe(hnd, sln, pit << 2, RRPGE_PIX_XRGB8888, &render_frame);
 }
@@ -6,13 +6,14 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.05
+**  \date      2015.10.11
 **
 **
-** Graphics rendering: produces the graphics output from the lines provided by
-** the emulator. It also provides the palette callback to set the colors. When
-** resetting or starting, the palette has to be filled. It also automatically
-** updates display when reaching line 399 after outputting it.
+** Graphics rendering: sets up the emulator to render whole frames directly
+** in the display's surface in its pixel format (the emulator keeps the
+** colors in sync with the palette), and updates the display once for every
+** completed frame. When resetting or starting, the frame rendering has to be
+** set up after the display is set.
 */
 
 
@@ -25,19 +26,10 @@
 
 
 
-/*
-** Line callback service routine.
-*/
-void render_line(rrpge_object_t* hnd, rrpge_iuint ln, rrpge_uint8 const* buf);
-
-/*
-** Palette callback service routine.
-*/
-void render_pal(rrpge_object_t* hnd, const void* par);
-
 /*
 ** Initializes or resets rendering subsystem by the given emulator object.
-** This sets the initial palette.
+** This sets up the emulator to render whole frames in the display's surface,
+** so the display has to be set before.
 */
 void render_reset(rrpge_object_t* hnd);
 
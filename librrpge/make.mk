@@ -6,14 +6,15 @@
 #           root.
 #
 
-OBJECTS+= $(OBD)rgm_acc.o  $(OBD)rgm_acco.o $(OBD)rgm_aq.o   $(OBD)rgm_aud.o
-OBJECTS+= $(OBD)rgm_cb.o   $(OBD)rgm_chk.o  $(OBD)rgm_cpu.o  $(OBD)rgm_cpua.o
-OBJECTS+= $(OBD)rgm_cpuo.o $(OBD)rgm_db.o   $(OBD)rgm_dev.o  $(OBD)rgm_devk.o
-OBJECTS+= $(OBD)rgm_devx.o $(OBD)rgm_fifo.o $(OBD)rgm_halt.o $(OBD)rgm_info.o
-OBJECTS+= $(OBD)rgm_ires.o $(OBD)rgm_krnm.o $(OBD)rgm_main.o $(OBD)rgm_mix.o
-OBJECTS+= $(OBD)rgm_mixo.o $(OBD)rgm_pram.o $(OBD)rgm_prng.o $(OBD)rgm_run.o
-OBJECTS+= $(OBD)rgm_ser.o  $(OBD)rgm_stat.o $(OBD)rgm_task.o $(OBD)rgm_ulib.o
-OBJECTS+= $(OBD)rgm_vid.o  $(OBD)rgm_vidl.o
+LOBJECTS+=$(OBD)rgm_acc.o  $(OBD)rgm_acco.o $(OBD)rgm_aq.o   $(OBD)rgm_aud.o
+LOBJECTS+=$(OBD)rgm_cb.o   $(OBD)rgm_chk.o  $(OBD)rgm_cpu.o  $(OBD)rgm_cpua.o
+LOBJECTS+=$(OBD)rgm_cpuh.o $(OBD)rgm_cpuo.o $(OBD)rgm_db.o   $(OBD)rgm_dev.o
+LOBJECTS+=$(OBD)rgm_devk.o $(OBD)rgm_devx.o $(OBD)rgm_fifo.o $(OBD)rgm_halt.o
+LOBJECTS+=$(OBD)rgm_info.o $(OBD)rgm_ires.o $(OBD)rgm_krnm.o $(OBD)rgm_main.o
+LOBJECTS+=$(OBD)rgm_mix.o  $(OBD)rgm_mixo.o $(OBD)rgm_pram.o $(OBD)rgm_prng.o
+LOBJECTS+=$(OBD)rgm_rlog.o $(OBD)rgm_run.o  $(OBD)rgm_rwnd.o $(OBD)rgm_ser.o
+LOBJECTS+=$(OBD)rgm_snap.o $(OBD)rgm_stat.o $(OBD)rgm_task.o $(OBD)rgm_ulib.o
+LOBJECTS+=$(OBD)rgm_vid.o  $(OBD)rgm_vidl.o
 
 $(OBD)rgm_acc.o: librrpge/rgm_acc.c librrpge/*.h
 	$(CC) -c librrpge/rgm_acc.c -o $(OBD)rgm_acc.o $(CFSPD)
@@ -47,6 +48,10 @@ $(OBD)rgm_cpua.o: librrpge/rgm_cpua.c librrpge/*.h
 	$(CC) -c librrpge/rgm_cpua.c -o $(OBD)rgm_cpua.o -fomit-frame-pointer $(CFSPD)
 	$(CC) -S librrpge/rgm_cpua.c -o $(OBD)rgm_cpua.asm -fomit-frame-pointer $(CFSPD)
 
+$(OBD)rgm_cpuh.o: librrpge/rgm_cpuh.c librrpge/*.h
+	$(CC) -c librrpge/rgm_cpuh.c -o $(OBD)rgm_cpuh.o $(CFSPD)
+	$(CC) -S librrpge/rgm_cpuh.c -o $(OBD)rgm_cpuh.asm $(CFSPD)
+
 $(OBD)rgm_cpuo.o: librrpge/rgm_cpuo.c librrpge/*.h
 	$(CC) -c librrpge/rgm_cpuo.c -o $(OBD)rgm_cpuo.o -fomit-frame-pointer $(CFSPD)
 	$(CC) -S librrpge/rgm_cpuo.c -o $(OBD)rgm_cpuo.asm -fomit-frame-pointer $(CFSPD)
@@ -111,14 +116,26 @@ $(OBD)rgm_prng.o: librrpge/rgm_prng.c librrpge/*.h
 	$(CC) -c librrpge/rgm_prng.c -o $(OBD)rgm_prng.o $(CFSPD)
 	$(CC) -S librrpge/rgm_prng.c -o $(OBD)rgm_prng.asm $(CFSPD)
 
+$(OBD)rgm_rlog.o: librrpge/rgm_rlog.c librrpge/*.h
+	$(CC) -c librrpge/rgm_rlog.c -o $(OBD)rgm_rlog.o $(CFSPD)
+	$(CC) -S librrpge/rgm_rlog.c -o $(OBD)rgm_rlog.asm $(CFSPD)
+
 $(OBD)rgm_run.o: librrpge/rgm_run.c librrpge/*.h
 	$(CC) -c librrpge/rgm_run.c -o $(OBD)rgm_run.o $(CFSPD)
 	$(CC) -S librrpge/rgm_run.c -o $(OBD)rgm_run.asm $(CFSPD)
 
+$(OBD)rgm_rwnd.o: librrpge/rgm_rwnd.c librrpge/*.h
+	$(CC) -c librrpge/rgm_rwnd.c -o $(OBD)rgm_rwnd.o $(CFSPD)
+	$(CC) -S librrpge/rgm_rwnd.c -o $(OBD)rgm_rwnd.asm $(CFSPD)
+
 $(OBD)rgm_ser.o: librrpge/rgm_ser.c librrpge/*.h
 	$(CC) -c librrpge/rgm_ser.c -o $(OBD)rgm_ser.o $(CFSPD)
 	$(CC) -S librrpge/rgm_ser.c -o $(OBD)rgm_ser.asm $(CFSPD)
 
+$(OBD)rgm_snap.o: librrpge/rgm_snap.c librrpge/*.h
+	$(CC) -c librrpge/rgm_snap.c -o $(OBD)rgm_snap.o $(CFSPD)
+	$(CC) -S librrpge/rgm_snap.c -o $(OBD)rgm_snap.asm $(CFSPD)
+
 $(OBD)rgm_stat.o: librrpge/rgm_stat.c librrpge/*.h
 	$(CC) -c librrpge/rgm_stat.c -o $(OBD)rgm_stat.o $(CFSPD)
 	$(CC) -S librrpge/rgm_stat.c -o $(OBD)rgm_stat.asm $(CFSPD)
@@ -11,6 +11,7 @@
 
 
 #include "rgm_acco.h"
+#include "rgm_drty.h"
 
 
 /* Peripheral memory size in 32bit units.
@@ -432,6 +433,7 @@ auint rrpge_m_acco(rrpge_object_t* hnd)
 
     bmems = ~bmems;                      /* Leave zero in mask where destination was dropped */
     pram[i] = ( (u & bmems ) | (sdata & (~bmems)) ) & 0xFFFFFFFFU;
+    rrpge_m_drty_pram(hnd, i);
     dsfrac += 0x10000U;
 
     /* Calculate combine cycle count. If bmems is zero, then may accelerate */
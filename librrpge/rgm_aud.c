@@ -13,6 +13,7 @@
 #include "rgm_aud.h"
 #include "rgm_halt.h"
 #include "rgm_stat.h"
+#include "rgm_rlog.h"
 
 
 
@@ -218,6 +219,7 @@ rrpge_iuint rrpge_getaudio(rrpge_object_t* hnd, rrpge_uint16* lbuf, rrpge_uint16
  uint16 const* pr;
 
  if (!rrpge_m_halt_isset(hnd, RRPGE_HLT_AUDIO)){ return 0; } /* No audio event present */
+ rrpge_m_rlog_aud(hnd);
 
  r = hnd->aud.evct;
  hnd->aud.evct = 0U;
@@ -244,6 +246,7 @@ rrpge_iuint rrpge_getaudio(rrpge_object_t* hnd, rrpge_uint16* lbuf, rrpge_uint16
 /* Sets main clock frequency - implementation of RRPGE library function */
 void rrpge_set_clock(rrpge_object_t* hnd, rrpge_iuint clk)
 {
+ if (!rrpge_m_rlog_clock(hnd, clk)){ return; }
  if (clk < 1000000U){ clk = 1000000U; } /* Don't allow below 1 MHz */
  hnd->aud.mclk = clk;
 }
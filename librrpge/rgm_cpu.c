@@ -6,12 +6,14 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.13
+**  \date      2015.10.12
 */
 
 
 #include "rgm_cpu.h"
 #include "rgm_cpuo.h"
+#include "rgm_cpuh.h"
+#include "rgm_cpua.h"
 #include "rgm_halt.h"
 #include "rgm_stat.h"
 
@@ -73,6 +75,304 @@ void rrpge_m_cpu_init(void)
 
 
 
+/* Maximal number of instructions in an execution block */
+#define RRPGE_M_CPU_BLN 16U
+
+/* Maximal length of idle loops in words (backward jump distance) */
+#define RRPGE_M_CPU_ILN 32U
+
+/* Maximal number of instructions probed in an idle loop */
+#define RRPGE_M_CPU_ILI 64U
+
+
+
+/* Decodes the instruction at the given code address into its pre-decoded
+** record. Instructions having a breakpoint set on them get the breakpoint
+** trap as handler (if a breakpoint bit map is given), entry points of native
+** User Library routines are also marked. */
+static void rrpge_m_cpu_decode_op(rrpge_app_t const* app, rrpge_m_cpu_dec_t* dec,
+                                  uint32 const* brkp, auint i)
+{
+ auint op = app->crom[i] & 0xFFFFU;
+
+ dec += i;
+ dec->opi = rrpge_m_op_index(op);
+ if ( (brkp != RRPGE_M_NULL) &&
+      ((brkp[i >> 5] & (0x80000000U >> (i & 0x1FU))) != 0U) ){
+  dec->opi = RRPGE_M_OPH_BRK;
+ }
+ dec->opf = rrpge_m_op_htable[dec->opi];
+ dec->arf = rrpge_m_addr_read_table[op & 0x3FU];
+ dec->opc = op;
+ dec->imm = ((op & 0x3U) << 14) +
+            (app->crom[(i + 1U) & 0xFFFFU] & 0x3FFFU);
+ dec->hle = rrpge_m_cpuh_isentry(app, i);
+}
+
+
+
+/* Determines the execution block starting at the given code address. The
+** block of the following instruction must already be determined. Returns
+** nonzero if the record changed. */
+static auint rrpge_m_cpu_decode_blk(rrpge_m_cpu_dec_t* dec, auint i)
+{
+ auint inf;
+ auint j;
+ auint hlt;
+ auint opi = dec[i].opi;
+ auint bln = 1U;
+ auint bcy = 0U;
+
+ if (opi == RRPGE_M_OPH_BRK){        /* Breakpoint trap: always ends a block */
+  inf = RRPGE_M_OPI_HLT;
+ }else{
+  inf = rrpge_m_op_info(dec[i].opc, dec[i].imm);
+ }
+ j   = i + 1U + ((inf & RRPGE_M_OPI_W2) >> 10);
+ hlt = (inf & RRPGE_M_OPI_HLT) >> 9;
+ if ( ((inf & (RRPGE_M_OPI_JMP | RRPGE_M_OPI_HLT)) == 0U) &&
+      (j <= 0xFFFFU) ){
+  if ( (dec[j].bln < RRPGE_M_CPU_BLN) &&
+       (dec[j].idl == 0U) &&
+       (dec[j].hle == 0U) ){         /* Trapped heads always start blocks */
+   bln = dec[j].bln + 1U;
+   bcy = dec[j].bcy + (inf & RRPGE_M_OPI_CYC);
+  }
+ }
+ if (opi != RRPGE_M_OPH_BRK){
+  if      (dec[i].hle != 0U){        /* Native routine trap */
+   opi = RRPGE_M_OPH_HLE;
+  }else if (dec[i].idl != 0U){       /* Idle loop head trap */
+   opi = RRPGE_M_OPH_IDL;
+  }else{
+   opi = rrpge_m_op_index(dec[i].opc);
+  }
+ }
+
+ if ( (dec[i].opi == opi) &&
+      (dec[i].hlt == hlt) &&
+      (dec[i].bln == bln) &&
+      (dec[i].bcy == bcy) ){ return 0U; }
+ dec[i].opi = opi;
+ dec[i].opf = rrpge_m_op_htable[opi];
+ dec[i].hlt = hlt;
+ dec[i].bln = bln;
+ dec[i].bcy = bcy;
+ return 1U;
+}
+
+
+
+/* Nominates possible idle loop heads: short loops closed by a backward JMS
+** or JNZ, consisting of instructions only altering the CPU registers. Such
+** a loop (polling something, or just spinning) may be repeating in the same
+** state until a halt cause or the end of the CPU's time slice, which is
+** verified when running it (rrpge_m_cpu_idle()). */
+static void rrpge_m_cpu_decode_idl(rrpge_m_cpu_dec_t* dec)
+{
+ auint i;
+ auint j;
+ auint d;
+ auint g;
+ auint inf;
+
+ for (i = 0U; i < 65536U; i++){
+  dec[i].idl = 0U;
+ }
+
+ for (i = 0U; i < 65536U; i++){
+  g = (dec[i].opc >> 9) & 0x7FU;
+  if      ((g & 0x7EU) == 0x46U){    /* JMS simm10 */
+   d = (0U - (((dec[i].opc & 0x03FFU) ^ 0x0200U) - 0x0200U)) & 0xFFFFU;
+  }else if ((g & 0x7EU) == 0x44U){   /* JNZ rx, simm7 */
+   d = (0x40U - ((dec[i].opc & 0x3FU) | ((~(dec[i].opc >> 3)) & 0x40U))) & 0xFFFFU;
+  }else{
+   continue;
+  }
+  if ((d >= RRPGE_M_CPU_ILN) || (d > i)){ continue; }
+
+  /* Walk the loop body: it must end exactly on the jump, and none of its
+  ** instructions may have effects beyond the CPU registers. */
+
+  j = i - d;
+  while (j < i){
+   inf = rrpge_m_op_info(dec[j].opc, dec[j].imm);
+   if ((inf & RRPGE_M_OPI_SFX) != 0U){ break; }
+   j += 1U + ((inf & RRPGE_M_OPI_W2) >> 10);
+  }
+  if (j == i){ dec[i - d].idl = 1U; }
+ }
+}
+
+
+
+/* Pre-decodes the code memory of an application image. Must be called after
+** the code memory was loaded (it is not modified after this, so the decoded
+** records remain valid, shared by the emulation instances using the image).
+** Along with decoding, execution blocks are also determined: an execution
+** block is a straight sequence of instructions which can not alter the flow
+** of execution or raise a halt cause, except for the last one. Knowing the
+** worst case cycle count of such a block the emulation may run it without
+** checking for halts or the cycle limit after each instruction. */
+void rrpge_m_cpu_decode(rrpge_app_t* app)
+{
+ auint i;
+
+ rrpge_m_cpuh_check(app);
+
+ for (i = 0U; i < 65536U; i++){
+  rrpge_m_cpu_decode_op(app, &(app->cdec[0]), RRPGE_M_NULL, i);
+  app->cdec[i].bln = 0U; /* Not yet determined */
+ }
+
+ rrpge_m_cpu_decode_idl(&(app->cdec[0]));
+
+ /* Execution blocks are built backwards, so the block of the following
+ ** instruction is always available for extending. */
+
+ i = 65536U;
+ do{
+  i--;
+  rrpge_m_cpu_decode_blk(&(app->cdec[0]), i);
+ }while (i != 0U);
+}
+
+
+
+/* Re-decodes the instruction at the given code address after setting or
+** removing a breakpoint on it. The breakpoint traps are placed in the
+** instance's own copy of the decoded code, which is created from the
+** application image's on the first call. Returns zero if the copy could not
+** be allocated. The execution blocks running into the address are also
+** updated, which normally only affects the few instructions before it:
+** going backwards, once two consecutive records are unchanged, all records
+** before them are unchanged as well. */
+auint rrpge_m_cpu_decode_at(rrpge_object_t* hnd, auint adr)
+{
+ auint i = adr & 0xFFFFU;
+ auint u = 0U;  /* Count of consecutive unchanged records */
+ rrpge_m_cpu_dec_t* dec;
+
+ if (hnd->cdec == &(hnd->app->cdec[0])){
+  dec = rrpge_m_alloc(sizeof(rrpge_m_cpu_dec_t) * 65536U, RRPGE_M_OBJ_RAW);
+  if (dec == RRPGE_M_NULL){ return 0U; }
+  for (u = 0U; u < 65536U; u++){ dec[u] = hnd->app->cdec[u]; }
+  u = 0U;
+  hnd->cdec = dec;
+  hnd->cpu.dec = &(dec[hnd->cpu.pc & 0xFFFFU]);
+ }
+ dec = hnd->cdec;
+
+ rrpge_m_cpu_decode_op(hnd->app, dec, &(hnd->brkp[0]), i);
+ rrpge_m_cpu_decode_blk(dec, i);
+
+ while ((i != 0U) && (u < 2U)){
+  i--;
+  if (rrpge_m_cpu_decode_blk(dec, i) != 0U){ u = 0U; }
+  else                                      { u++; }
+ }
+
+ return 1U;
+}
+
+
+
+/* Returns to the application image's decoded code, freeing the instance's
+** own copy if it has any (so removing all the breakpoint traps). */
+void rrpge_m_cpu_decode_free(rrpge_object_t* hnd)
+{
+ if (hnd->cdec != &(hnd->app->cdec[0])){
+  rrpge_m_alloc_free(hnd->cdec);
+  hnd->cdec = &(hnd->app->cdec[0]);
+  hnd->cpu.dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+ }
+}
+
+
+
+/* Probes the possible idle loop starting at the current PC, running it once
+** from the given cycle count. If the loop is found to return to its start
+** in the same CPU state, without effects beyond the CPU registers, the
+** iterations fitting within the cycle limit are skipped (as they would run
+** identically). Returns the new cycle count. */
+auint rrpge_m_cpu_idle(rrpge_object_t* hnd, auint cy, auint cymax)
+{
+ auint xr[8];
+ auint xmb[2];
+ auint sp = hnd->cpu.sp;
+ auint bp = hnd->cpu.bp;
+ auint p0 = hnd->cpu.pc & 0xFFFFU;
+ auint c0 = cy;
+ auint i;
+ rrpge_m_cpu_dec_t const* dec;
+
+ for (i = 0U; i < 8U; i++){ xr[i] = hnd->cpu.xr[i]; }
+ xmb[0] = hnd->cpu.xmb[0];
+ xmb[1] = hnd->cpu.xmb[1];
+
+ /* Run one iteration instruction by instruction. It is the normal course of
+ ** emulation, so it may be abandoned any time, leaving a valid state. Within
+ ** the CPU's time slice peripherals do not progress, so memory can only
+ ** change by the loop's own writes, which are excluded. */
+
+ i = 0U;
+ do{
+  dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+  if ( (dec->opi == RRPGE_M_OPH_BRK) ||
+       ((rrpge_m_op_info(dec->opc, dec->imm) & RRPGE_M_OPI_SFX) != 0U) ){
+   return cy;
+  }
+  hnd->cpu.dec = dec;
+  hnd->cpu.opc = dec->opc;
+  cy += dec->opf(hnd);
+  if ( (rrpge_m_halt_isany(hnd)) || (cy > cymax) ){ return cy; }
+  if (((hnd->cpu.pc - p0) & 0xFFFFU) >= RRPGE_M_CPU_ILN){ return cy; }
+  i++;
+  if (i >= RRPGE_M_CPU_ILI){ return cy; }
+ }while ((hnd->cpu.pc & 0xFFFFU) != p0);
+
+ /* Back at the head: if the state is the same, every further iteration would
+ ** take the same path and cycles, so those fitting are skipped. */
+
+ for (i = 0U; i < 8U; i++){
+  if (xr[i] != hnd->cpu.xr[i]){ return cy; }
+ }
+ if ( (xmb[0] != hnd->cpu.xmb[0]) ||
+      (xmb[1] != hnd->cpu.xmb[1]) ||
+      (sp != hnd->cpu.sp) ||
+      (bp != hnd->cpu.bp) ||
+      (cy == c0) ){ return cy; }
+
+ return cy + (((cymax - cy) / (cy - c0)) * (cy - c0));
+}
+
+
+
+/* Runs the instruction at the current PC alone, also accounting it
+** in the execution profile if profiling is enabled. Returns the number of
+** cycles consumed. */
+static auint rrpge_m_cpu_step(rrpge_object_t* hnd)
+{
+ auint i = hnd->cpu.pc & 0xFFFFU;
+ auint s = hnd->prm.cys;
+ auint cy;
+ rrpge_m_cpu_dec_t const* dec = &(hnd->cdec[i]);
+
+ hnd->cpu.dec = dec;
+ hnd->cpu.opc = dec->opc;
+ cy = dec->opf(hnd);
+
+ if (hnd->cpu.prf != 0U){
+  hnd->cprf[i].cnt ++;
+  hnd->cprf[i].cyc += cy;
+  hnd->cprf[i].cys += hnd->prm.cys - s;
+ }
+
+ return cy;
+}
+
+
+
 /* Run CPU emulation for up to a given amount of cycles using the given mode.
 ** Running may finish prematurely if hitting a halt cause. Returns the number
 ** of cycles emulated. The "rmod" parameter is the run mode passed to
@@ -80,7 +380,10 @@ void rrpge_m_cpu_init(void)
 auint rrpge_m_cpu_run(rrpge_object_t* hnd, auint rmod, auint cymax)
 {
  auint cy = 0U; /* Count of emulated cycles */
- auint fo = 1U; /* Is this the first operation? (For breakpoints) */
+#ifndef RRPGE_M_THREADED
+ auint n;       /* Count of instructions to run in the execution block */
+ rrpge_m_cpu_dec_t const* dec;
+#endif
 
  /* Retrieve stack configuration */
 
@@ -94,34 +397,87 @@ auint rrpge_m_cpu_run(rrpge_object_t* hnd, auint rmod, auint cymax)
 
  /* Run */
 
- if       (rmod == RRPGE_RUN_SINGLE){ /* Single step: Process only one operation */
+ hnd->cpu.brk = 0U;                   /* Breakpoints are only armed in breakpoint mode */
+ hnd->cpu.ilp = 0U;                   /* Idle loop not probed yet */
+
+ if (rmod == RRPGE_RUN_SINGLE){       /* Single step: Process only one operation */
+
+  cy += rrpge_m_cpu_step(hnd);
+
+ }else{                               /* Normal & Breakpoint modes: run until halt */
+
+  if (rmod == RRPGE_RUN_BREAK){       /* Breakpoint mode: after 1st op, halt on any breakpoints */
+
+   /* The first operation runs even if it has a breakpoint (so the emulation
+   ** may continue from one), then the breakpoint traps are armed, so the
+   ** rest runs just like in normal mode. */
 
-  hnd->cpu.opc = hnd->crom[hnd->cpu.pc & 0xFFFFU];
-  cy += rrpge_m_optable[hnd->cpu.opc >> 9](hnd);  /* Run opcode */
+   cy += rrpge_m_cpu_step(hnd);
+   if ( (rrpge_m_halt_isany(hnd)) || (cy > cymax) ){ return cy; }
+   hnd->cpu.brk = 1U;
 
- }else if (rmod == RRPGE_RUN_BREAK){  /* Breakpoint mode: after 1st op, halt on any breakpoints */
+  }
 
-  do{
-   if (fo != 0U){                     /* First operation passed: check for breakpoints. */
-    if ( (hnd->brkp[hnd->cpu.pc >> 5]) &
-         (0x80000000U >> (hnd->cpu.pc & 0x1FU)) ){ /* Breakpoint hit */
-     rrpge_m_halt_set(hnd, RRPGE_HLT_BREAK);
-     break;
+  /* A halt cause may already be pending on entry (such as a fault raised by
+  ** the kernel's task scheduler). Then only one instruction may run, which
+  ** is done by the one by one loop, the free run paths would not notice the
+  ** halt until the end of a block or an idle loop. */
+
+  if ( (hnd->cpu.prf != 0U) ||         /* Profiling: run instructions one by one */
+       (rrpge_m_halt_isany(hnd)) ){
+
+   do{
+    cy += rrpge_m_cpu_step(hnd);
+   }while ( (!rrpge_m_halt_isany(hnd)) && (cy <= cymax) );
+
+  }else{
+
+#ifdef RRPGE_M_THREADED
+
+   cy += rrpge_m_op_run(hnd, cymax - cy);
+
+#else
+
+   /* Runs whole execution blocks if the cycle limit permits it: within a
+   ** block neither halt causes may be raised nor the flow of execution may
+   ** change, so the only check needed is for the cycle limit which is done
+   ** in advance using the worst case cycle count of the block. If it does not
+   ** permit the block, only a single instruction is run. After the block
+   ** halts are only checked if its last instruction could raise any. */
+
+   do{
+    dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+    if ( (dec->opi == RRPGE_M_OPH_IDL) &&
+         (hnd->cpu.ilp == 0U) ){       /* Idle loop head: probe it once */
+     hnd->cpu.ilp = 1U;
+     cy = rrpge_m_cpu_idle(hnd, cy, cymax);
+     if (rrpge_m_halt_isany(hnd)){ break; }
+     continue;
+    }
+    if (dec->opi == RRPGE_M_OPH_HLE){  /* Native User Library routine entry */
+     n = rrpge_m_cpuh_run(hnd, cymax - cy);
+     if (n != 0U){
+      cy += n;
+      continue;
+     }
     }
-   }
-   hnd->cpu.opc = hnd->crom[hnd->cpu.pc & 0xFFFFU];
-   cy += rrpge_m_optable[hnd->cpu.opc >> 9](hnd); /* Run opcode */
-   fo = 0U;
-   if (rrpge_m_halt_isany(hnd)){ break; } /* Some halt event happened */
-  }while (cy <= cymax);
-
- }else{                               /* Normal mode: just run until halt */
-
-  do{
-   hnd->cpu.opc = hnd->crom[hnd->cpu.pc & 0xFFFFU];
-   cy += rrpge_m_optable[hnd->cpu.opc >> 9](hnd); /* Run opcode */
-   if (rrpge_m_halt_isany(hnd)){ break; } /* Some halt event happened */
-  }while (cy <= cymax);
+    n   = 1U;
+    if ((cy + dec->bcy) <= cymax){ n = dec->bln; }
+    while (1){
+     hnd->cpu.dec = dec;
+     hnd->cpu.opc = dec->opc;
+     cy += dec->opf(hnd); /* Run opcode */
+     n--;
+     if (n == 0U){ break; }
+     dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+    }
+    if ( (dec->hlt != 0U) &&
+         (rrpge_m_halt_isany(hnd)) ){ break; } /* Some halt event happened */
+   }while (cy <= cymax);
+
+#endif
+
+  }
 
  }
 
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.02
+**  \date      2015.10.12
 */
 
 
@@ -22,6 +22,33 @@
 void rrpge_m_cpu_init(void);
 
 
+/* Pre-decodes the code memory of an application image. Must be called after
+** the code memory was loaded (it is not modified after this, so the decoded
+** records remain valid, shared by the emulation instances using the image). */
+void rrpge_m_cpu_decode(rrpge_app_t* app);
+
+
+/* Re-decodes the instruction at the given code address after setting or
+** removing a breakpoint on it (the code memory must be decoded). The
+** breakpoint traps are placed in the instance's own copy of the decoded
+** code, which is created on the first call. Returns zero if the copy could
+** not be allocated. */
+auint rrpge_m_cpu_decode_at(rrpge_object_t* hnd, auint adr);
+
+
+/* Returns to the application image's decoded code, freeing the instance's
+** own copy if it has any (so removing all the breakpoint traps). */
+void rrpge_m_cpu_decode_free(rrpge_object_t* hnd);
+
+
+/* Probes the possible idle loop starting at the current PC, running it once
+** from the given cycle count. If the loop is found to return to its start
+** in the same CPU state, without effects beyond the CPU registers, the
+** iterations fitting within the cycle limit are skipped (as they would run
+** identically). Returns the new cycle count. */
+auint rrpge_m_cpu_idle(rrpge_object_t* hnd, auint cy, auint cymax);
+
+
 /* Run CPU emulation for up to a given amount of cycles using the given mode.
 ** Running may finish prematurely if hitting a halt cause. Returns the number
 ** of cycles emulated. The "rmod" parameter is the run mode passed to
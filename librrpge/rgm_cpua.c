@@ -20,68 +20,51 @@
 
 
 /* Data mask values by pointer mode */
-static const uint16 rrpge_m_addr_dms[16] = {
+const uint16 rrpge_m_addr_dms[16] = {
  0x00FFU, 0x000FU, 0x0003U, 0x0001U, 0xFFFFU, 0xFFFFU, 0xFFFFU, 0xFFFFU,
  0x00FFU, 0x000FU, 0x0003U, 0x0001U, 0x00FFU, 0x000FU, 0x0003U, 0x0001U};
 
 /* Address fractional bit mask values by pointer mode */
-static const uint8  rrpge_m_addr_ams[16] = {
+const uint8  rrpge_m_addr_ams[16] = {
  0x8U, 0xCU, 0xEU, 0xFU, 0x0U, 0x0U, 0x0U, 0x0U,
  0x8U, 0xCU, 0xEU, 0xFU, 0x8U, 0xCU, 0xEU, 0xFU};
 
 /* Address add shift values (to increment bit address) */
-static const uint8  rrpge_m_addr_ash[16] = {
+const uint8  rrpge_m_addr_ash[16] = {
  3U, 2U, 1U, 0U, 4U, 4U, 4U, 4U, 3U, 2U, 1U, 0U, 3U, 2U, 1U, 0U};
 
 
 
-/* Data RAM read operation for assisting Read accesses. Uses the Read / Write
-** offsets, returns in hnd->cpu.add (only low 16 bits may be set). The
-** parameter is the R-M-W signal: nonzero for the read of a R-M-W access. */
-RRPGE_M_FASTCALL static void rrpge_m_addr_rd_data(rrpge_object_t* hnd, auint rmw)
+/* User Peripheral Area read for the Data RAM accesses. Also produces the
+** PRAM access stall cycle (incrementing hnd->cpu.ocy). Only low 16 bits of
+** the return value may be set. */
+RRPGE_M_FASTCALL auint rrpge_m_addr_rd_upa(rrpge_object_t* hnd, auint adr, auint rmw)
 {
- if (hnd->cpu.ada >= 0x0040U){ /* Normal RAM access */
+ /* PRAM access read stalls are generated here (1 cycle for any PRAM access)
+ ** since it is not possible for the pram component to signal this back. */
 
-  hnd->cpu.add = (hnd->st.dram[hnd->cpu.ada]) & 0xFFFFU;
-
- }else{                        /* User Peripheral Area */
-
-  /* PRAM access read stalls are generated here (1 cycle for any PRAM access)
-  ** since it is not possible for the pram component to signal this back. */
-
-  hnd->cpu.add = rrpge_m_stat_read(hnd, RRPGE_STA_UPA + hnd->cpu.ada, rmw);
-  if ((hnd->cpu.ada & 0x26U) == 0x26U){ hnd->cpu.ocy ++; }
-
- }
+ if ((adr & 0x26U) == 0x26U){ hnd->cpu.ocy ++; }
+ return rrpge_m_stat_read(hnd, RRPGE_STA_UPA + adr, rmw);
 }
 
 
 
-/* Data RAM write operation for assisting Write accesses. Uses the Read /
-** Write offsets. */
-RRPGE_M_FASTCALL static void rrpge_m_addr_wr_data(rrpge_object_t* hnd, auint val)
+/* User Peripheral Area write for the Data RAM accesses. */
+RRPGE_M_FASTCALL void  rrpge_m_addr_wr_upa(rrpge_object_t* hnd, auint adr, auint val)
 {
- if (hnd->cpu.ada >= 0x0040U){ /* Normal RAM access */
+ /* !!! This range has to be written by rrpge_m_stat_set() once the targets
+ ** implement it properly */
 
-  hnd->st.dram[hnd->cpu.ada] = val & 0xFFFFU;
+ switch (adr & 0x3CU){
 
- }else{                        /* User Peripheral Area */
+  case 0x08U:
+  case 0x0CU:                     /* FIFO */
+   rrpge_m_fifowrite(hnd, adr, val);
+   break;
 
-  /* !!! This range has to be written by rrpge_m_stat_set() once the targets
-  ** implement it properly */
-
-  switch (hnd->cpu.ada & 0x3CU){
-
-   case 0x08U:
-   case 0x0CU:                     /* FIFO */
-    rrpge_m_fifowrite(hnd->cpu.ada, val);
-    break;
-
-   default:                        /* Audio, Graphics & PRAM interface */
-    rrpge_m_stat_write(hnd, RRPGE_STA_UPA + hnd->cpu.ada, val);
-    break;
-
-  }
+  default:                        /* Audio, Graphics & PRAM interface */
+   rrpge_m_stat_write(hnd, RRPGE_STA_UPA + adr, val);
+   break;
 
  }
 }
@@ -96,9 +79,7 @@ RRPGE_M_FASTCALL static void rrpge_m_addr_wr_i4(rrpge_object_t* hnd, auint val){
 /* 01--: Stack: BP + imm4 */
 RRPGE_M_FASTCALL static void rrpge_m_addr_wr_si4(rrpge_object_t* hnd, auint val)
 {
- if (!rrpge_m_halt_isset(hnd, RRPGE_HLT_STACK)){ /* There was no error before (in read) */
-  hnd->st.dram[hnd->cpu.ada] = val & 0xFFFFU;
- }
+ rrpge_m_addr_wr_stk(hnd, val);
 }
 
 /* 1000: imm16 */
@@ -108,7 +89,10 @@ RRPGE_M_FASTCALL static void rrpge_m_addr_wr_si4(rrpge_object_t* hnd, auint val)
 #define rrpge_m_addr_wr_bi16 rrpge_m_addr_wr_i4
 
 /* 1010: Data: imm16 */
-#define rrpge_m_addr_wr_di16 rrpge_m_addr_wr_data
+RRPGE_M_FASTCALL static void rrpge_m_addr_wr_di16(rrpge_object_t* hnd, auint val)
+{
+ rrpge_m_addr_wr_data(hnd, val);
+}
 
 /* 1011: Stack: BP + imm16 */
 #define rrpge_m_addr_wr_si16 rrpge_m_addr_wr_si4
@@ -122,18 +106,14 @@ RRPGE_M_FASTCALL static void rrpge_m_addr_wr_xr(rrpge_object_t* hnd, auint val)
 /* 1110: Data: x16 */
 RRPGE_M_FASTCALL static void rrpge_m_addr_wr_dx16(rrpge_object_t* hnd, auint val)
 {
- rrpge_m_addr_wr_data(hnd, ((val << hnd->cpu.ads) & hnd->cpu.adm) |
-                           (hnd->cpu.add & (~hnd->cpu.adm)) );
+ rrpge_m_addr_set_dx16(hnd, val);
 }
 
 /* 1111: Stack: BP + x16 */
 RRPGE_M_FASTCALL static void rrpge_m_addr_wr_sx16(rrpge_object_t* hnd, auint val)
 {
- val = ((val << hnd->cpu.ads) & hnd->cpu.adm) |
-       (hnd->cpu.add & (~hnd->cpu.adm));
- if (!rrpge_m_halt_isset(hnd, RRPGE_HLT_STACK)){ /* There was no error before (in read) */
-  hnd->st.dram[hnd->cpu.ada] = val & 0xFFFFU;
- }
+ rrpge_m_addr_wr_stk(hnd, ((val << hnd->cpu.ads) & hnd->cpu.adm) |
+                          (hnd->cpu.add & (~hnd->cpu.adm)) );
 }
 
 
@@ -155,15 +135,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_si4(rrpge_object_t* hnd, auint rmw
  hnd->cpu.awf = rrpge_m_addr_wr_si4;
  hnd->cpu.ocy = 1U;
  hnd->cpu.oaw = 1U;
- hnd->cpu.ada = (((hnd->cpu.opc & 0xFU) + hnd->cpu.bp) & 0xFFFFU) |
-                (hnd->cpu.sbt & (~0xFFFFU));
- if ( (hnd->cpu.ada <  hnd->cpu.stp) &&
-      (hnd->cpu.ada >= hnd->cpu.sbt) ){
-  return ((hnd->st.dram[hnd->cpu.ada]) & 0xFFFFU);
- }else{
-  rrpge_m_halt_set(hnd, RRPGE_HLT_STACK);
-  return 0U;
- }
+ return rrpge_m_addr_get_si4(hnd);
 }
 
 /* 1000: imm16 */
@@ -172,8 +144,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_i16(rrpge_object_t* hnd, auint rmw
  hnd->cpu.awf = rrpge_m_addr_wr_i16;
  hnd->cpu.ocy = 1U;
  hnd->cpu.oaw = 2U;
- return ( ((hnd->cpu.opc & 0x3U) << 14) +
-          (hnd->crom[(hnd->cpu.pc + 1U) & 0xFFFFU] & 0x3FFFU) );
+ return hnd->cpu.dec->imm;
 }
 
 /* 1001: BP + imm16 */
@@ -182,21 +153,15 @@ RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_bi16(rrpge_object_t* hnd, auint rm
  hnd->cpu.awf = rrpge_m_addr_wr_bi16;
  hnd->cpu.ocy = 1U;
  hnd->cpu.oaw = 2U;
- return ( ( hnd->cpu.bp +
-            ((hnd->cpu.opc & 0x3U) << 14) +
-            (hnd->crom[(hnd->cpu.pc + 1U) & 0xFFFFU] & 0x3FFFU) ) & 0xFFFFU);
+ return ((hnd->cpu.bp + hnd->cpu.dec->imm) & 0xFFFFU);
 }
 
 /* 1010: Data: imm16 */
 RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_di16(rrpge_object_t* hnd, auint rmw)
 {
  hnd->cpu.awf = rrpge_m_addr_wr_di16;
- hnd->cpu.ocy = 2U;
  hnd->cpu.oaw = 2U;
- hnd->cpu.ada = ((hnd->cpu.opc & 0x3U) << 14) +
-                (hnd->crom[(hnd->cpu.pc + 1U) & 0xFFFFU] & 0x3FFFU);
- rrpge_m_addr_rd_data(hnd, rmw);
- return hnd->cpu.add;
+ return rrpge_m_addr_get_di16(hnd, rmw);
 }
 
 /* 1011: Stack: BP + imm16 */
@@ -205,9 +170,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_si16(rrpge_object_t* hnd, auint rm
  hnd->cpu.awf = rrpge_m_addr_wr_si16;
  hnd->cpu.ocy = 2U;
  hnd->cpu.oaw = 2U;
- hnd->cpu.ada = ( ( ((hnd->cpu.opc & 0x3U) << 14) +
-                    (hnd->crom[(hnd->cpu.pc + 1U) & 0xFFFFU] & 0x3FFFU) +
-                    hnd->cpu.bp ) & 0xFFFFU) |
+ hnd->cpu.ada = ((hnd->cpu.dec->imm + hnd->cpu.bp) & 0xFFFFU) |
                 (hnd->cpu.sbt & (~0xFFFFU));
  if ( (hnd->cpu.ada <  hnd->cpu.stp) &&
       (hnd->cpu.ada >= hnd->cpu.sbt) ){
@@ -230,29 +193,9 @@ RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_xr(rrpge_object_t* hnd, auint rmw)
 /* 1110: Data: x16 */
 RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_dx16(rrpge_object_t* hnd, auint rmw)
 {
- auint s = hnd->cpu.opc & 0x3U;            /* Pointer register select */
- auint t = (s << 2);                       /* 0, 4, 8 or 12, shift amount for xm & xb */
- auint m = (hnd->cpu.xmb[0] >> t) & 0xFU;  /* Pointer mode */
- auint b = (hnd->cpu.xmb[1] >> t) & 0xFU;  /* Pointer fraction */
- auint a;                                  /* Address */
-
  hnd->cpu.awf = rrpge_m_addr_wr_dx16;
  hnd->cpu.oaw = 1U;
- hnd->cpu.ocy = 1U;
-
- hnd->cpu.ads = (0xFU - b) & rrpge_m_addr_ams[m];
- hnd->cpu.adm = rrpge_m_addr_dms[m] << hnd->cpu.ads;
- hnd->cpu.ada = hnd->cpu.xr[s + 4U] & 0xFFFFU;
- a  = (hnd->cpu.ada << 4) + b;
- a += ( ((0x0F40U >> m) & 1U) |            /* 1 if post-incrementing ptr. mode */
-        ((0xF080U >> m) & rmw) ) <<        /* 1 if post-incrementing on write only mode & rmw set (it is 1) */
-      rrpge_m_addr_ash[m];
- hnd->cpu.xr[s + 4U] = a >> 4;
- hnd->cpu.xmb[1] = (hnd->cpu.xmb[1] & (~(0xFU << t))) |
-                   ((a & 0xFU) << t);      /* Address write-back */
-
- rrpge_m_addr_rd_data(hnd, rmw);
- return (hnd->cpu.add & hnd->cpu.adm) >> hnd->cpu.ads;
+ return rrpge_m_addr_get_dx16(hnd, rmw);
 }
 
 /* 1111: Stack: BP + x16 */
@@ -293,8 +236,8 @@ RRPGE_M_FASTCALL static auint rrpge_m_addr_rd_sx16(rrpge_object_t* hnd, auint rm
 
 
 /* Addressing mode specific read, function table by opcode bits 0-5. Uses
-** hnd->cpu.opc for the addressing mode further on, assumes PC points here
-** too for fetching the second opcode word as needed. Sets hnd->cpu.ocy
+** hnd->cpu.opc for the addressing mode further on, and the pre-decoded
+** record in hnd->cpu.dec for the second opcode word as needed. Sets hnd->cpu.ocy
 ** and hnd->cpu.oaw (this latter to 1 or 2) depending on the requirements
 ** of the addressing operation. Only low 16 bits of the return value may be
 ** set. */
@@ -347,6 +290,7 @@ RRPGE_M_FASTCALL void  rrpge_m_stk_push(rrpge_object_t* hnd, auint val)
  if ( (t0 <  hnd->cpu.stp) &&
       (t0 >= hnd->cpu.sbt) ){
   hnd->st.dram[t0] = val & 0xFFFFU;
+  rrpge_m_drty_dram(hnd, t0);
  }else{
   rrpge_m_halt_set(hnd, RRPGE_HLT_STACK);
  }
@@ -364,6 +308,7 @@ RRPGE_M_FASTCALL void  rrpge_m_stk_set(rrpge_object_t* hnd, auint off, auint val
  if ( (t0 <  hnd->cpu.stp) &&
       (t0 >= hnd->cpu.sbt) ){
   hnd->st.dram[t0] = val & 0xFFFFU;
+  rrpge_m_drty_dram(hnd, t0);
  }else{
   rrpge_m_halt_set(hnd, RRPGE_HLT_STACK);
  }
@@ -15,14 +15,135 @@
 
 
 #include "rgm_info.h"
+#include "rgm_halt.h"
+#include "rgm_drty.h"
+
+
+/* Data mask values by pointer mode */
+extern const uint16 rrpge_m_addr_dms[16];
+
+/* Address fractional bit mask values by pointer mode */
+extern const uint8  rrpge_m_addr_ams[16];
+
+/* Address add shift values (to increment bit address) */
+extern const uint8  rrpge_m_addr_ash[16];
+
+
+/* User Peripheral Area read for the Data RAM accesses. Also produces the
+** PRAM access stall cycle (incrementing hnd->cpu.ocy). Only low 16 bits of
+** the return value may be set. */
+RRPGE_M_FASTCALL auint rrpge_m_addr_rd_upa(rrpge_object_t* hnd, auint adr, auint rmw);
+
+
+/* User Peripheral Area write for the Data RAM accesses. */
+RRPGE_M_FASTCALL void  rrpge_m_addr_wr_upa(rrpge_object_t* hnd, auint adr, auint val);
+
+
+
+/* Addressing mode accesses. These realize the individual addressing modes
+** for both the read function table below and the specialized opcode
+** handlers, so the latter can access their operands without going through
+** the function tables. Static so they may be substituted like macros. */
+
+
+/* Data RAM read operation for assisting Read accesses. Uses hnd->cpu.ada,
+** returns in hnd->cpu.add (only low 16 bits may be set). The parameter is
+** the R-M-W signal: nonzero for the read of a R-M-W access. */
+static void  rrpge_m_addr_rd_data(rrpge_object_t* hnd, auint rmw)
+{
+ if (hnd->cpu.ada >= 0x0040U){ /* Normal RAM access */
+  hnd->cpu.add = (hnd->st.dram[hnd->cpu.ada]) & 0xFFFFU;
+ }else{                        /* User Peripheral Area */
+  hnd->cpu.add = rrpge_m_addr_rd_upa(hnd, hnd->cpu.ada, rmw);
+ }
+}
+
+/* Data RAM write operation for assisting Write accesses. Uses hnd->cpu.ada. */
+static void  rrpge_m_addr_wr_data(rrpge_object_t* hnd, auint val)
+{
+ if (hnd->cpu.ada >= 0x0040U){ /* Normal RAM access */
+  hnd->st.dram[hnd->cpu.ada] = val & 0xFFFFU;
+  rrpge_m_drty_dram(hnd, hnd->cpu.ada);
+ }else{                        /* User Peripheral Area */
+  rrpge_m_addr_wr_upa(hnd, hnd->cpu.ada, val);
+ }
+}
+
+/* Stack write operation for the stack addressing modes. Uses hnd->cpu.ada,
+** only writes if the read of the access did not fault. */
+static void  rrpge_m_addr_wr_stk(rrpge_object_t* hnd, auint val)
+{
+ if (!rrpge_m_halt_isset(hnd, RRPGE_HLT_STACK)){ /* There was no error before (in read) */
+  hnd->st.dram[hnd->cpu.ada] = val & 0xFFFFU;
+  rrpge_m_drty_dram(hnd, hnd->cpu.ada);
+ }
+}
+
+/* 01--: Stack: BP + imm4, read. */
+static auint rrpge_m_addr_get_si4(rrpge_object_t* hnd)
+{
+ hnd->cpu.ada = (((hnd->cpu.opc & 0xFU) + hnd->cpu.bp) & 0xFFFFU) |
+                (hnd->cpu.sbt & (~0xFFFFU));
+ if ( (hnd->cpu.ada <  hnd->cpu.stp) &&
+      (hnd->cpu.ada >= hnd->cpu.sbt) ){
+  return ((hnd->st.dram[hnd->cpu.ada]) & 0xFFFFU);
+ }else{
+  rrpge_m_halt_set(hnd, RRPGE_HLT_STACK);
+  return 0U;
+ }
+}
+
+/* 1010: Data: imm16, read. Sets hnd->cpu.ocy. */
+static auint rrpge_m_addr_get_di16(rrpge_object_t* hnd, auint rmw)
+{
+ hnd->cpu.ocy = 2U;
+ hnd->cpu.ada = hnd->cpu.dec->imm;
+ rrpge_m_addr_rd_data(hnd, rmw);
+ return hnd->cpu.add;
+}
+
+/* 1110: Data: x16, read. Sets hnd->cpu.ocy. */
+static auint rrpge_m_addr_get_dx16(rrpge_object_t* hnd, auint rmw)
+{
+ auint s = hnd->cpu.opc & 0x3U;            /* Pointer register select */
+ auint t = (s << 2);                       /* 0, 4, 8 or 12, shift amount for xm & xb */
+ auint m = (hnd->cpu.xmb[0] >> t) & 0xFU;  /* Pointer mode */
+ auint b = (hnd->cpu.xmb[1] >> t) & 0xFU;  /* Pointer fraction */
+ auint a;                                  /* Address */
+
+ hnd->cpu.ocy = 1U;
+
+ hnd->cpu.ads = (0xFU - b) & rrpge_m_addr_ams[m];
+ hnd->cpu.adm = rrpge_m_addr_dms[m] << hnd->cpu.ads;
+ hnd->cpu.ada = hnd->cpu.xr[s + 4U] & 0xFFFFU;
+ a  = (hnd->cpu.ada << 4) + b;
+ a += ( ((0x0F40U >> m) & 1U) |            /* 1 if post-incrementing ptr. mode */
+        ((0xF080U >> m) & rmw) ) <<        /* 1 if post-incrementing on write only mode & rmw set (it is 1) */
+      rrpge_m_addr_ash[m];
+ hnd->cpu.xr[s + 4U] = a >> 4;
+ hnd->cpu.xmb[1] = (hnd->cpu.xmb[1] & (~(0xFU << t))) |
+                   ((a & 0xFU) << t);      /* Address write-back */
+
+ rrpge_m_addr_rd_data(hnd, rmw);
+ return (hnd->cpu.add & hnd->cpu.adm) >> hnd->cpu.ads;
+}
+
+/* 1110: Data: x16, write. */
+static void  rrpge_m_addr_set_dx16(rrpge_object_t* hnd, auint val)
+{
+ rrpge_m_addr_wr_data(hnd, ((val << hnd->cpu.ads) & hnd->cpu.adm) |
+                           (hnd->cpu.add & (~hnd->cpu.adm)) );
+}
+
 
 
 /* Addressing mode specific read, function table by opcode bits 0-5. Uses
-** rrpge_m_info.opc for the addressing mode further on, assumes PC points here
-** too for fetching the second opcode word as needed. Sets rrpge_m_info.ocy
-** and rrpge_m_info.oaw (this latter to 1 or 2) depending on the requirements
-** of the addressing operation. Only low 16 bits of the return value may be
-** set. The corresponding write is to be called by rrpge_m_info.awf. */
+** hnd->cpu.opc for the addressing mode further on, and the pre-decoded
+** record in hnd->cpu.dec for the second opcode word as needed. Sets
+** hnd->cpu.ocy and hnd->cpu.oaw (this latter to 1 or 2) depending on the
+** requirements of the addressing operation. Only low 16 bits of the return
+** value may be set. The corresponding write is to be called by
+** hnd->cpu.awf. */
 extern rrpge_m_addr_read_t* const rrpge_m_addr_read_table[64];
 
 
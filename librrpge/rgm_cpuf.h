@@ -0,0 +1,877 @@
+/**
+**  \file
+**  \brief     CPU opcode handlers using the addressing unit (template)
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.08.02
+**
+**
+**  This file is included by rgm_cpuo.c several times, once for each
+**  addressing mode class an opcode handler set is specialized for, so it has
+**  no include guard. Before including it, the following macros have to be
+**  defined to realize the addressing mode:
+**
+**  RRPGE_M_OPN(n):   Name of the opcode handler "n" in the set.
+**  RRPGE_M_ARD(rmw): Operand read (expression), "rmw" is the R-M-W signal.
+**  RRPGE_M_AWR(val): Operand write (expression), only after RRPGE_M_ARD.
+**  RRPGE_M_AOW:      Count of opcode words, only after RRPGE_M_ARD.
+**  RRPGE_M_AOCY:     Extra cycles of the addressing, only after RRPGE_M_ARD.
+*/
+
+
+
+/* 0000 000r rraa aaaa: MOV adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mov_00)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ (void)(RRPGE_M_ARD(1U));
+ RRPGE_M_AWR(hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 2U;
+}
+/* 0000 001r rraa aaaa: MOV rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mov_02)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ hnd->cpu.xr[((op >> 6) & 0x7U)] = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 2U;
+}
+
+
+/* 0000 010r rraa aaaa: XCH adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xch_04)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(1U);
+ auint t1 = hnd->cpu.xr[ra];
+ RRPGE_M_AWR(t1);
+ hnd->cpu.xr[ra] = t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0000 100r rraa aaaa: ADD adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(add_08)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 + hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0000 101r rraa aaaa: ADD rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(add_0a)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[((op >> 6) & 0x7U)] += t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0000 110r rraa aaaa: SUB adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(sub_0c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 - hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0000 111r rraa aaaa: SUB rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(sub_0e)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[((op >> 6) & 0x7U)] -= t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0001 000r rraa aaaa: ASR adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(asr_10)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ RRPGE_M_AWR((t1 >> t0) | ((0U - (t1 >> 15U)) << (15U - t0)) );
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0001 001r rraa aaaa: ASR rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(asr_12)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
+ hnd->cpu.xr[ra] = (t1 >> t0) | ((0U - (t1 >> 15U)) << (15U - t0));
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0001 010r rraa aaaa: DIV adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(div_14)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ auint t1 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU;
+ if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
+  t1 = t0 / t1;
+ }
+ RRPGE_M_AWR(t1);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 20U;
+}
+/* 0001 011r rraa aaaa: DIV rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(div_16)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t1 = RRPGE_M_ARD(0U);
+ auint t0 = hnd->cpu.xr[ra] & 0xFFFFU;
+ if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
+  t1 = t0 / t1;
+ }
+ hnd->cpu.xr[ra] = t1;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 20U;
+}
+
+
+/* 0001 100r rraa aaaa: ADC adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(adc_18)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR((t0 + hnd->cpu.xr[((op >> 6) & 0x7U)]) +
+             (hnd->cpu.xr[REG_C] & 1U) );
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0001 101r rraa aaaa: ADC rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(adc_1a)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[ra] = (hnd->cpu.xr[ra] + t0) +
+                   (hnd->cpu.xr[REG_C] & 1U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0001 110r rraa aaaa: SBC adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(sbc_1c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR((t0 - hnd->cpu.xr[((op >> 6) & 0x7U)]) -
+             (hnd->cpu.xr[REG_C] & 1U) );
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0001 111r rraa aaaa: SBC rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(sbc_1e)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[ra] = (hnd->cpu.xr[ra] - t0) -
+                   (hnd->cpu.xr[REG_C] & 1U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0010 000r rraa aaaa: NOT adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(not_20)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ (void)(RRPGE_M_ARD(1U));
+ RRPGE_M_AWR(hnd->cpu.xr[((op >> 6) & 0x7U)] ^ 0xFFFFU);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 2U;
+}
+/* 0010 001r rraa aaaa: NOT rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(not_22)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ hnd->cpu.xr[((op >> 6) & 0x7U)] = RRPGE_M_ARD(0U) ^ 0xFFFFU;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 2U;
+}
+
+
+/* 0010 010r rraa aaaa: MUL adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mul_24)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 * hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 12U;
+}
+/* 0010 011r rraa aaaa: MUL rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mul_26)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[((op >> 6) & 0x7U)] *= t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 12U;
+}
+
+
+/* 0010 100r rraa aaaa: SHR adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shr_28)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 >> (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU));
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0010 101r rraa aaaa: SHR rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shr_2a)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[ra] = (hnd->cpu.xr[ra] & 0xFFFFU) >> (t0 & 0xFU);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0010 110r rraa aaaa: SHL adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shl_2c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 << (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU));
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0010 111r rraa aaaa: SHL rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shl_2e)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[((op >> 6) & 0x7U)] <<= t0 & 0xFU;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0011 000r rraa aaaa: OR adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(or_30)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 | hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0011 001r rraa aaaa: OR rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(or_32)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[((op >> 6) & 0x7U)] |= t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0011 010r rraa aaaa: MAC adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mac_34)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR((t0 * hnd->cpu.xr[((op >> 6) & 0x7U)]) +
+             hnd->cpu.xr[REG_C]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 13U;
+}
+/* 0011 011r rraa aaaa: MAC rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mac_36)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[ra] = (t0 * hnd->cpu.xr[ra]) +
+                   hnd->cpu.xr[REG_C];
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 13U;
+}
+
+
+/* 0011 100r rraa aaaa: SRC adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(src_38)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ RRPGE_M_AWR((t1 >> t0) | hnd->cpu.xr[REG_C] );
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0011 101r rraa aaaa: SRC rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(src_3a)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
+ hnd->cpu.xr[ra] = (t1 >> t0) | hnd->cpu.xr[REG_C];
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0011 110r rraa aaaa: SLC adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(slc_3c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ RRPGE_M_AWR((t1 << t0) | hnd->cpu.xr[REG_C] );
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0011 111r rraa aaaa: SLC rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(slc_3e)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra];
+ hnd->cpu.xr[ra] = (t1 << t0) | hnd->cpu.xr[REG_C];
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0100 000p rraa aaaa: MOV adr, xmn/xbn (Pointer mode moves) */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mov_40)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ (void)(RRPGE_M_ARD(1U));
+ RRPGE_M_AWR(( hnd->cpu.xmb[(op >> 8) & 0x1U] >>
+               ((op >> 4) & 0xCU) ) & 0xFU);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 2U;
+}
+/* 0100 001p rraa aaaa: MOV xmn/xbn, adr (Pointer mode moves) */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mov_42)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = (op >> 8) & 0x1U;
+ auint t1 = (op >> 4) & 0xCU;
+ auint t2 = RRPGE_M_ARD(0U);
+ hnd->cpu.xmb[t0] = (hnd->cpu.xmb[t0] & (~(0xFU << t1))) |
+                    ((t2 & 0xFU) << t1);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 2U;
+}
+
+
+/* 0100 100r rraa aaaa: ADD C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(addc_48)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ t0 = t0 + (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU);
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0100 101r rraa aaaa: ADD C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(addc_4a)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ t0 = (hnd->cpu.xr[ra] & 0xFFFFU) + t0;
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0100 110r rraa aaaa: SUB C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(subc_4c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ t0 = t0 - (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU);
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0100 111r rraa aaaa: SUB C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(subc_4e)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ t0 = (hnd->cpu.xr[ra] & 0xFFFFU) - t0;
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0101 000r rraa aaaa: ASR C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(asrc_50)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ t0 = (t1 << (16U - t0)) | ((0U - (t1 >> 15U)) << (31U - t0));
+ RRPGE_M_AWR(t0 >> 16);
+ hnd->cpu.xr[REG_C] = t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0101 001r rraa aaaa: ASR C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(asrc_52)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
+ t0 = (t1 << (16U - t0)) | ((0U - (t1 >> 15U)) << (31U - t0));
+ hnd->cpu.xr[ra]    = t0 >> 16;
+ hnd->cpu.xr[REG_C] = t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0101 010r rraa aaaa: DIV C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(divc_54)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ auint t1 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU;
+ auint t2 = 0U;
+ if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
+  t2 = t0 % t1;
+  t1 = t0 / t1;
+ }
+ RRPGE_M_AWR(t1);
+ hnd->cpu.xr[REG_C] = t2;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 21U;
+}
+/* 0101 011r rraa aaaa: DIV C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(divc_56)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t1 = RRPGE_M_ARD(0U);
+ auint t0 = hnd->cpu.xr[ra] & 0xFFFFU;
+ auint t2 = 0U;
+ if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
+  t2 = t0 % t1;
+  t1 = t0 / t1;
+ }
+ hnd->cpu.xr[ra]    = t1;
+ hnd->cpu.xr[REG_C] = t2;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 21U;
+}
+
+
+/* 0101 100r rraa aaaa: ADC C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(adcc_58)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ t0 = (t0 + (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)) +
+      (hnd->cpu.xr[REG_C] & 1U);
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0101 101r rraa aaaa: ADC C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(adcc_5a)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ t0 = ((hnd->cpu.xr[ra] & 0xFFFFU) + t0) +
+      (hnd->cpu.xr[REG_C] & 1U);
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0101 110r rraa aaaa: SBC C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(sbcc_5c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ t0 = (t0 - (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)) -
+      (hnd->cpu.xr[REG_C] & 1U);
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0101 111r rraa aaaa: SBC C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(sbcc_5e)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ t0 = ((hnd->cpu.xr[ra] & 0xFFFFU) - t0) -
+      (hnd->cpu.xr[REG_C] & 1U);
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0110 000r rraa aaaa: NEG adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(neg_60)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ (void)(RRPGE_M_ARD(1U));
+ RRPGE_M_AWR(0U - hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0110 001r rraa aaaa: NEG rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(neg_62)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ hnd->cpu.xr[((op >> 6) & 0x7U)] = 0U - RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0110 010r rraa aaaa: MUL C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mulc_64)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ t0 = t0 * (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU);
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 13U;
+}
+/* 0110 011r rraa aaaa: MUL C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(mulc_66)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ t0 = (hnd->cpu.xr[ra] & 0xFFFFU) * t0;
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 13U;
+}
+
+
+/* 0110 100r rraa aaaa: SHR C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shrc_68)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ t0 = t1 << (16U - t0);
+ RRPGE_M_AWR(t0 >> 16);
+ hnd->cpu.xr[REG_C] = t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0110 101r rraa aaaa: SHR C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shrc_6a)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
+ t0 = t1 << (16U - t0);
+ hnd->cpu.xr[ra]    = t0 >> 16;
+ hnd->cpu.xr[REG_C] = t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0110 110r rraa aaaa: SHL C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shlc_6c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ t0 = t1 << t0;
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0110 111r rraa aaaa: SHL C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(shlc_6e)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
+ t0 = t1 << t0;
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0111 000r rraa aaaa: XOR adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xor_70)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 ^ hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 0111 001r rraa aaaa: XOR rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xor_72)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[((op >> 6) & 0x7U)] ^= t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 0111 010r rraa aaaa: MAC C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(macc_74)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ t0 = (t0 * (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)) +
+      (hnd->cpu.xr[REG_C] & 0xFFFFU);
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 14U;
+}
+/* 0111 011r rraa aaaa: MAC C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(macc_76)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U);
+ t0 = ((hnd->cpu.xr[ra] & 0xFFFFU) * t0) +
+      (hnd->cpu.xr[REG_C] & 0xFFFFU);
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 14U;
+}
+
+
+/* 0111 100r rraa aaaa: SRC C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(srcc_78)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ t0 = (t1 << (16U - t0)) | (hnd->cpu.xr[REG_C] << 16);
+ RRPGE_M_AWR(t0 >> 16);
+ hnd->cpu.xr[REG_C] = t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0111 101r rraa aaaa: SRC C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(srcc_7a)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
+ t0 = (t1 << (16U - t0)) | (hnd->cpu.xr[REG_C] << 16);
+ hnd->cpu.xr[ra]    = t0 >> 16;
+ hnd->cpu.xr[REG_C] = t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 0111 110r rraa aaaa: SLC C:adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(slcc_7c)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t1 = RRPGE_M_ARD(1U);
+ auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
+ t0 = (t1 << t0) | (hnd->cpu.xr[REG_C] & 0xFFFFU);
+ RRPGE_M_AWR(t0);
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+/* 0011 111r rraa aaaa: SLC C:rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(slcc_7e)(rrpge_object_t* hnd)
+{
+ auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
+ auint t0 = RRPGE_M_ARD(0U) & 0xFU;
+ auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
+ t0 = (t1 << t0) | (hnd->cpu.xr[REG_C] & 0xFFFFU);
+ hnd->cpu.xr[ra]    = t0;
+ hnd->cpu.xr[REG_C] = t0 >> 16;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 4U;
+}
+
+
+/* 1010 00ii iiaa aaaa: BTC adr, imm4 */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(btc_a0)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 & (~((auint)(1U) << ((op >> 6) & 0xFU))));
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 1010 10ii iiaa aaaa: BTS adr, imm4 */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(bts_a8)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 | ( ((auint)(1U) << ((op >> 6) & 0xFU))));
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 1010 01ii iiaa aaaa: XBC adr, imm4 */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xbc_a4)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if ( (t0 & ((auint)(1U) << ((op >> 6) & 0xFU))) == 0U){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
+/* 1010 11ii iiaa aaaa: XBS adr, imm4 */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xbs_ac)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if ( (t0 & ((auint)(1U) << ((op >> 6) & 0xFU))) != 0U){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 1000 100r rraa aaaa: AND adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(and_b0)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(1U);
+ RRPGE_M_AWR(t0 & hnd->cpu.xr[((op >> 6) & 0x7U)]);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+/* 1000 101r rraa aaaa: AND rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(and_b2)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.xr[((op >> 6) & 0x7U)] &= t0;
+ hnd->cpu.pc += RRPGE_M_AOW;
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 1011 010r rraa aaaa: XSG adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xsg_b4)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if ( ((t0 + 0x8000U) & 0xFFFFU) >
+      ((hnd->cpu.xr[((op >> 6) & 0x7U)] + 0x8000U) & 0xFFFFU) ){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
+/* 1011 011r rraa aaaa: XSG rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xsg_b6)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if ( ((t0 + 0x8000U) & 0xFFFFU) <
+      ((hnd->cpu.xr[((op >> 6) & 0x7U)] + 0x8000U) & 0xFFFFU) ){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 1011 100r rraa aaaa: XEQ adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xeq_b8)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if (t0 == (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
+/* 1011 101r rraa aaaa: XNE rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xne_ba)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if (t0 != (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
+
+
+/* 1011 110r rraa aaaa: XUG adr, rx */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xug_bc)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if (t0 > (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
+/* 1011 111r rraa aaaa: XUG rx, adr */
+RRPGE_M_FASTCALL static auint RRPGE_M_OPN(xug_be)(rrpge_object_t* hnd)
+{
+ auint op = hnd->cpu.opc;
+ auint t0 = RRPGE_M_ARD(0U);
+ hnd->cpu.pc += RRPGE_M_AOW;
+ if (t0 < (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
+  hnd->cpu.pc++;
+  return RRPGE_M_AOCY + 4U;
+ }
+ return RRPGE_M_AOCY + 3U;
+}
@@ -0,0 +1,370 @@
+/**
+**  \file
+**  \brief     CPU emulation: native User Library routines
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.12
+*/
+
+
+#include "rgm_cpuh.h"
+#include "rgm_cpu.h"
+#include "rgm_cpua.h"
+#include "rgm_ulib.h"
+
+
+
+/* Address of the carry register within hnd->cpu.xr */
+#define REG_C 2U
+
+/* Native routine kinds */
+#define KND_NONE 0U     /* Not realized natively */
+#define KND_PBIT 1U     /* Pointer setup by bit address (0xE1A1) */
+#define KND_PWRD 2U     /* Pointer setup by word address (0xE186) */
+#define KND_PDWD 3U     /* Pointer setup by word address & increment (0xE16A) */
+#define KND_PALL 4U     /* Pointer setup by all registers (0xE158) */
+#define KND_FILP 5U     /* PRAM fill (0xE1B6) */
+#define KND_FILX 6U     /* Fill through pointer (0xE1EB) */
+
+/* Count of jump table entries covered */
+#define ENT_CNT  22U
+
+/* Native routines by jump table entry (0xE000 + 2 * index): kind, value
+** loaded in X3 by the entry's code, and cycles taken by the entry (the jump
+** table's JMA, and the X3 load and JMS before the routine's body). */
+static const uint8 rrpge_m_cpuh_ent[ENT_CNT * 3U] = {
+ KND_PBIT,  0U, 11U,  KND_PBIT,  8U, 11U,  KND_PBIT,  1U, 11U,
+ KND_PBIT,  9U, 11U,  KND_PBIT,  2U, 11U,  KND_PBIT, 10U, 11U,
+ KND_PBIT,  3U, 11U,  KND_PBIT, 11U, 11U,  KND_PBIT,  4U,  7U,
+ KND_PBIT, 12U, 11U,  KND_PWRD,  4U,  7U,  KND_PWRD, 12U, 11U,
+ KND_PDWD,  4U,  7U,  KND_PDWD, 12U, 11U,  KND_PALL,  0U,  5U,
+ KND_NONE,  0U,  0U,  KND_NONE,  0U,  0U,  KND_NONE,  0U,  0U,
+ KND_NONE,  0U,  0U,  KND_NONE,  0U,  0U,  KND_FILP,  0U,  5U,
+ KND_FILX,  0U,  5U};
+
+/* Count of stack parameters used by each kind */
+static const uint8 rrpge_m_cpuh_stp[7] = {0U, 3U, 3U, 5U, 6U, 4U, 3U};
+
+/* Code addresses where the routines return (their RFN), by kind */
+static const uint16 rrpge_m_cpuh_ret[7] = {
+ 0x0000U, 0xE19DU, 0xE19DU, 0xE182U, 0xE168U, 0xE1EAU, 0xE1EAU};
+
+/* Worst case cycles of the routines, excluding the fills' words */
+#define CY_MAX   128U
+
+/* Worst case cycles of filling a word */
+#define CY_WRD   5U
+
+
+
+/* Checks whether the User Library in the code memory is intact (the
+** application's code may overlap it). Must be called after the code memory
+** was loaded, before pre-decoding it. */
+void  rrpge_m_cpuh_check(rrpge_app_t* app)
+{
+ auint i;
+
+ app->ulv = 1U;
+ for (i = 0U; i < RRPGE_M_ULIB_SIZE; i++){
+  if (app->crom[0xE000U + i] != rrpge_m_ulib[i]){
+   app->ulv = 0U;
+   break;
+  }
+ }
+}
+
+
+
+/* Returns nonzero if the given code address is an entry point of a native
+** User Library routine. Whether the routines are used is up to the emulation
+** instance (see rrpge_m_cpuh_run()). */
+auint rrpge_m_cpuh_isentry(rrpge_app_t const* app, auint adr)
+{
+ auint i = (adr - 0xE000U) & 0xFFFFU;
+
+ if ( (app->ulv == 0U) ||
+      ((i & 1U) != 0U) ||
+      ((i >> 1) >= ENT_CNT) ){ return 0U; }
+ return (rrpge_m_cpuh_ent[(i >> 1) * 3U] != KND_NONE);
+}
+
+
+
+/* Stack address of a BP relative parameter */
+static auint rrpge_m_cpuh_sta(rrpge_object_t* hnd, auint off)
+{
+ return ((hnd->cpu.bp + off) & 0xFFFFU) | (hnd->cpu.sbt & (~0xFFFFU));
+}
+
+/* MOV rx, [bp + off]: returns cycles. Like the stack accesses below, it
+** leaves the address in the Addressing unit as the emulated op. would, so
+** native and emulated runs produce identical states. */
+static auint rrpge_m_cpuh_ld(rrpge_object_t* hnd, auint r, auint off)
+{
+ hnd->cpu.ada = rrpge_m_cpuh_sta(hnd, off);
+ hnd->cpu.xr[r] = hnd->st.dram[hnd->cpu.ada] & 0xFFFFU;
+ return 3U;
+}
+
+/* MOV [bp + off], rx: returns cycles */
+static auint rrpge_m_cpuh_st(rrpge_object_t* hnd, auint r, auint off)
+{
+ auint a = rrpge_m_cpuh_sta(hnd, off);
+ hnd->cpu.ada = a;
+ hnd->st.dram[a] = hnd->cpu.xr[r] & 0xFFFFU;
+ rrpge_m_drty_dram(hnd, a);
+ return 3U;
+}
+
+/* XCH [bp + off], rx: returns cycles */
+static auint rrpge_m_cpuh_xch(rrpge_object_t* hnd, auint r, auint off)
+{
+ auint a = rrpge_m_cpuh_sta(hnd, off);
+ auint t = hnd->st.dram[a] & 0xFFFFU;
+ hnd->cpu.ada = a;
+ hnd->st.dram[a] = hnd->cpu.xr[r] & 0xFFFFU;
+ hnd->cpu.xr[r]  = t;
+ rrpge_m_drty_dram(hnd, a);
+ return 4U;
+}
+
+/* MOV [imm16], rx (data): returns cycles */
+static auint rrpge_m_cpuh_wrd(rrpge_object_t* hnd, auint adr, auint r)
+{
+ hnd->cpu.ocy = 2U;
+ hnd->cpu.ada = adr;
+ rrpge_m_addr_rd_data(hnd, 1U);
+ rrpge_m_addr_wr_data(hnd, hnd->cpu.xr[r]);
+ return hnd->cpu.ocy + 2U;
+}
+
+/* MOV [X3], rx (data, by the pointer mode): returns cycles */
+static auint rrpge_m_cpuh_wrx(rrpge_object_t* hnd, auint r)
+{
+ hnd->cpu.opc = 0x003BU;        /* Selects X3 for the addressing unit */
+ (void)(rrpge_m_addr_get_dx16(hnd, 1U));
+ rrpge_m_addr_set_dx16(hnd, hnd->cpu.xr[r]);
+ return hnd->cpu.ocy + 2U;
+}
+
+/* SHL C:rx, 4 & SLC ry, 4 (shifting a 32 bit value): returns cycles */
+static auint rrpge_m_cpuh_sh4(rrpge_object_t* hnd, auint rx, auint ry)
+{
+ auint t = (hnd->cpu.xr[rx] & 0xFFFFU) << 4;
+ hnd->cpu.xr[rx]    = t;
+ hnd->cpu.xr[REG_C] = t >> 16;
+ hnd->cpu.xr[ry]    = (hnd->cpu.xr[ry] << 4) | hnd->cpu.xr[REG_C];
+ return 4U + 3U;
+}
+
+/* MOV X3, [bp + 0]; AND X3, 3; SHL X3, 3; ADD X3, 0x20 (pointer select):
+** returns cycles */
+static auint rrpge_m_cpuh_psel(rrpge_object_t* hnd)
+{
+ auint cy = rrpge_m_cpuh_ld(hnd, 7U, 0U);
+ hnd->cpu.xr[7] &= 3U;
+ hnd->cpu.xr[7] <<= 3;
+ hnd->cpu.xr[7] += 0x20U;
+ return cy + 3U + 3U + 4U;
+}
+
+/* Fills C words with A through X3 (0xE1CC - 0xE1E9): returns cycles */
+static auint rrpge_m_cpuh_fill(rrpge_object_t* hnd)
+{
+ auint cy = 0U;
+ auint i;
+ auint n;
+
+ for (i = 4U; i != 0U; i >>= 1){  /* XBS C, 2 / 1 / 0 */
+  if ((hnd->cpu.xr[REG_C] & 0xFFFFU & i) != 0U){
+   cy += 4U;
+   for (n = 0U; n < i; n++){ cy += rrpge_m_cpuh_wrx(hnd, 0U); }
+   hnd->cpu.xr[REG_C] -= i;
+   cy += 3U;
+  }else{
+   cy += 3U + 4U;
+  }
+ }
+
+ if ((hnd->cpu.xr[REG_C] & 0xFFFFU) != 0U){ /* XNE C, 0 */
+  cy += 4U;
+  while (1){
+   for (n = 0U; n < 8U; n++){ cy += rrpge_m_cpuh_wrx(hnd, 0U); }
+   hnd->cpu.xr[REG_C] -= 8U;
+   cy += 3U;
+   if ((hnd->cpu.xr[REG_C] & 0xFFFFU) == 0U){ break; } /* JNZ C */
+   cy += 4U;
+  }
+  cy += 2U;
+ }else{
+  cy += 3U + 4U;
+ }
+
+ cy += rrpge_m_cpuh_ld(hnd, 0U, 0U);
+ hnd->cpu.xmb[0] = (hnd->cpu.xmb[0] & 0x0FFFU) | 0x6000U; /* MOV XM3, 6 */
+ return cy + 2U;
+}
+
+
+
+/* Runs the User Library routine entered at the current PC natively if
+** native routines are enabled, its worst case cycle count fits in the given
+** cycles and it can not raise halt causes. Returns the cycles consumed, or
+** zero if the routine was not run (then it has to be emulated). On return
+** the PC is at the return of the routine which is left for emulation. */
+auint rrpge_m_cpuh_run(rrpge_object_t* hnd, auint cyr)
+{
+ uint8 const* ent = &(rrpge_m_cpuh_ent[(((hnd->cpu.pc & 0xFFFFU) - 0xE000U) >> 1) * 3U]);
+ auint knd = ent[0];
+ auint cy  = ent[2];
+ auint i;
+ auint a;
+
+ /* Native routines must be enabled, and no breakpoints may be armed (those
+ ** within the routine must be hit by emulating it) */
+
+ if (hnd->cpu.hle == 0U){ return 0U; }
+ if (hnd->cpu.brk != 0U){ return 0U; }
+
+ /* The stack parameters must be accessible, otherwise the emulation raises
+ ** the stack fault. */
+
+ for (i = 0U; i < rrpge_m_cpuh_stp[knd]; i++){
+  a = rrpge_m_cpuh_sta(hnd, i);
+  if ( (a >= hnd->cpu.stp) ||
+       (a <  hnd->cpu.sbt) ){ return 0U; }
+ }
+
+ /* Check the cycles: the routine must complete within the given cycles so
+ ** it is not interrupted by peripheral processing. */
+
+ i = CY_MAX;
+ if      (knd == KND_FILP){ i += (hnd->st.dram[rrpge_m_cpuh_sta(hnd, 3U)] & 0xFFFFU) * CY_WRD; }
+ else if (knd == KND_FILX){ i += (hnd->st.dram[rrpge_m_cpuh_sta(hnd, 2U)] & 0xFFFFU) * CY_WRD; }
+ else{}
+ if (i > cyr){ return 0U; }
+
+ /* Run the routine */
+
+ switch (knd){
+
+  case KND_PBIT:
+  case KND_PWRD:
+   hnd->cpu.xr[7] = ent[1];
+   cy += rrpge_m_cpuh_xch(hnd, 0U, 1U);
+   cy += rrpge_m_cpuh_xch(hnd, 1U, 2U);
+   if (knd == KND_PBIT){
+    cy += 4U;                   /* JMS */
+   }else{
+    cy += rrpge_m_cpuh_sh4(hnd, 1U, 0U);
+   }
+   hnd->cpu.xr[REG_C] = hnd->cpu.xr[7];
+   cy += 2U;
+   cy += rrpge_m_cpuh_psel(hnd);
+   cy += rrpge_m_cpuh_wrx(hnd, 0U);
+   cy += rrpge_m_cpuh_wrx(hnd, 1U);
+   hnd->cpu.xr[0] = 0U;
+   cy += 2U;
+   cy += rrpge_m_cpuh_wrx(hnd, 0U);
+   hnd->cpu.xr[0] = 1U;
+   hnd->cpu.xr[1] = hnd->cpu.xr[REG_C];
+   hnd->cpu.xr[1] &= 7U;
+   hnd->cpu.xr[0] = (hnd->cpu.xr[0] & 0xFFFFU) << (hnd->cpu.xr[1] & 0xFU);
+   cy += 2U + 2U + 3U + 3U;
+   cy += rrpge_m_cpuh_wrx(hnd, 0U);
+   cy += rrpge_m_cpuh_wrx(hnd, REG_C);
+   hnd->cpu.xr[7] += 2U;
+   cy += 3U;
+   cy += rrpge_m_cpuh_ld(hnd, 0U, 1U);
+   cy += rrpge_m_cpuh_ld(hnd, 1U, 2U);
+   break;
+
+  case KND_PDWD:
+   hnd->cpu.xr[7] = ent[1];
+   cy += rrpge_m_cpuh_xch(hnd, 0U, 1U);
+   cy += rrpge_m_cpuh_xch(hnd, 1U, 2U);
+   cy += rrpge_m_cpuh_sh4(hnd, 1U, 0U);
+   cy += rrpge_m_cpuh_xch(hnd, 4U, 3U);
+   cy += rrpge_m_cpuh_xch(hnd, 5U, 4U);
+   cy += rrpge_m_cpuh_sh4(hnd, 5U, 4U);
+   hnd->cpu.xr[REG_C] = hnd->cpu.xr[7];
+   cy += 2U;
+   cy += rrpge_m_cpuh_psel(hnd);
+   cy += rrpge_m_cpuh_wrx(hnd, 0U);
+   cy += rrpge_m_cpuh_wrx(hnd, 1U);
+   cy += rrpge_m_cpuh_wrx(hnd, 4U);
+   cy += rrpge_m_cpuh_wrx(hnd, 5U);
+   cy += rrpge_m_cpuh_wrx(hnd, REG_C);
+   hnd->cpu.xr[7] += 2U;
+   cy += 3U;
+   cy += rrpge_m_cpuh_ld(hnd, 0U, 1U);
+   cy += rrpge_m_cpuh_ld(hnd, 1U, 2U);
+   cy += rrpge_m_cpuh_ld(hnd, 4U, 3U);
+   cy += rrpge_m_cpuh_ld(hnd, 5U, 4U);
+   break;
+
+  case KND_PALL:
+   cy += rrpge_m_cpuh_psel(hnd);
+   for (i = 1U; i < 6U; i++){
+    cy += rrpge_m_cpuh_ld(hnd, REG_C, i);
+    cy += rrpge_m_cpuh_wrx(hnd, REG_C);
+   }
+   hnd->cpu.xr[7] += 2U;
+   cy += 3U;
+   break;
+
+  case KND_FILP:
+   cy += rrpge_m_cpuh_ld(hnd, 7U, 1U);
+   hnd->cpu.xr[7]    <<= 4;     /* SHL C:X3, 4 */
+   hnd->cpu.xr[REG_C] = hnd->cpu.xr[7] >> 16;
+   cy += 4U;
+   cy += rrpge_m_cpuh_wrd(hnd, 0x39U, 7U);
+   cy += rrpge_m_cpuh_ld(hnd, 7U, 0U);
+   hnd->cpu.xr[7] = (hnd->cpu.xr[7] << 4) | hnd->cpu.xr[REG_C];
+   cy += 3U;
+   cy += rrpge_m_cpuh_wrd(hnd, 0x38U, 7U);
+   hnd->cpu.xr[7] = 0U;
+   cy += 2U;
+   cy += rrpge_m_cpuh_wrd(hnd, 0x3AU, 7U);
+   hnd->cpu.xr[7] = (hnd->cpu.xr[7] & 0xFFFFU) | 0x10U;
+   cy += 3U;
+   cy += rrpge_m_cpuh_wrd(hnd, 0x3BU, 7U);
+   hnd->cpu.xr[7] = 4U;
+   cy += 2U;
+   cy += rrpge_m_cpuh_wrd(hnd, 0x3CU, 7U);
+   hnd->cpu.xr[7] = 0x3FU;
+   hnd->cpu.xmb[0] = (hnd->cpu.xmb[0] & 0x0FFFU) | 0x4000U; /* MOV XM3, 4 */
+   cy += 2U + 2U;
+   cy += rrpge_m_cpuh_st(hnd, 0U, 0U);
+   cy += rrpge_m_cpuh_ld(hnd, 0U, 2U);
+   cy += rrpge_m_cpuh_ld(hnd, REG_C, 3U);
+   cy += rrpge_m_cpuh_fill(hnd);
+   break;
+
+  default:                      /* KND_FILX */
+   cy += rrpge_m_cpuh_ld(hnd, 7U, 0U);
+   cy += rrpge_m_cpuh_st(hnd, 0U, 0U);
+   cy += rrpge_m_cpuh_ld(hnd, 0U, 1U);
+   cy += rrpge_m_cpuh_ld(hnd, REG_C, 2U);
+   cy += 4U;                    /* JMS */
+   cy += rrpge_m_cpuh_fill(hnd);
+   break;
+
+ }
+
+ hnd->cpu.pc = rrpge_m_cpuh_ret[knd];
+ return cy;
+}
+
+
+
+/* Toggles native User Library routines - implementation of RRPGE library
+** function */
+void rrpge_enanative(rrpge_object_t* hnd, rrpge_ibool tg)
+{
+ if (tg){ hnd->cpu.hle = 1U; }
+ else   { hnd->cpu.hle = 0U; }
+}
@@ -0,0 +1,47 @@
+/**
+**  \file
+**  \brief     CPU emulation: native User Library routines
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.12
+**
+**
+**  Some User Library routines are realized natively, replacing the emulation
+**  of their code when entered through the User Library's jump table. The
+**  native routines perform the same memory and register accesses in the same
+**  order as the emulated code, and produce the same cycle count, so the
+**  emulation state is identical with either.
+*/
+
+
+#ifndef RRPGE_M_CPUH_H
+#define RRPGE_M_CPUH_H
+
+
+#include "rgm_info.h"
+
+
+/* Checks whether the User Library in the code memory is intact (the
+** application's code may overlap it). Must be called after the code memory
+** was loaded, before pre-decoding it. */
+void  rrpge_m_cpuh_check(rrpge_app_t* app);
+
+
+/* Returns nonzero if the given code address is an entry point of a native
+** User Library routine. Whether the routines are used is up to the emulation
+** instance (see rrpge_m_cpuh_run()). */
+auint rrpge_m_cpuh_isentry(rrpge_app_t const* app, auint adr);
+
+
+/* Runs the User Library routine entered at the current PC natively if
+** native routines are enabled, its worst case cycle count fits in the given
+** cycles and it can not raise halt causes. Returns the cycles consumed, or
+** zero if the routine was not run (then it has to be emulated). On return
+** the PC is at the return of the routine which is left for emulation. */
+auint rrpge_m_cpuh_run(rrpge_object_t* hnd, auint cyr);
+
+
+#endif
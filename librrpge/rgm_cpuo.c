@@ -6,11 +6,13 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.02
+**  \date      2015.10.12
 */
 
 
 #include "rgm_cpuo.h"
+#include "rgm_cpu.h"
+#include "rgm_cpuh.h"
 #include "rgm_cpua.h"
 #include "rgm_krnm.h"
 #include "rgm_halt.h"
@@ -26,36 +28,102 @@
 #define REG_C 2U
 
 
-/* 0000 000r rraa aaaa: MOV adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mov_00(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- (void)(rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U));
- hnd->cpu.awf(hnd, hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 2U;
-}
-/* 0000 001r rraa aaaa: MOV rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mov_02(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- hnd->cpu.xr[((op >> 6) & 0x7U)] = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 2U;
-}
 
+/* Opcode handlers using the addressing unit (rgm_cpuf.h). The generic set
+** goes through the addressing unit's function tables, so it is usable with
+** any addressing mode. The specialized sets realize one addressing mode
+** class each, accessing the operand directly. */
+
+#define RRPGE_M_OPN(n)   rrpge_m_op_##n
+#define RRPGE_M_ARD(rmw) hnd->cpu.dec->arf(hnd, rmw)
+#define RRPGE_M_AWR(val) hnd->cpu.awf(hnd, val)
+#define RRPGE_M_AOW      hnd->cpu.oaw
+#define RRPGE_M_AOCY     hnd->cpu.ocy
+#include "rgm_cpuf.h"
+#undef  RRPGE_M_OPN
+#undef  RRPGE_M_ARD
+#undef  RRPGE_M_AWR
+#undef  RRPGE_M_AOW
+#undef  RRPGE_M_AOCY
+
+/* 00--: imm4 */
+#define RRPGE_M_OPN(n)   rrpge_m_op_##n##_i4
+#define RRPGE_M_ARD(rmw) (hnd->cpu.opc & 0xFU)
+#define RRPGE_M_AWR(val) (void)(val)
+#define RRPGE_M_AOW      1U
+#define RRPGE_M_AOCY     0U
+#include "rgm_cpuf.h"
+#undef  RRPGE_M_OPN
+#undef  RRPGE_M_ARD
+#undef  RRPGE_M_AWR
+#undef  RRPGE_M_AOW
+#undef  RRPGE_M_AOCY
+
+/* 01--: Stack: BP + imm4 */
+#define RRPGE_M_OPN(n)   rrpge_m_op_##n##_si4
+#define RRPGE_M_ARD(rmw) rrpge_m_addr_get_si4(hnd)
+#define RRPGE_M_AWR(val) rrpge_m_addr_wr_stk(hnd, val)
+#define RRPGE_M_AOW      1U
+#define RRPGE_M_AOCY     1U
+#include "rgm_cpuf.h"
+#undef  RRPGE_M_OPN
+#undef  RRPGE_M_ARD
+#undef  RRPGE_M_AWR
+#undef  RRPGE_M_AOW
+#undef  RRPGE_M_AOCY
+
+/* 1000: imm16 */
+#define RRPGE_M_OPN(n)   rrpge_m_op_##n##_i16
+#define RRPGE_M_ARD(rmw) (hnd->cpu.dec->imm)
+#define RRPGE_M_AWR(val) (void)(val)
+#define RRPGE_M_AOW      2U
+#define RRPGE_M_AOCY     1U
+#include "rgm_cpuf.h"
+#undef  RRPGE_M_OPN
+#undef  RRPGE_M_ARD
+#undef  RRPGE_M_AWR
+#undef  RRPGE_M_AOW
+#undef  RRPGE_M_AOCY
+
+/* 1010: Data: imm16 */
+#define RRPGE_M_OPN(n)   rrpge_m_op_##n##_di16
+#define RRPGE_M_ARD(rmw) rrpge_m_addr_get_di16(hnd, rmw)
+#define RRPGE_M_AWR(val) rrpge_m_addr_wr_data(hnd, val)
+#define RRPGE_M_AOW      2U
+#define RRPGE_M_AOCY     hnd->cpu.ocy
+#include "rgm_cpuf.h"
+#undef  RRPGE_M_OPN
+#undef  RRPGE_M_ARD
+#undef  RRPGE_M_AWR
+#undef  RRPGE_M_AOW
+#undef  RRPGE_M_AOCY
+
+/* 110-: xr */
+#define RRPGE_M_OPN(n)   rrpge_m_op_##n##_xr
+#define RRPGE_M_ARD(rmw) (hnd->cpu.xr[hnd->cpu.opc & 0x7U] & 0xFFFFU)
+#define RRPGE_M_AWR(val) (hnd->cpu.xr[hnd->cpu.opc & 0x7U] = (val))
+#define RRPGE_M_AOW      1U
+#define RRPGE_M_AOCY     0U
+#include "rgm_cpuf.h"
+#undef  RRPGE_M_OPN
+#undef  RRPGE_M_ARD
+#undef  RRPGE_M_AWR
+#undef  RRPGE_M_AOW
+#undef  RRPGE_M_AOCY
+
+/* 1110: Data: x16 */
+#define RRPGE_M_OPN(n)   rrpge_m_op_##n##_dx16
+#define RRPGE_M_ARD(rmw) rrpge_m_addr_get_dx16(hnd, rmw)
+#define RRPGE_M_AWR(val) rrpge_m_addr_set_dx16(hnd, val)
+#define RRPGE_M_AOW      1U
+#define RRPGE_M_AOCY     hnd->cpu.ocy
+#include "rgm_cpuf.h"
+#undef  RRPGE_M_OPN
+#undef  RRPGE_M_ARD
+#undef  RRPGE_M_AWR
+#undef  RRPGE_M_AOW
+#undef  RRPGE_M_AOCY
 
-/* 0000 010r rraa aaaa: XCH adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xch_04(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 1U);
- auint t1 = hnd->cpu.xr[ra];
- hnd->cpu.awf(hnd, t1);
- hnd->cpu.xr[ra] = t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
 
 /* 0000 011r rraa aaaa: MOV rx, imx */
 static const uint16 rrpge_m_op_mov_06_tb[16] = {
@@ -72,336 +140,13 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_06(rrpge_object_t* hnd)
 }
 
 
-/* 0000 100r rraa aaaa: ADD adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_add_08(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 + hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0000 101r rraa aaaa: ADD rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_add_0a(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xr[((op >> 6) & 0x7U)] += t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0000 110r rraa aaaa: SUB adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_sub_0c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 - hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0000 111r rraa aaaa: SUB rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_sub_0e(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xr[((op >> 6) & 0x7U)] -= t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0001 000r rraa aaaa: ASR adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_asr_10(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- hnd->cpu.awf(hnd, (t1 >> t0) | ((0U - (t1 >> 15U)) << (15U - t0)) );
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0001 001r rraa aaaa: ASR rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_asr_12(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
- hnd->cpu.xr[ra] = (t1 >> t0) | ((0U - (t1 >> 15U)) << (15U - t0));
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0001 010r rraa aaaa: DIV adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_div_14(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t1 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU;
- if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
-  t1 = t0 / t1;
- }
- hnd->cpu.awf(hnd, t1);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 20U;
-}
-/* 0001 011r rraa aaaa: DIV rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_div_16(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t1 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- auint t0 = hnd->cpu.xr[ra] & 0xFFFFU;
- if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
-  t1 = t0 / t1;
- }
- hnd->cpu.xr[ra] = t1;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 20U;
-}
-
-
-/* 0001 100r rraa aaaa: ADC adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_adc_18(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, (t0 + hnd->cpu.xr[((op >> 6) & 0x7U)]) +
-                   (hnd->cpu.xr[REG_C] & 1U) );
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0001 101r rraa aaaa: ADC rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_adc_1a(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- hnd->cpu.xr[ra] = (hnd->cpu.xr[ra] + t0) +
-                   (hnd->cpu.xr[REG_C] & 1U);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0001 110r rraa aaaa: SBC adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_sbc_1c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, (t0 - hnd->cpu.xr[((op >> 6) & 0x7U)]) -
-                   (hnd->cpu.xr[REG_C] & 1U) );
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0001 111r rraa aaaa: SBC rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_sbc_1e(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- hnd->cpu.xr[ra] = (hnd->cpu.xr[ra] - t0) -
-                   (hnd->cpu.xr[REG_C] & 1U);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0010 000r rraa aaaa: NOT adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_not_20(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- (void)(rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U));
- hnd->cpu.awf(hnd, hnd->cpu.xr[((op >> 6) & 0x7U)] ^ 0xFFFFU);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 2U;
-}
-/* 0010 001r rraa aaaa: NOT rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_not_22(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- hnd->cpu.xr[((op >> 6) & 0x7U)] = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U) ^ 0xFFFFU;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 2U;
-}
-
-
-/* 0010 010r rraa aaaa: MUL adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mul_24(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 * hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 12U;
-}
-/* 0010 011r rraa aaaa: MUL rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mul_26(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xr[((op >> 6) & 0x7U)] *= t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 12U;
-}
-
-
-/* 0010 100r rraa aaaa: SHR adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shr_28(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 >> (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU));
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0010 101r rraa aaaa: SHR rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shr_2a(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- hnd->cpu.xr[ra] = (hnd->cpu.xr[ra] & 0xFFFFU) >> (t0 & 0xFU);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0010 110r rraa aaaa: SHL adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shl_2c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 << (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU));
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0010 111r rraa aaaa: SHL rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shl_2e(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xr[((op >> 6) & 0x7U)] <<= t0 & 0xFU;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0011 000r rraa aaaa: OR adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_or_30(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 | hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0011 001r rraa aaaa: OR rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_or_32(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xr[((op >> 6) & 0x7U)] |= t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0011 010r rraa aaaa: MAC adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mac_34(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, (t0 * hnd->cpu.xr[((op >> 6) & 0x7U)]) +
-                   hnd->cpu.xr[REG_C]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 13U;
-}
-/* 0011 011r rraa aaaa: MAC rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mac_36(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- hnd->cpu.xr[ra] = (t0 * hnd->cpu.xr[ra]) +
-                   hnd->cpu.xr[REG_C];
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 13U;
-}
-
-
-/* 0011 100r rraa aaaa: SRC adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_src_38(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- hnd->cpu.awf(hnd, (t1 >> t0) | hnd->cpu.xr[REG_C] );
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0011 101r rraa aaaa: SRC rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_src_3a(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
- hnd->cpu.xr[ra] = (t1 >> t0) | hnd->cpu.xr[REG_C];
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0011 110r rraa aaaa: SLC adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_slc_3c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- hnd->cpu.awf(hnd, (t1 << t0) | hnd->cpu.xr[REG_C] );
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0011 111r rraa aaaa: SLC rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_slc_3e(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra];
- hnd->cpu.xr[ra] = (t1 << t0) | hnd->cpu.xr[REG_C];
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0100 000p rraa aaaa: MOV adr, xmn/xbn (Pointer mode moves) */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mov_40(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- (void)(rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U));
- hnd->cpu.awf(hnd, ( hnd->cpu.xmb[(op >> 8) & 0x1U] >>
-                     ((op >> 4) & 0xCU) ) & 0xFU);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 2U;
-}
-/* 0100 001p rraa aaaa: MOV xmn/xbn, adr (Pointer mode moves) */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mov_42(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = (op >> 8) & 0x1U;
- auint t1 = (op >> 4) & 0xCU;
- auint t2 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xmb[t0] = (hnd->cpu.xmb[t0] & (~(0xFU << t1))) |
-                    ((t2 & 0xFU) << t1);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 2U;
-}
-
-
 /* Decodes a single function parameter */
 RRPGE_M_FASTCALL static auint rrpge_m_op_fpr(rrpge_object_t* hnd, auint* cy)
 {
  auint  op = hnd->cpu.opc;
  auint  r;
  if ((op & 0x3C00U) == 0x0000U){ /* Normal address parameter */
-  r = (rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U)) & 0xFFFFU;
+  r = (hnd->cpu.dec->arf(hnd, 0U)) & 0xFFFFU;
   *cy         += hnd->cpu.ocy + 2U;
   hnd->cpu.pc += hnd->cpu.oaw;
  }else{
@@ -434,7 +179,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_jfr_44(rrpge_object_t* hnd)
  uint16 kp[16]; /* Supervisor call parameters */
 
  if ((op & 0x0080U) == 0U){               /* JFR or JFA: Function entry */
-  t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
+  t0 = hnd->cpu.dec->arf(hnd, 0U);
   cy = hnd->cpu.ocy;
   if ((op & 0x0100U) == 0U){              /* JFR: Relative */
    t0 += hnd->cpu.pc;
@@ -446,7 +191,8 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_jfr_44(rrpge_object_t* hnd)
   mx = 16U;                               /* Parameter limit */
   do{
    if ((op & 0x0040U) != 0U){ break; }    /* There are no more parameters */
-   op           = hnd->crom[hnd->cpu.pc & 0xFFFFU];
+   hnd->cpu.dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+   op           = hnd->cpu.dec->opc;
    hnd->cpu.opc = op;
    rrpge_m_stk_push(hnd, rrpge_m_op_fpr(hnd, &cy));
    mx --;
@@ -465,12 +211,13 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_jfr_44(rrpge_object_t* hnd)
   mx = 1;                                 /* Parameter count (service to call included) */
   do{
    if ((op & 0x0040U) != 0U){ break; }    /* There are no more parameters */
-   op           = hnd->crom[hnd->cpu.pc & 0xFFFFU];
+   hnd->cpu.dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+   op           = hnd->cpu.dec->opc;
    hnd->cpu.opc = op;
    kp[mx] = rrpge_m_op_fpr(hnd, &cy);
    mx ++;
   }while(mx < 16U);
-  cy = rrpge_m_kcall(&kp[0], mx, &hnd->cpu.xr[2], &hnd->cpu.xr[7]); /* Process supervisor (kernel) call */
+  cy = rrpge_m_kcall(hnd, &kp[0], mx, &hnd->cpu.xr[2], &hnd->cpu.xr[7]); /* Process supervisor (kernel) call */
   /* Note: other cycles discarded as the kernel call timing is absolute
   ** (includes JSV overhead) */
 
@@ -483,7 +230,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_jfr_44(rrpge_object_t* hnd)
 
   }else{ /* Ordinary return */
 
-   hnd->cpu.xr[0x7U] = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U); /* Load X3 */
+   hnd->cpu.xr[0x7U] = hnd->cpu.dec->arf(hnd, 0U); /* Load X3 */
    cy = hnd->cpu.ocy + 6U;
    if ((op & 0x0040U) != 0U){
     hnd->cpu.xr[REG_C] = 0U;              /* Also clear carry */
@@ -511,359 +258,6 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_46(rrpge_object_t* hnd)
 }
 
 
-/* 0100 100r rraa aaaa: ADD C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_addc_48(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- t0 = t0 + (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU);
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0100 101r rraa aaaa: ADD C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_addc_4a(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- t0 = (hnd->cpu.xr[ra] & 0xFFFFU) + t0;
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0100 110r rraa aaaa: SUB C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_subc_4c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- t0 = t0 - (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU);
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0100 111r rraa aaaa: SUB C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_subc_4e(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- t0 = (hnd->cpu.xr[ra] & 0xFFFFU) - t0;
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0101 000r rraa aaaa: ASR C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_asrc_50(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- t0 = (t1 << (16U - t0)) | ((0U - (t1 >> 15U)) << (31U - t0));
- hnd->cpu.awf(hnd, t0 >> 16);
- hnd->cpu.xr[REG_C] = t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0101 001r rraa aaaa: ASR C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_asrc_52(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
- t0 = (t1 << (16U - t0)) | ((0U - (t1 >> 15U)) << (31U - t0));
- hnd->cpu.xr[ra]    = t0 >> 16;
- hnd->cpu.xr[REG_C] = t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0101 010r rraa aaaa: DIV C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_divc_54(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t1 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU;
- auint t2 = 0U;
- if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
-  t2 = t0 % t1;
-  t1 = t0 / t1;
- }
- hnd->cpu.awf(hnd, t1);
- hnd->cpu.xr[REG_C] = t2;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 21U;
-}
-/* 0101 011r rraa aaaa: DIV C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_divc_56(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t1 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- auint t0 = hnd->cpu.xr[ra] & 0xFFFFU;
- auint t2 = 0U;
- if (t1 != 0U){ /* (If the divider is 0, then 0 has to be written out) */
-  t2 = t0 % t1;
-  t1 = t0 / t1;
- }
- hnd->cpu.xr[ra]    = t1;
- hnd->cpu.xr[REG_C] = t2;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 21U;
-}
-
-
-/* 0101 100r rraa aaaa: ADC C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_adcc_58(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- t0 = (t0 + (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)) +
-      (hnd->cpu.xr[REG_C] & 1U);
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0101 101r rraa aaaa: ADC C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_adcc_5a(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- t0 = ((hnd->cpu.xr[ra] & 0xFFFFU) + t0) +
-      (hnd->cpu.xr[REG_C] & 1U);
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0101 110r rraa aaaa: SBC C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_sbcc_5c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- t0 = (t0 - (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)) -
-      (hnd->cpu.xr[REG_C] & 1U);
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0101 111r rraa aaaa: SBC C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_sbcc_5e(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- t0 = ((hnd->cpu.xr[ra] & 0xFFFFU) - t0) -
-      (hnd->cpu.xr[REG_C] & 1U);
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0110 000r rraa aaaa: NEG adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_neg_60(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- (void)(rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U));
- hnd->cpu.awf(hnd, 0U - hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0110 001r rraa aaaa: NEG rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_neg_62(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- hnd->cpu.xr[((op >> 6) & 0x7U)] = 0U - rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0110 010r rraa aaaa: MUL C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mulc_64(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- t0 = t0 * (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU);
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 13U;
-}
-/* 0110 011r rraa aaaa: MUL C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_mulc_66(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- t0 = (hnd->cpu.xr[ra] & 0xFFFFU) * t0;
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 13U;
-}
-
-
-/* 0110 100r rraa aaaa: SHR C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shrc_68(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- t0 = t1 << (16U - t0);
- hnd->cpu.awf(hnd, t0 >> 16);
- hnd->cpu.xr[REG_C] = t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0110 101r rraa aaaa: SHR C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shrc_6a(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
- t0 = t1 << (16U - t0);
- hnd->cpu.xr[ra]    = t0 >> 16;
- hnd->cpu.xr[REG_C] = t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0110 110r rraa aaaa: SHL C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shlc_6c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- t0 = t1 << t0;
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0110 111r rraa aaaa: SHL C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_shlc_6e(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
- t0 = t1 << t0;
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0111 000r rraa aaaa: XOR adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xor_70(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 ^ hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 0111 001r rraa aaaa: XOR rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xor_72(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xr[((op >> 6) & 0x7U)] ^= t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-
-
-/* 0111 010r rraa aaaa: MAC C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_macc_74(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- t0 = (t0 * (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)) +
-      (hnd->cpu.xr[REG_C] & 0xFFFFU);
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 14U;
-}
-/* 0111 011r rraa aaaa: MAC C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_macc_76(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U);
- t0 = ((hnd->cpu.xr[ra] & 0xFFFFU) * t0) +
-      (hnd->cpu.xr[REG_C] & 0xFFFFU);
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 14U;
-}
-
-
-/* 0111 100r rraa aaaa: SRC C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_srcc_78(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- t0 = (t1 << (16U - t0)) | (hnd->cpu.xr[REG_C] << 16);
- hnd->cpu.awf(hnd, t0 >> 16);
- hnd->cpu.xr[REG_C] = t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0111 101r rraa aaaa: SRC C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_srcc_7a(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
- t0 = (t1 << (16U - t0)) | (hnd->cpu.xr[REG_C] << 16);
- hnd->cpu.xr[ra]    = t0 >> 16;
- hnd->cpu.xr[REG_C] = t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
-/* 0111 110r rraa aaaa: SLC C:adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_slcc_7c(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t1 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- auint t0 = hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFU;
- t0 = (t1 << t0) | (hnd->cpu.xr[REG_C] & 0xFFFFU);
- hnd->cpu.awf(hnd, t0);
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-/* 0011 111r rraa aaaa: SLC C:rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_slcc_7e(rrpge_object_t* hnd)
-{
- auint ra = ((hnd->cpu.opc >> 6) & 0x7U);
- auint t0 = rrpge_m_addr_read_table[hnd->cpu.opc & 0x3FU](hnd, 0U) & 0xFU;
- auint t1 = hnd->cpu.xr[ra] & 0xFFFFU;
- t0 = (t1 << t0) | (hnd->cpu.xr[REG_C] & 0xFFFFU);
- hnd->cpu.xr[ra]    = t0;
- hnd->cpu.xr[REG_C] = t0 >> 16;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 4U;
-}
-
-
 /* 1000 000r rraa aaaa: MOV adr, special (SP, XM or XB) & SP ops */
 RRPGE_M_FASTCALL static auint rrpge_m_op_mov_80(rrpge_object_t* hnd)
 {
@@ -871,7 +265,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_80(rrpge_object_t* hnd)
  auint t0;
  if ((op & 0x0100U) == 0U){
   if ((op & 0x00C0U) != 0x00C0U){ /* Register move */
-   t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
+   t0 = hnd->cpu.dec->arf(hnd, 1U);
    hnd->cpu.pc += hnd->cpu.oaw;
    if ((op & 0x0080U) != 0U){     /* SP */
     hnd->cpu.awf(hnd, hnd->cpu.sp);
@@ -880,7 +274,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_80(rrpge_object_t* hnd)
    }
    return hnd->cpu.ocy + 2U;
   }else{                          /* XUG adr, SP */
-   t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
+   t0 = hnd->cpu.dec->arf(hnd, 0U);
    hnd->cpu.pc += hnd->cpu.oaw;
    if (t0 >  (hnd->cpu.sp & 0xFFFFU)){
     hnd->cpu.pc++;
@@ -890,7 +284,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_80(rrpge_object_t* hnd)
   }
  }else{
   if ((op & 0x00C0U) == 0x0040U){ /* XEQ adr, SP */
-   t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
+   t0 = hnd->cpu.dec->arf(hnd, 0U);
    hnd->cpu.pc += hnd->cpu.oaw;
    if (t0 == (hnd->cpu.sp & 0xFFFFU)){
     hnd->cpu.pc++;
@@ -921,7 +315,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_82(rrpge_object_t* hnd)
  auint op = hnd->cpu.opc;
  auint t0;
  if ((op & 0x0100U) == 0U){
-  t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
+  t0 = hnd->cpu.dec->arf(hnd, 0U);
   hnd->cpu.pc += hnd->cpu.oaw;
   if ((op & 0x00C0U) != 0x00C0U){ /* Register move */
    if ((op & 0x0080U) != 0U){     /* SP */
@@ -939,7 +333,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_82(rrpge_object_t* hnd)
   }
  }else{
   if ((op & 0x00C0U) == 0x0040U){ /* XNE SP, adr */
-   t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
+   t0 = hnd->cpu.dec->arf(hnd, 0U);
    hnd->cpu.pc += hnd->cpu.oaw;
    if (t0 != (hnd->cpu.sp & 0xFFFFU)){
     hnd->cpu.pc++;
@@ -971,7 +365,7 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_mov_82(rrpge_object_t* hnd)
 RRPGE_M_FASTCALL static auint rrpge_m_op_jmp_84(rrpge_object_t* hnd)
 {
  auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
+ auint t0 = hnd->cpu.dec->arf(hnd, 0U);
  if ((op & 0x00C0U) != 0U){ /* B, C or D should receive PC after jump */
   hnd->cpu.xr[(op >> 6) & 0x3U] = hnd->cpu.pc + hnd->cpu.oaw;
  }
@@ -1034,163 +428,147 @@ RRPGE_M_FASTCALL static auint rrpge_m_op_sv(rrpge_object_t* hnd)
 }
 
 
-/* 1010 00ii iiaa aaaa: BTC adr, imm4 */
-RRPGE_M_FASTCALL static auint rrpge_m_op_btc_a0(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 & (~((auint)(1U) << ((op >> 6) & 0xFU))));
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 1010 10ii iiaa aaaa: BTS adr, imm4 */
-RRPGE_M_FASTCALL static auint rrpge_m_op_bts_a8(rrpge_object_t* hnd)
+/* 11-- ---- ---- ----: NOP */
+RRPGE_M_FASTCALL static auint rrpge_m_op_nop(rrpge_object_t* hnd)
 {
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 | ( ((auint)(1U) << ((op >> 6) & 0xFU))));
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
+ hnd->cpu.pc++;
+ return 1U;
 }
 
 
-/* 1010 01ii iiaa aaaa: XBC adr, imm4 */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xbc_a4(rrpge_object_t* hnd)
+/* Breakpoint trap: substituted for the handler of instructions having a
+** breakpoint set on them (see rrpge_m_cpu_decode_at()). If breakpoints are
+** armed, it halts before the instruction, otherwise runs it normally. */
+RRPGE_M_FASTCALL static auint rrpge_m_op_brk(rrpge_object_t* hnd)
 {
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if ( (t0 & ((auint)(1U) << ((op >> 6) & 0xFU))) == 0U){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
+ if (hnd->cpu.brk != 0U){
+  rrpge_m_halt_set(hnd, RRPGE_HLT_BREAK);
+  return 0U;
  }
- return hnd->cpu.ocy + 3U;
-}
-/* 1010 11ii iiaa aaaa: XBS adr, imm4 */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xbs_ac(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if ( (t0 & ((auint)(1U) << ((op >> 6) & 0xFU))) != 0U){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
- }
- return hnd->cpu.ocy + 3U;
+ return rrpge_m_op_htable[rrpge_m_op_index(hnd->cpu.opc)](hnd);
 }
 
 
-/* 1000 100r rraa aaaa: AND adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_and_b0(rrpge_object_t* hnd)
+/* Idle loop and native routine trap: substituted for the handler of possible
+** idle loop heads and native User Library routine entry points. These are
+** processed by the free run loops (see rrpge_m_cpu_idle() and
+** rrpge_m_cpuh_run()), the handler itself just runs the instruction. */
+RRPGE_M_FASTCALL static auint rrpge_m_op_trp(rrpge_object_t* hnd)
 {
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 1U);
- hnd->cpu.awf(hnd, t0 & hnd->cpu.xr[((op >> 6) & 0x7U)]);
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
-}
-/* 1000 101r rraa aaaa: AND rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_and_b2(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.xr[((op >> 6) & 0x7U)] &= t0;
- hnd->cpu.pc += hnd->cpu.oaw;
- return hnd->cpu.ocy + 3U;
+ return rrpge_m_op_htable[rrpge_m_op_index(hnd->cpu.opc)](hnd);
 }
 
 
-/* 1011 010r rraa aaaa: XSG adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xsg_b4(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if ( ((t0 + 0x8000U) & 0xFFFFU) >
-      ((hnd->cpu.xr[((op >> 6) & 0x7U)] + 0x8000U) & 0xFFFFU) ){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
- }
- return hnd->cpu.ocy + 3U;
-}
-/* 1011 011r rraa aaaa: XSG rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xsg_b6(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if ( ((t0 + 0x8000U) & 0xFFFFU) <
-      ((hnd->cpu.xr[((op >> 6) & 0x7U)] + 0x8000U) & 0xFFFFU) ){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
- }
- return hnd->cpu.ocy + 3U;
-}
+
+/* Opcode base cycles by opcode bits 9-15, for rrpge_m_op_info(). Zero marks
+** opcodes which need further decoding. */
+static const uint8 rrpge_m_op_info_cy[128] = {
+  2U,  2U,  3U,  2U,  3U,  3U,  3U,  3U,  3U,  3U, 20U, 20U,  3U,  3U,  3U,  3U,
+  2U,  2U, 12U, 12U,  3U,  3U,  3U,  3U,  3U,  3U, 13U, 13U,  3U,  3U,  3U,  3U,
+  2U,  2U,  0U,  2U,  4U,  4U,  4U,  4U,  4U,  4U, 21U, 21U,  4U,  4U,  4U,  4U,
+  3U,  3U, 13U, 13U,  4U,  4U,  4U,  4U,  3U,  3U, 14U, 14U,  4U,  4U,  4U,  4U,
+  0U,  0U,  0U,  2U,  0U,  0U,  0U,  0U,  0U,  0U,  0U,  0U,  0U,  0U,  0U,  0U,
+  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,  3U,
+  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,
+  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U,  1U};
+
 
 
-/* 1011 100r rraa aaaa: XEQ adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xeq_b8(rrpge_object_t* hnd)
+/* Returns static properties of the instruction beginning with the given
+** opcode word, with "imm" being its pre-decoded 16 bit immediate. The return
+** is a combination of RRPGE_M_OPI flags and the worst case cycle count of
+** the instruction (this latter is only provided if neither of the JMP or the
+** HLT flags are set). Without the SFX flag the instruction only alters the
+** CPU registers (or raises a halt cause). */
+auint rrpge_m_op_info(auint op, auint imm)
 {
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if (t0 == (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
+ auint g = (op >> 9) & 0x7FU;   /* Opcode group */
+ auint r = rrpge_m_op_info_cy[g];
+ auint m = op & 0x3FU;          /* Addressing mode */
+
+ /* Opcodes not using the addressing unit */
+
+ if ( (g == 0x03U) || (g == 0x23U) || (g == 0x43U) || (g >= 0x60U) ){
+  return r;                     /* MOV rx, imx & NOP */
  }
- return hnd->cpu.ocy + 3U;
-}
-/* 1011 101r rraa aaaa: XNE rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xne_ba(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if (t0 != (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
+ if ( (g >= 0x44U) && (g <= 0x47U) ){
+  return RRPGE_M_OPI_JMP;       /* JNZ & JMS */
+ }
+ if ( (g >= 0x48U) && (g <= 0x4FU) ){
+  return RRPGE_M_OPI_HLT;       /* Supervisor mode ops */
+ }
+ if (g == 0x22U){
+  return RRPGE_M_OPI_JMP | RRPGE_M_OPI_HLT | RRPGE_M_OPI_SFX; /* Function entry, return & Supervisor call */
+ }
+ if (g == 0x40U){               /* MOV adr, special & SP ops */
+  if ((op & 0x0100U) == 0U){
+   if ((op & 0x00C0U) == 0x00C0U){ r = 3U | RRPGE_M_OPI_JMP; } /* XUG adr, SP */
+   else                          { r = 2U; }
+  }else{
+   if      ((op & 0x00C0U) == 0x0040U){ r = 3U | RRPGE_M_OPI_JMP; } /* XEQ adr, SP */
+   else if ((op & 0x0087U) == 0x0080U){ return 2U | RRPGE_M_OPI_SFX; } /* NOP */
+   else                               { return RRPGE_M_OPI_HLT | RRPGE_M_OPI_SFX; } /* PSH */
+  }
+  r |= RRPGE_M_OPI_SFX;
+ }
+ if (g == 0x41U){               /* MOV special, adr & SP ops */
+  if ((op & 0x0100U) == 0U){
+   if ((op & 0x00C0U) == 0x00C0U){ r = 3U | RRPGE_M_OPI_JMP; } /* XUG SP, adr */
+   else                          { r = 2U; }
+  }else{
+   if      ((op & 0x00C0U) == 0x0040U){ r = 3U | RRPGE_M_OPI_JMP; } /* XNE SP, adr */
+   else if ((op & 0x0087U) == 0x0080U){ return 2U | RRPGE_M_OPI_SFX; } /* MOV SP, imx */
+   else                               { return RRPGE_M_OPI_HLT | RRPGE_M_OPI_SFX; } /* POP */
+  }
+  r |= RRPGE_M_OPI_SFX;
+ }
+ if (g == 0x42U){ r = 4U | RRPGE_M_OPI_JMP; } /* JMR & JMA */
+ if ( ((g & 0x7AU) == 0x52U) || (g >= 0x5AU) ){
+  r |= RRPGE_M_OPI_JMP;         /* XBC, XBS & XSG, XEQ, XNE, XUG */
  }
- return hnd->cpu.ocy + 3U;
-}
 
+ /* Opcodes writing their operand have side effects unless it is an
+ ** immediate or a register (BTC, BTS, AND & the "op adr, rx" forms) */
 
-/* 1011 110r rraa aaaa: XUG adr, rx */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xug_bc(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if (t0 > (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
- }
- return hnd->cpu.ocy + 3U;
-}
-/* 1011 111r rraa aaaa: XUG rx, adr */
-RRPGE_M_FASTCALL static auint rrpge_m_op_xug_be(rrpge_object_t* hnd)
-{
- auint op = hnd->cpu.opc;
- auint t0 = rrpge_m_addr_read_table[op & 0x3FU](hnd, 0U);
- hnd->cpu.pc += hnd->cpu.oaw;
- if (t0 < (hnd->cpu.xr[((op >> 6) & 0x7U)] & 0xFFFFU)){
-  hnd->cpu.pc++;
-  hnd->cpu.ocy++;
+ if ( ((g < 0x40U) && ((g & 1U) == 0U)) ||
+      ((g & 0x7AU) == 0x50U) || (g == 0x58U) ){
+  if ( (m >= 0x10U) && ((m & 0x38U) != 0x20U) && ((m & 0x38U) != 0x30U) ){
+   r |= RRPGE_M_OPI_SFX;
+  }
  }
- return hnd->cpu.ocy + 3U;
-}
 
+ /* Add addressing mode specific properties */
+
+ if       (m < 0x10U){          /* 00--: imm4 */
+ }else if (m < 0x20U){          /* 01--: Stack: BP + imm4 */
+  r |= RRPGE_M_OPI_HLT;
+ }else if (m < 0x28U){          /* 1000, 1001: imm16 & BP + imm16 */
+  r += 1U;
+  r |= RRPGE_M_OPI_W2;
+ }else if (m < 0x2CU){          /* 1010: Data: imm16 */
+  r += 2U;
+  if ( (imm < 0x40U) && ((imm & 0x26U) == 0x26U) ){ /* PRAM access stall */
+   r += 1U;
+   r |= RRPGE_M_OPI_SFX;        /* PRAM interface accesses have effects */
+  }
+  r |= RRPGE_M_OPI_W2;
+ }else if (m < 0x30U){          /* 1011: Stack: BP + imm16 */
+  r |= RRPGE_M_OPI_HLT | RRPGE_M_OPI_W2;
+ }else if (m < 0x38U){          /* 110-: xr */
+ }else if (m < 0x3CU){          /* 1110: Data: x16 (may hit the PRAM interface) */
+  r += 2U;
+  r |= RRPGE_M_OPI_SFX;
+ }else{                         /* 1111: Stack: x16 */
+  r |= RRPGE_M_OPI_HLT;
+ }
 
-/* 11-- ---- ---- ----: NOP */
-RRPGE_M_FASTCALL static auint rrpge_m_op_nop(rrpge_object_t* hnd)
-{
- hnd->cpu.pc++;
- return 1U;
+ return r;
 }
 
 
 
-/* CPU opcode call table. The rrpge_m_info structure must be set up
-** appropriately to call these (note the opcode cache member). As above, the
+/* CPU opcode call table. The CPU state in the emulation instance must be set
+** up appropriately to call these (note the opcode cache member). As above, the
 ** effect of the opcode's execution varies depending on what the user program
 ** attempted to perform. Callbacks may also happen (here through calling the
 ** supervisor). */
@@ -1228,3 +606,183 @@ rrpge_m_opf_t* const rrpge_m_optable[128] = {
  &rrpge_m_op_nop,     &rrpge_m_op_nop,     &rrpge_m_op_nop,     &rrpge_m_op_nop,
  &rrpge_m_op_nop,     &rrpge_m_op_nop,     &rrpge_m_op_nop,     &rrpge_m_op_nop
 };
+
+
+
+/* Opcode groups by opcode bits 9-15 for the opcodes using the addressing
+** unit (0x0000 - 0xBFFF), for generating handler tables. "S" lists groups
+** having specialized handlers, "G" groups having only the generic handler.
+** The second parameter is the group in hexadecimal. */
+#define RRPGE_M_OPGRP(S, G) \
+ S(mov_00,  00) S(mov_02,  01) S(xch_04,  02) G(mov_06,  03) \
+ S(add_08,  04) S(add_0a,  05) S(sub_0c,  06) S(sub_0e,  07) \
+ S(asr_10,  08) S(asr_12,  09) S(div_14,  0a) S(div_16,  0b) \
+ S(adc_18,  0c) S(adc_1a,  0d) S(sbc_1c,  0e) S(sbc_1e,  0f) \
+ S(not_20,  10) S(not_22,  11) S(mul_24,  12) S(mul_26,  13) \
+ S(shr_28,  14) S(shr_2a,  15) S(shl_2c,  16) S(shl_2e,  17) \
+ S(or_30,   18) S(or_32,   19) S(mac_34,  1a) S(mac_36,  1b) \
+ S(src_38,  1c) S(src_3a,  1d) S(slc_3c,  1e) S(slc_3e,  1f) \
+ S(mov_40,  20) S(mov_42,  21) G(jfr_44,  22) G(mov_46,  23) \
+ S(addc_48, 24) S(addc_4a, 25) S(subc_4c, 26) S(subc_4e, 27) \
+ S(asrc_50, 28) S(asrc_52, 29) S(divc_54, 2a) S(divc_56, 2b) \
+ S(adcc_58, 2c) S(adcc_5a, 2d) S(sbcc_5c, 2e) S(sbcc_5e, 2f) \
+ S(neg_60,  30) S(neg_62,  31) S(mulc_64, 32) S(mulc_66, 33) \
+ S(shrc_68, 34) S(shrc_6a, 35) S(shlc_6c, 36) S(shlc_6e, 37) \
+ S(xor_70,  38) S(xor_72,  39) S(macc_74, 3a) S(macc_76, 3b) \
+ S(srcc_78, 3c) S(srcc_7a, 3d) S(slcc_7c, 3e) S(slcc_7e, 3f) \
+ G(mov_80,  40) G(mov_82,  41) G(jmp_84,  42) G(mov_86,  43) \
+ G(jnz_88,  44) G(jnz_88,  45) G(jms_8c,  46) G(jms_8c,  47) \
+ G(sv,      48) G(sv,      49) G(sv,      4a) G(sv,      4b) \
+ G(sv,      4c) G(sv,      4d) G(sv,      4e) G(sv,      4f) \
+ S(btc_a0,  50) S(btc_a0,  51) S(xbc_a4,  52) S(xbc_a4,  53) \
+ S(bts_a8,  54) S(bts_a8,  55) S(xbs_ac,  56) S(xbs_ac,  57) \
+ S(and_b0,  58) S(and_b2,  59) S(xsg_b4,  5a) S(xsg_b6,  5b) \
+ S(xeq_b8,  5c) S(xne_ba,  5d) S(xug_bc,  5e) S(xug_be,  5f)
+
+/* Addressing mode classes by opcode bits 2-5. Zero is the generic class
+** (addressing modes having no specialized handlers), the rest are in the
+** order of the handler sets. */
+static const uint8 rrpge_m_op_hcls[16] = {
+ 1U, 1U, 1U, 1U, 2U, 2U, 2U, 2U, 3U, 0U, 4U, 0U, 5U, 5U, 6U, 0U};
+
+
+
+/* Opcode handler table by opcode handler index (see rrpge_m_op_index()). */
+#define RRPGE_M_OPH_S(n, g) \
+ &rrpge_m_op_##n,        &rrpge_m_op_##n##_i4,  &rrpge_m_op_##n##_si4, \
+ &rrpge_m_op_##n##_i16,  &rrpge_m_op_##n##_di16, &rrpge_m_op_##n##_xr, \
+ &rrpge_m_op_##n##_dx16,
+#define RRPGE_M_OPH_G(n, g) \
+ &rrpge_m_op_##n,        &rrpge_m_op_##n,       &rrpge_m_op_##n, \
+ &rrpge_m_op_##n,        &rrpge_m_op_##n,       &rrpge_m_op_##n, \
+ &rrpge_m_op_##n,
+rrpge_m_opf_t* const rrpge_m_op_htable[RRPGE_M_OPH_CNT] = {
+ RRPGE_M_OPGRP(RRPGE_M_OPH_S, RRPGE_M_OPH_G)
+ &rrpge_m_op_nop,
+ &rrpge_m_op_brk,
+ &rrpge_m_op_trp,
+ &rrpge_m_op_trp
+};
+
+
+
+/* Returns the opcode handler index for the given opcode word. This selects
+** a handler specialized for the opcode's addressing mode where one exists,
+** otherwise the generic handler (the one in rrpge_m_optable). */
+auint rrpge_m_op_index(auint op)
+{
+ auint g = (op >> 9) & 0x7FU;
+ if (g >= 0x60U){ return RRPGE_M_OPH_NOP; }
+ return (g * 7U) + rrpge_m_op_hcls[(op >> 2) & 0xFU];
+}
+
+
+
+#ifdef RRPGE_M_THREADED
+
+/* Labels of the threaded dispatch by opcode handler index */
+#define RRPGE_M_OPL_S(n, g) \
+ &&lb_##g,      &&lb_##g##_i4,   &&lb_##g##_si4, &&lb_##g##_i16, \
+ &&lb_##g##_di16, &&lb_##g##_xr, &&lb_##g##_dx16,
+#define RRPGE_M_OPL_G(n, g) \
+ &&lb_##g, &&lb_##g, &&lb_##g, &&lb_##g, &&lb_##g, &&lb_##g, &&lb_##g,
+
+/* Dispatches the opcode in dec by the given handler index */
+#define RRPGE_M_OPT_GO(i) \
+ hnd->cpu.dec = dec; \
+ hnd->cpu.opc = dec->opc; \
+ __extension__ ({ goto *lbl[i]; })
+
+/* Starts an execution block with the opcode in dec. If the cycle limit does
+** not permit the whole block, only its first instruction runs. */
+#define RRPGE_M_OPT_BLK \
+ n = 1U; \
+ if ((cy + dec->bcy) <= cymax){ n = dec->bln; } \
+ RRPGE_M_OPT_GO(dec->opi)
+
+/* Opcode body of the threaded dispatch: runs the handler, then proceeds
+** within the execution block, or ends it, checking for halts and the cycle
+** limit, and starts the next one. The "h" parameter tells whether the
+** handler may raise a halt cause: for most specialized handlers it is known
+** to be zero, so the check is eliminated for them. */
+#define RRPGE_M_OPT_OP(l, f, h) \
+ l: \
+ cy += f(hnd); \
+ n--; \
+ if (n == 0U){ \
+  if ( ((h) && rrpge_m_halt_isany(hnd)) || (cy > cymax) ){ goto end; } \
+  dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]); \
+  RRPGE_M_OPT_BLK; \
+ } \
+ dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]); \
+ RRPGE_M_OPT_GO(dec->opi);
+#define RRPGE_M_OPT_S(n, g) \
+ RRPGE_M_OPT_OP(lb_##g,        rrpge_m_op_##n,         dec->hlt) \
+ RRPGE_M_OPT_OP(lb_##g##_i4,   rrpge_m_op_##n##_i4,    0U) \
+ RRPGE_M_OPT_OP(lb_##g##_si4,  rrpge_m_op_##n##_si4,   1U) \
+ RRPGE_M_OPT_OP(lb_##g##_i16,  rrpge_m_op_##n##_i16,   0U) \
+ RRPGE_M_OPT_OP(lb_##g##_di16, rrpge_m_op_##n##_di16,  0U) \
+ RRPGE_M_OPT_OP(lb_##g##_xr,   rrpge_m_op_##n##_xr,    0U) \
+ RRPGE_M_OPT_OP(lb_##g##_dx16, rrpge_m_op_##n##_dx16,  0U)
+#define RRPGE_M_OPT_G(n, g) \
+ RRPGE_M_OPT_OP(lb_##g,        rrpge_m_op_##n,         dec->hlt)
+
+
+
+/* Runs the CPU in free run mode for up to a given amount of cycles, the
+** threaded equivalent of the normal mode loop in rrpge_m_cpu_run(). Every
+** opcode handler has its own dispatch, so they are called directly, and the
+** host's branch prediction may learn the successors of each. Returns the
+** number of cycles emulated. */
+auint rrpge_m_op_run(rrpge_object_t* hnd, auint cymax)
+{
+ __extension__ static void* const lbl[RRPGE_M_OPH_CNT] = {
+  RRPGE_M_OPGRP(RRPGE_M_OPL_S, RRPGE_M_OPL_G)
+  &&lb_nop,
+  &&lb_brk,
+  &&lb_idl,
+  &&lb_hle
+ };
+ auint cy = 0U; /* Count of emulated cycles */
+ auint n;       /* Count of instructions remaining in the execution block */
+ auint t;
+ rrpge_m_cpu_dec_t const* dec;
+
+ dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+ RRPGE_M_OPT_BLK;
+
+ RRPGE_M_OPGRP(RRPGE_M_OPT_S, RRPGE_M_OPT_G)
+ RRPGE_M_OPT_OP(lb_nop, rrpge_m_op_nop, 0U)
+ RRPGE_M_OPT_OP(lb_brk, rrpge_m_op_brk, 1U)
+
+ /* Idle loop head: it is probed once in a run, otherwise it just runs. The
+ ** trap is only dispatched at the start of blocks. */
+
+lb_idl:
+ if (hnd->cpu.ilp == 0U){
+  hnd->cpu.ilp = 1U;
+  cy = rrpge_m_cpu_idle(hnd, cy, cymax);
+  if ( (rrpge_m_halt_isany(hnd)) || (cy > cymax) ){ goto end; }
+  dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+  RRPGE_M_OPT_BLK;
+ }
+ RRPGE_M_OPT_GO(rrpge_m_op_index(dec->opc));
+
+ /* Native User Library routine entry: if the routine can run natively, it
+ ** continues at its return, otherwise it is emulated. The trap is only
+ ** dispatched at the start of blocks. */
+
+lb_hle:
+ t = rrpge_m_cpuh_run(hnd, cymax - cy);
+ if (t != 0U){
+  cy += t;
+  dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+  RRPGE_M_OPT_BLK;
+ }
+ RRPGE_M_OPT_GO(rrpge_m_op_index(dec->opc));
+
+end:
+ return cy;
+}
+
+#endif
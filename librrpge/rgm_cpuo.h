@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.02
+**  \date      2015.10.12
 */
 
 
@@ -17,17 +17,60 @@
 #include "rgm_info.h"
 
 
-/* Function type definition for opcode services. Returns number of cycles
-** consumed, they may alter the state at will. */
-typedef RRPGE_M_FASTCALL auint (rrpge_m_opf_t)(rrpge_object_t* hnd);
+/* Opcode properties returned by rrpge_m_op_info() */
+#define RRPGE_M_OPI_CYC 0x00FFU /* Worst case cycle count */
+#define RRPGE_M_OPI_JMP 0x0100U /* May alter the flow of execution (jumps, skips, calls) */
+#define RRPGE_M_OPI_HLT 0x0200U /* May raise a halt cause */
+#define RRPGE_M_OPI_W2  0x0400U /* Two word instruction */
+#define RRPGE_M_OPI_SFX 0x0800U /* May have effects beyond the CPU registers */
 
 
-/* CPU opcode call table. The rrpge_m_info structure must be set up
-** appropriately to call these (note the opcode cache member). As above, the
+/* CPU opcode call table. The CPU state in the emulation instance must be set
+** up appropriately to call these (note the opcode cache member). As above, the
 ** effect of the opcode's execution varies depending on what the user program
 ** attempted to perform. Callbacks may also happen (here through calling the
 ** supervisor). */
 extern rrpge_m_opf_t* const rrpge_m_optable[128];
 
 
+/* Opcode handler indices of the NOP, the breakpoint, idle loop and native
+** routine traps, and the count of opcode handlers: the opcodes using the
+** addressing unit have a generic and six specialized handlers each, then the
+** NOP and the traps follow. */
+#define RRPGE_M_OPH_NOP (0x60U * 7U)
+#define RRPGE_M_OPH_BRK (RRPGE_M_OPH_NOP + 1U)
+#define RRPGE_M_OPH_IDL (RRPGE_M_OPH_BRK + 1U)
+#define RRPGE_M_OPH_HLE (RRPGE_M_OPH_IDL + 1U)
+#define RRPGE_M_OPH_CNT (RRPGE_M_OPH_HLE + 1U)
+
+
+/* Opcode handler table by opcode handler index (see rrpge_m_op_index()). */
+extern rrpge_m_opf_t* const rrpge_m_op_htable[RRPGE_M_OPH_CNT];
+
+
+/* Returns the opcode handler index for the given opcode word. This selects
+** a handler specialized for the opcode's addressing mode where one exists,
+** otherwise the generic handler (the one in rrpge_m_optable). */
+auint rrpge_m_op_index(auint op);
+
+
+#ifdef RRPGE_M_THREADED
+/* Runs the CPU in free run mode for up to a given amount of cycles, the
+** threaded equivalent of the normal mode loop in rrpge_m_cpu_run(). Every
+** opcode handler has its own dispatch, so they are called directly, and the
+** host's branch prediction may learn the successors of each. Returns the
+** number of cycles emulated. */
+auint rrpge_m_op_run(rrpge_object_t* hnd, auint cymax);
+#endif
+
+
+/* Returns static properties of the instruction beginning with the given
+** opcode word, with "imm" being its pre-decoded 16 bit immediate. The return
+** is a combination of RRPGE_M_OPI flags and the worst case cycle count of
+** the instruction (this latter is only provided if neither of the JMP or the
+** HLT flags are set). Without the SFX flag the instruction only alters the
+** CPU registers (or raises a halt cause). */
+auint rrpge_m_op_info(auint op, auint imm);
+
+
 #endif
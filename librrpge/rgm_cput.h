@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.02
+**  \date      2015.10.12
 */
 
 
@@ -23,6 +23,57 @@ typedef RRPGE_M_FASTCALL auint (rrpge_m_addr_read_t)(rrpge_object_t* hnd, auint
 typedef RRPGE_M_FASTCALL void (rrpge_m_addr_write_t)(rrpge_object_t* hnd, auint val);
 
 
+/* Function type definition for opcode services. Returns number of cycles
+** consumed, they may alter the state at will. */
+typedef RRPGE_M_FASTCALL auint (rrpge_m_opf_t)(rrpge_object_t* hnd);
+
+
+/* Pre-decoded instruction record. One of these is produced for every code
+** memory address by rrpge_m_cpu_decode() once the code memory is loaded
+** (it is read only from then on), so the CPU emulation does not have to
+** decode the opcode words for every instruction it executes. Every address
+** is decoded as if an instruction started there, so this is valid for
+** function parameter words as well. */
+typedef struct{
+
+ rrpge_m_opf_t*       opf; /* Opcode handler (by opcode bits 9-15) */
+ rrpge_m_addr_read_t* arf; /* Addressing mode read (by opcode bits 0-5) */
+ uint16 opc;         /* Opcode word */
+ uint16 opi;         /* Opcode handler index (rrpge_m_op_index()), opf is the
+                     ** handler by this index. It may be a trap (breakpoint,
+                     ** idle loop or native routine) running the instruction
+                     ** by its opcode word when not taken. */
+ uint16 imm;         /* 16 bit immediate assembled from the low 2 bits of the
+                     ** opcode word and the following word (for the addressing
+                     ** modes using a second opcode word). */
+ uint16 bcy;         /* Execution block: worst case cycle count of all
+                     ** instructions in the block except the last one. */
+ uint8  bln;         /* Execution block: number of instructions in the block
+                     ** starting with this instruction (at least 1). */
+ uint8  hlt;         /* Nonzero if the instruction may raise a halt cause, so
+                     ** halts only need to be checked after these. */
+ uint8  idl;         /* Nonzero if the instruction is the head of a possible
+                     ** idle loop (see rrpge_m_cpu_idle()). */
+ uint8  hle;         /* Nonzero if the instruction is the entry point of a
+                     ** native User Library routine (see rrpge_m_cpuh_run()). */
+
+}rrpge_m_cpu_dec_t;
+
+
+/* Execution profile record. One of these is kept for every code memory
+** address, accumulating the instructions executed there while profiling is
+** enabled (see rrpge_enaprofile()). The counters wrap around. */
+typedef struct{
+
+ uint32 cnt;         /* Number of times the instruction was executed */
+ uint32 cyc;         /* CPU cycles consumed, including the stalls of the
+                     ** User Peripheral Area accesses */
+ uint32 cys;         /* Peripheral bus stall cycles generated (PRAM and FIFO
+                     ** accesses, see rrpge_m_pram_cys_add()) */
+
+}rrpge_m_cpu_prf_t;
+
+
 /* CPU emulation structure. Components defined here are private to the CPU
 ** emulation, only used by the rgm_cpu*.c sources. */
 typedef struct{
@@ -37,6 +88,10 @@ typedef struct{
                      ** the next opcode is loaded in this for faster access, in
                      ** function parameters it is also used for passing the
                      ** first word of the parameter components. */
+ rrpge_m_cpu_dec_t const* dec;
+                     /* Pre-decoded record of the opcode in opc. Set up
+                     ** along with opc, the addressing unit uses it to get the
+                     ** resolved second opcode word. */
 
  auint  xr[8];       /* CPU general registers (A-D, X0-X3) (State: 0x040-0x047) */
  auint  xmb[2];      /* CPU pointer mode/high registers (XM, XB) (State: 0x048-0x049) */
@@ -57,7 +112,16 @@ typedef struct{
                      ** corresponding addressing mode read to complete an
                      ** R-M-W cycle. The read function sets this function
                      ** pointer to the appropriate write function so it can be
-                     ** called. Increments rrpge_m_info.ocy if necessary. */
+                     ** called. Increments ocy if necessary. */
+
+ auint  brk;         /* Breakpoints armed: if nonzero, the breakpoint trap
+                     ** halts the emulation instead of running the
+                     ** instruction (only set in breakpoint mode). */
+ auint  ilp;         /* Idle loop probed: set once an idle loop head was
+                     ** probed within the run, so it is probed only once. */
+ auint  hle;         /* Native User Library routines enabled (rrpge_enanative()). */
+ auint  prf;         /* Profiling enabled (rrpge_enaprofile()): instructions
+                     ** are run one by one, accounted in the profile. */
 
 }rrpge_m_cpu_t;
 
@@ -6,19 +6,27 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.13
+**  \date      2015.10.12
 */
 
 
 #include "rgm_db.h"
+#include "rgm_cpu.h"
 #include "rgm_stat.h"
+#include "rgm_drty.h"
 
 
 
 /* Sets a breakpoint. - implementation of RRPGE library function */
 void rrpge_setbreak(rrpge_object_t* hnd, rrpge_iuint adr)
 {
- /* !!! Implement */
+ adr &= 0xFFFFU;
+ hnd->brkp[adr >> 5] |= (0x80000000U >> (adr & 0x1FU));
+ if (hnd->inss == RRPGE_INI_RESET){ /* Code memory is decoded: place trap */
+  if (rrpge_m_cpu_decode_at(hnd, adr) == 0U){
+   hnd->brkp[adr >> 5] &= ~(0x80000000U >> (adr & 0x1FU));
+  }
+ }
 }
 
 
@@ -26,8 +34,8 @@ void rrpge_setbreak(rrpge_object_t* hnd, rrpge_iuint adr)
 /* Queries if a given address is a breakpoint. - implementation of RRPGE library function */
 rrpge_ibool rrpge_isbreak(rrpge_object_t* hnd, rrpge_iuint adr)
 {
- /* !!! Implement */
- return 0U;
+ adr &= 0xFFFFU;
+ return ((hnd->brkp[adr >> 5] & (0x80000000U >> (adr & 0x1FU))) != 0U);
 }
 
 
@@ -35,7 +43,114 @@ rrpge_ibool rrpge_isbreak(rrpge_object_t* hnd, rrpge_iuint adr)
 /* Removes a breakpoint. - implementation of RRPGE library function */
 void rrpge_rembreak(rrpge_object_t* hnd, rrpge_iuint adr)
 {
- /* !!! Implement */
+ auint i;
+
+ adr &= 0xFFFFU;
+ hnd->brkp[adr >> 5] &= ~(0x80000000U >> (adr & 0x1FU));
+ if (hnd->inss == RRPGE_INI_RESET){ /* Code memory is decoded: remove trap */
+
+  /* Once no breakpoints remain, the application image's decoded code may be
+  ** used again */
+
+  for (i = 0U; i < 2048U; i++){
+   if (hnd->brkp[i] != 0U){ break; }
+  }
+  if (i == 2048U){ rrpge_m_cpu_decode_free(hnd); }
+  else           { (void)(rrpge_m_cpu_decode_at(hnd, adr)); }
+
+ }
+}
+
+
+
+/* Toggles execution profiling. - implementation of RRPGE library function */
+void rrpge_enaprofile(rrpge_object_t* hnd, rrpge_ibool tg)
+{
+ if (tg){
+  if (hnd->cprf == RRPGE_M_NULL){
+   hnd->cprf = rrpge_m_alloc(sizeof(rrpge_m_cpu_prf_t) * 65536U,
+                             RRPGE_M_OBJ_RAW | RRPGE_M_OBJ_LZY);
+   if (hnd->cprf == RRPGE_M_NULL){ return; } /* Profiling stays OFF */
+   if (rrpge_m_alloc_lzy(hnd->cprf) == 0U){ rrpge_clrprofile(hnd); }
+  }
+  hnd->cpu.prf = 1U;
+ }else{
+  hnd->cpu.prf = 0U;
+ }
+}
+
+
+
+/* Clears the execution profile. - implementation of RRPGE library function */
+void rrpge_clrprofile(rrpge_object_t* hnd)
+{
+ auint i;
+ if (hnd->cprf == RRPGE_M_NULL){ return; }
+ for (i = 0U; i < 65536U; i++){
+  hnd->cprf[i].cnt = 0U;
+  hnd->cprf[i].cyc = 0U;
+  hnd->cprf[i].cys = 0U;
+ }
+}
+
+
+
+/* Gets the execution profile of a code address. - implementation of RRPGE library function */
+rrpge_iuint rrpge_getprofile(rrpge_object_t* hnd, rrpge_iuint adr,
+                             rrpge_iuint* cyc, rrpge_iuint* cys)
+{
+ adr &= 0xFFFFU;
+ if (hnd->cprf == RRPGE_M_NULL){
+  if (cyc != RRPGE_M_NULL){ *cyc = 0U; }
+  if (cys != RRPGE_M_NULL){ *cys = 0U; }
+  return 0U;
+ }
+ if (cyc != RRPGE_M_NULL){ *cyc = hnd->cprf[adr].cyc; }
+ if (cys != RRPGE_M_NULL){ *cys = hnd->cprf[adr].cys; }
+ return hnd->cprf[adr].cnt;
+}
+
+
+
+/* Gets the dirty page bit map of a memory. - implementation of RRPGE library function */
+rrpge_iuint rrpge_getdirty(rrpge_object_t* hnd, rrpge_iuint mem,
+                           rrpge_uint32* bmp)
+{
+ uint32 const* src;
+ auint i;
+ auint n;
+
+ if      (mem == RRPGE_DIRTY_PRAM){ src = &(hnd->drtp[0]); n = 128U; }
+ else if (mem == RRPGE_DIRTY_DRAM){ src = &(hnd->drtd[0]); n =  12U; }
+ else                             { return 0U; }
+
+ if (bmp != RRPGE_M_NULL){
+  for (i = 0U; i < n; i++){ bmp[i] = src[i]; }
+ }
+ return n;
+}
+
+
+
+/* Clears the dirty page bit map of a memory. - implementation of RRPGE library function */
+void rrpge_clrdirty(rrpge_object_t* hnd, rrpge_iuint mem)
+{
+ auint i;
+
+ if (mem == RRPGE_DIRTY_PRAM){
+  for (i = 0U; i < 128U; i++){ hnd->drtp[i] = 0U; }
+ }else if (mem == RRPGE_DIRTY_DRAM){
+  for (i = 0U; i <  12U; i++){ hnd->drtd[i] = 0U; }
+ }
+}
+
+
+
+/* Gets a value from the Code ROM. - implementation of RRPGE library
+** function */
+rrpge_iuint rrpge_get_code(rrpge_object_t* hnd, rrpge_iuint adr)
+{
+ return (rrpge_iuint)(hnd->app->crom[adr & 0xFFFFU]);
 }
 
 
@@ -52,8 +167,10 @@ rrpge_iuint rrpge_get_pram(rrpge_object_t* hnd, rrpge_iuint adr)
 /* Sets a value in the PRAM. - implementation of RRPGE library function */
 rrpge_iuint rrpge_set_pram(rrpge_object_t* hnd, rrpge_iuint adr, rrpge_iuint val)
 {
- if (adr <  0x100000U){
+ if ( (adr <  0x100000U) &&
+      (hnd->rlg == RRPGE_M_NULL) ){   /* Not while an input log is active */
   hnd->st.pram[adr] = (rrpge_uint32)(val);
+  rrpge_m_drty_pram(hnd, adr);
  }
  return rrpge_get_pram(hnd, adr);
 }
@@ -72,8 +189,10 @@ rrpge_iuint rrpge_get_dram(rrpge_object_t* hnd, rrpge_iuint adr)
 /* Sets a value in the DRAM. - implementation of RRPGE library function */
 rrpge_iuint rrpge_set_dram(rrpge_object_t* hnd, rrpge_iuint adr, rrpge_iuint val)
 {
- if (adr <  0x10000U){
+ if ( (adr <  0x10000U) &&
+      (hnd->rlg == RRPGE_M_NULL) ){   /* Not while an input log is active */
   hnd->st.dram[adr] = (rrpge_uint16)(val);
+  rrpge_m_drty_dram(hnd, adr);
  }
  return rrpge_get_dram(hnd, adr);
 }
@@ -91,7 +210,9 @@ rrpge_iuint rrpge_get_state(rrpge_object_t* hnd, rrpge_iuint adr)
 /* Sets a value in the State. - implementation of RRPGE library function */
 rrpge_iuint rrpge_set_state(rrpge_object_t* hnd, rrpge_iuint adr, rrpge_iuint val)
 {
- rrpge_m_stat_set(hnd, adr, val);
+ if (hnd->rlg == RRPGE_M_NULL){  /* Not while an input log is active */
+  rrpge_m_stat_set(hnd, adr, val);
+ }
  return rrpge_m_stat_get(hnd, adr);
 }
 
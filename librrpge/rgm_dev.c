@@ -15,6 +15,7 @@
 #include "rgm_devx.h"
 #include "rgm_halt.h"
 #include "rgm_stat.h"
+#include "rgm_rlog.h"
 
 
 
@@ -630,6 +631,8 @@ rrpge_iuint rrpge_dev_add(rrpge_object_t* hnd, rrpge_iuint typ)
  auint d;
  auint i;
 
+ if (!rrpge_m_rlog_devadd(hnd, typ)){ return RRPGE_M_DEVT_MAX_DEV; }
+
  /* Find first empty slot in physical input device list */
 
  for (d = 0U; d < RRPGE_M_DEVT_MAX_DEV; d++){
@@ -663,6 +666,7 @@ rrpge_iuint rrpge_dev_add(rrpge_object_t* hnd, rrpge_iuint typ)
 /* Remove input device - implementation of RRPGE library function */
 void rrpge_dev_rem(rrpge_object_t* hnd, rrpge_iuint dev)
 {
+ if (!rrpge_m_rlog_devrem(hnd, dev)){ return; }
  if (dev >= RRPGE_M_DEVT_MAX_DEV){ return; }
  hnd->dev.devo[dev] = 0U;
 }
@@ -676,6 +680,8 @@ void rrpge_dev_push(rrpge_object_t* hnd, rrpge_iuint dev,
  auint i;
  auint t;
 
+ if (!rrpge_m_rlog_devpush(hnd, dev, emt, cnt, msg)){ return; }
+
  /* Discard invalid or not even registered input devices */
 
  if (dev >= RRPGE_M_DEVT_MAX_DEV){ return; }
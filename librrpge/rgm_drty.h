@@ -0,0 +1,105 @@
+/**
+**  \file
+**  \brief     Dirty page tracking of the PRAM and the Data memory.
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.08
+**
+**
+**  Uses the drtp and drtd members of the emulator object. Every component
+**  writing the PRAM or the Data memory (including the stack) has to mark the
+**  written page dirty using these. The page size is 256 cells (see
+**  RRPGE_DIRTY_PAGE), the bit maps are ordered like the breakpoints (page 0
+**  is the highest bit of the first word).
+**
+**  The rstp and rstd members are marked along, but they are only cleared by
+**  a reset, so the reset may restore only the pages written since the last
+**  one (the dirty page bit maps may be cleared by the host or the rewind
+**  buffer meanwhile).
+**
+**  Note: uses static functions so they may be substituted like macros in the
+**  appropriate places.
+*/
+
+
+#ifndef RRPGE_M_DRTY_H
+#define RRPGE_M_DRTY_H
+
+
+#include "rgm_info.h"
+
+
+/* Size of the Data memory including the stack */
+#define RRPGE_M_DRTY_DRAMS (sizeof(((rrpge_state_t*)(0))->dram) / sizeof(((rrpge_state_t*)(0))->dram[0]))
+
+
+/* Marks the PRAM page containing the given cell dirty. The address must be
+** within the PRAM. */
+static void  rrpge_m_drty_pram(rrpge_object_t* hnd, auint adr)
+{
+ hnd->drtp[adr >> 13] |= (0x80000000U >> ((adr >> 8) & 0x1FU));
+ hnd->rstp[adr >> 13] |= (0x80000000U >> ((adr >> 8) & 0x1FU));
+}
+
+/* Marks the Data memory page containing the given cell dirty. The address
+** must be within the Data memory. */
+static void  rrpge_m_drty_dram(rrpge_object_t* hnd, auint adr)
+{
+ hnd->drtd[adr >> 13] |= (0x80000000U >> ((adr >> 8) & 0x1FU));
+ hnd->rstd[adr >> 13] |= (0x80000000U >> ((adr >> 8) & 0x1FU));
+}
+
+/* Marks the Data memory pages covered by a range dirty. The range is
+** clipped to the Data memory. */
+static void  rrpge_m_drty_dram_rng(rrpge_object_t* hnd, auint adr, auint len)
+{
+ auint e;
+ if (len == 0U){ return; }
+ if (adr >= RRPGE_M_DRTY_DRAMS){ return; }
+ e = adr + len;
+ if (e > RRPGE_M_DRTY_DRAMS){ e = RRPGE_M_DRTY_DRAMS; }
+ adr >>= 8;
+ e = (e - 1U) >> 8;
+ for (; adr <= e; adr++){
+  hnd->drtd[adr >> 5] |= (0x80000000U >> (adr & 0x1FU));
+  hnd->rstd[adr >> 5] |= (0x80000000U >> (adr & 0x1FU));
+ }
+}
+
+/* Marks all pages of both memories dirty (used when they are rewritten as
+** a whole, such as on a full reset) */
+static void  rrpge_m_drty_all(rrpge_object_t* hnd)
+{
+ auint i;
+ for (i = 0U; i < 128U; i++){ hnd->drtp[i] = 0xFFFFFFFFU; }
+ for (i = 0U; i <  12U; i++){ hnd->drtd[i] = 0xFFFFFFFFU; }
+ for (i = 0U; i < 128U; i++){ hnd->rstp[i] = 0xFFFFFFFFU; }
+ for (i = 0U; i <  12U; i++){ hnd->rstd[i] = 0xFFFFFFFFU; }
+}
+
+/* Returns nonzero if all pages of both memories were written since the last
+** reset (such as before the first reset), so a reset has to rewrite them as
+** a whole. */
+static auint rrpge_m_drty_rstall(rrpge_object_t const* hnd)
+{
+ auint i;
+ auint m = 0xFFFFFFFFU;
+ for (i = 0U; i < 128U; i++){ m &= hnd->rstp[i]; }
+ for (i = 0U; i <  12U; i++){ m &= hnd->rstd[i]; }
+ return (m == 0xFFFFFFFFU);
+}
+
+/* Clears the bit maps of pages written since the last reset (when the reset
+** completed). */
+static void  rrpge_m_drty_rstclr(rrpge_object_t* hnd)
+{
+ auint i;
+ for (i = 0U; i < 128U; i++){ hnd->rstp[i] = 0U; }
+ for (i = 0U; i <  12U; i++){ hnd->rstd[i] = 0U; }
+}
+
+
+#endif
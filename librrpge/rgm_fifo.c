@@ -21,6 +21,7 @@
 #include "rgm_mix.h"
 #include "rgm_pram.h"
 #include "rgm_stat.h"
+#include "rgm_drty.h"
 
 
 
@@ -32,16 +33,16 @@
 
 /* Internal function to update an Accelerator register by address, also
 ** triggering the operation if necessary. */
-RRPGE_M_FASTCALL static void rrpge_m_fifoacc(auint adr, auint val)
+RRPGE_M_FASTCALL static void rrpge_m_fifoacc(rrpge_object_t* hnd, auint adr, auint val)
 {
  if ((adr & 0x100U) == 0U){
-  rrpge_m_stat_write(rrpge_m_edat, RRPGE_STA_ACC   + (adr & 0x1FU), val);
+  rrpge_m_stat_write(hnd, RRPGE_STA_ACC   + (adr & 0x1FU), val);
   if ((adr & 0x1FU) == 0x1FU){ /* Trigger */
-   rrpge_m_info.cyf[1] += rrpge_m_acc_op(rrpge_m_edat);
-   rrpge_m_edat->st.stat[RRPGE_STA_UPA_GF + 1U] |= 1U; /* FIFO / Peripheral working */
+   hnd->cyf[1] += rrpge_m_acc_op(hnd);
+   hnd->st.stat[RRPGE_STA_UPA_GF + 1U] |= 1U; /* FIFO / Peripheral working */
   }
  }else{
-  rrpge_m_stat_write(rrpge_m_edat, RRPGE_STA_REIND + (adr & 0xFFU), val);
+  rrpge_m_stat_write(hnd, RRPGE_STA_REIND + (adr & 0xFFU), val);
  }
 }
 
@@ -49,12 +50,12 @@ RRPGE_M_FASTCALL static void rrpge_m_fifoacc(auint adr, auint val)
 
 /* Internal function to update a Mixer register by address, also triggering
 ** the operation if necessary. */
-RRPGE_M_FASTCALL static void rrpge_m_fifomix(auint adr, auint val)
+RRPGE_M_FASTCALL static void rrpge_m_fifomix(rrpge_object_t* hnd, auint adr, auint val)
 {
- rrpge_m_edat->st.stat[RRPGE_STA_MIXER + (adr & 0xFU)] = val & 0xFFFFU;
+ hnd->st.stat[RRPGE_STA_MIXER + (adr & 0xFU)] = val & 0xFFFFU;
  if ((adr & 0xFU) == 0xFU){ /* Trigger */
-  rrpge_m_info.cyf[0] += rrpge_m_mix_op(rrpge_m_edat);
-  rrpge_m_edat->st.stat[RRPGE_STA_UPA_MF + 1U] |= 1U; /* FIFO / Peripheral working */
+  hnd->cyf[0] += rrpge_m_mix_op(hnd);
+  hnd->st.stat[RRPGE_STA_UPA_MF + 1U] |= 1U; /* FIFO / Peripheral working */
  }
 }
 
@@ -71,15 +72,15 @@ RRPGE_M_FASTCALL static auint rrpge_m_fifoadr(auint ptr, auint ps)
 
 
 /* Emulates Graphics and Mixer FIFO for the given amount of cycles. Uses the
-** cys (stall), cya (accelerator) and cym (mixer) members of the rrpge_m_info
-** structure, updating them as appropriate. */
-void  rrpge_m_fifoproc(auint cy)
+** Peripheral bus stall cycles and the FIFO cycles (cyf) of the emulation
+** instance, updating them as appropriate. */
+void  rrpge_m_fifoproc(rrpge_object_t* hnd, auint cy)
 {
  auint v, t, i;
 
  /* Check stall cycles */
 
- cy = rrpge_m_pram_cys_cons(rrpge_m_edat, cy);
+ cy = rrpge_m_pram_cys_cons(hnd, cy);
 
  /* Run emulation (truly this is the asynchronous Peripheral bus' emulation
  ** task, excluding the Graphics Display Generator) */
@@ -87,34 +88,34 @@ void  rrpge_m_fifoproc(auint cy)
  for (i = 0U; i < 2U; i++){
 
   while ( (cy != 0U) &&           /* There are cycles to work from */
-          (rrpge_m_info.cyf[i] != 0U) ){ /* There are FIFO cycles are to be consumed */
+          (hnd->cyf[i] != 0U) ){ /* There are FIFO cycles are to be consumed */
 
-   if (rrpge_m_info.cyf[i] > cy){ /* Can't consume all */
+   if (hnd->cyf[i] > cy){ /* Can't consume all */
 
-    rrpge_m_info.cyf[i] -= cy;
+    hnd->cyf[i] -= cy;
     cy = 0U;
 
    }else{                         /* Consumes all: attempt to step emulation */
 
-    cy -= rrpge_m_info.cyf[i];
-    rrpge_m_info.cyf[i] = 0U;
+    cy -= hnd->cyf[i];
+    hnd->cyf[i] = 0U;
 
-    if ( (rrpge_m_edat->st.stat[RRPGE_STA_VARS + 0x20U + (i << 3)] & 0xFFFFU) ==
-         (rrpge_m_edat->st.stat[RRPGE_STA_VARS + 0x21U + (i << 3)] & 0xFFFFU) ){ /* FIFO drained */
+    if ( (hnd->st.stat[RRPGE_STA_VARS + 0x20U + (i << 3)] & 0xFFFFU) ==
+         (hnd->st.stat[RRPGE_STA_VARS + 0x21U + (i << 3)] & 0xFFFFU) ){ /* FIFO drained */
 
-     rrpge_m_edat->st.stat[RRPGE_STA_UPA_MF + 1U + (i << 2)] &= ~1U; /* Empty, peripheral idle */
+     hnd->st.stat[RRPGE_STA_UPA_MF + 1U + (i << 2)] &= ~1U; /* Empty, peripheral idle */
 
     }else{                       /* There is data in the FIFO */
 
-     if ((rrpge_m_edat->st.stat[RRPGE_STA_UPA_MF + 1U + (i << 2)] & 2U) == 0U){  /* Not suspended */
+     if ((hnd->st.stat[RRPGE_STA_UPA_MF + 1U + (i << 2)] & 2U) == 0U){  /* Not suspended */
 
-      t = rrpge_m_edat->st.stat[RRPGE_STA_VARS + 0x21U + (i << 3)];
-      v = rrpge_m_edat->st.pram[rrpge_m_fifoadr(t, rrpge_m_edat->st.stat[RRPGE_STA_UPA_MF + 0x0U + (i << 2)])];
+      t = hnd->st.stat[RRPGE_STA_VARS + 0x21U + (i << 3)];
+      v = hnd->st.pram[rrpge_m_fifoadr(t, hnd->st.stat[RRPGE_STA_UPA_MF + 0x0U + (i << 2)])];
       t ++;
-      rrpge_m_edat->st.stat[RRPGE_STA_VARS + 0x21U + (i << 3)] = t & 0xFFFFU;
-      rrpge_m_info.cyf[i] = 2U;   /* Cycles consumed by FIFO access */
-      if (i == 0U){ rrpge_m_fifomix(v >> 16, v); }
-      else        { rrpge_m_fifoacc(v >> 16, v); }
+      hnd->st.stat[RRPGE_STA_VARS + 0x21U + (i << 3)] = t & 0xFFFFU;
+      hnd->cyf[i] = 2U;   /* Cycles consumed by FIFO access */
+      if (i == 0U){ rrpge_m_fifomix(hnd, v >> 16, v); }
+      else        { rrpge_m_fifoacc(hnd, v >> 16, v); }
 
      }
 
@@ -133,10 +134,10 @@ void  rrpge_m_fifoproc(auint cy)
 /* Operates the memory mapped interface of the FIFOs. Only the low 3 bits of
 ** the address are used (low 4 addresses selecting the Mixer FIFO, high 4
 ** addresses the Graphics FIFO). Only low 16 bits of value are used. */
-void  rrpge_m_fifowrite(auint adr, auint val)
+void  rrpge_m_fifowrite(rrpge_object_t* hnd, auint adr, auint val)
 {
  auint t, u, p;
- uint16* stat = &(rrpge_m_edat->st.stat[0]);
+ uint16* stat = &(hnd->st.stat[0]);
 
  adr = adr & 7U;
 
@@ -165,22 +166,23 @@ void  rrpge_m_fifowrite(auint adr, auint val)
 
    t = RRPGE_STA_VARS + 0x24U + ((adr & 4U) << 1);  /* Address latch's address in state */
 
-   if ( (rrpge_m_info.cyf[(adr >> 2)] |
+   if ( (hnd->cyf[(adr >> 2)] |
          stat[RRPGE_STA_UPA_MF + adr - 2U]) == 0U){ /* Bypass */
 
     u = stat[t] & 0xFFFFU;    /* Read the address latch */
-    if ((adr & 4U) == 0U){ rrpge_m_fifomix(u, val); }
-    else                 { rrpge_m_fifoacc(u, val); }
+    if ((adr & 4U) == 0U){ rrpge_m_fifomix(hnd, u, val); }
+    else                 { rrpge_m_fifoacc(hnd, u, val); }
 
    }else{                     /* No bypass */
 
     u = stat[t - 4U] & 0xFFFFU;  /* Write pointer value */
     p = stat[RRPGE_STA_UPA_MF + adr - 3U] & 0xFFFFU; /* FIFO position & size */
-    rrpge_m_edat->st.pram[rrpge_m_fifoadr(u, p)] =
-     ((stat[t] & 0xFFFFU) << 16) + (val & 0xFFFFU);
+    p = rrpge_m_fifoadr(u, p);   /* PRAM address to write */
+    hnd->st.pram[p] = ((stat[t] & 0xFFFFU) << 16) + (val & 0xFFFFU);
+    rrpge_m_drty_pram(hnd, p);
     u ++;
     stat[t - 4U] = u & 0xFFFFU;  /* Write ptr. increment */
-    rrpge_m_pram_cys_add(rrpge_m_edat, 2U); /* 2 stall cycles on the Peripheral bus */
+    rrpge_m_pram_cys_add(hnd, 2U); /* 2 stall cycles on the Peripheral bus */
 
    }
 
@@ -24,15 +24,15 @@
 
 
 /* Emulates Graphics and Mixer FIFO for the given amount of cycles. Uses the
-** cys (stall), cya (accelerator) and cym (mixer) members of the rrpge_m_info
-** structure, updating them as appropriate. */
-void  rrpge_m_fifoproc(auint cy);
+** Peripheral bus stall cycles and the FIFO cycles (cyf) of the emulation
+** instance, updating them as appropriate. */
+void  rrpge_m_fifoproc(rrpge_object_t* hnd, auint cy);
 
 
 /* Operates the memory mapped interface of the FIFOs. Only the low 3 bits of
 ** the address are used (low 4 addresses selecting the Mixer FIFO, high 4
 ** addresses the Graphics FIFO). Only low 16 bits of value are used. */
-void  rrpge_m_fifowrite(auint adr, auint val);
+void  rrpge_m_fifowrite(rrpge_object_t* hnd, auint adr, auint val);
 
 
 /* Sets Graphics FIFO suspend */
@@ -9,26 +9,17 @@
 **  \date      2015.01.08
 **
 **
-** The global structure's fields are used within servicing one RRPGE library
-** call (and not across calls, so the library is able to handle more emulation
-** instances simultaneously as it is supposed to). The reason behind using
-** this architecture is performance.
-**
-** Some of the values are just copies from the read only process descriptor,
-** if modified, updated before return. The reason is that the process
-** descriptor comes through an indirection by an RRPGE library interface data
-** pointer, using that directly multiple times through non native sized (16bit
-** instead of 32/64) is slower.
+** All emulation state is held in the emulation instance (rrpge_object_t), so
+** the library is able to handle more emulation instances simultaneously,
+** even from different threads. The only process wide data are the allocators
+** and deallocators set up by rrpge_init_lib() and rrpge_init_mem(), and the
+** tables initialized by rrpge_init_lib() which are read only afterwards.
 */
 
 
 #include "rgm_info.h"
 
 
-rrpge_m_info_t  rrpge_m_info;
-rrpge_object_t* rrpge_m_edat;
-
-
 /* Empty allocator and deallocator for non-initialized behavior */
 
 void* rrpge_m_malloc_def(rrpge_iuint siz){ return RRPGE_M_NULL; }
@@ -38,3 +29,90 @@ void  rrpge_m_free_def(void* ptr){}
 
 rrpge_malloc_t* rrpge_m_malloc = &rrpge_m_malloc_def;
 rrpge_free_t*   rrpge_m_free   = &rrpge_m_free_def;
+
+/* Zero filling allocator, deallocator and releaser set up by rrpge_init_mem()
+** (NULL if not set) */
+
+rrpge_malloc_t*  rrpge_m_malz = RRPGE_M_NULL;
+rrpge_free_t*    rrpge_m_frez = RRPGE_M_NULL;
+rrpge_release_t* rrpge_m_rels = RRPGE_M_NULL;
+
+
+/* Header placed before every library allocated object, holding its type. It
+** is sized to keep the alignment of the object following it. The type may
+** have the RRPGE_M_OBJ_LZY flag set if the object was allocated by the zero
+** filling allocator. */
+typedef union{
+ auint  typ;
+ void*  ptr;
+ double dbl;
+}rrpge_m_alloc_hdr_t;
+
+
+
+/* Allocates a library object of the given type using the allocator. If the
+** type has the RRPGE_M_OBJ_LZY flag set, the zero filling allocator is used
+** when it is available (the flag is cleared otherwise). Returns NULL if the
+** allocation failed. */
+void* rrpge_m_alloc(auint siz, auint typ)
+{
+ rrpge_m_alloc_hdr_t* h;
+
+ if ( ((typ & RRPGE_M_OBJ_LZY) != 0U) &&
+      (rrpge_m_malz != RRPGE_M_NULL) ){
+  h = rrpge_m_malz(sizeof(rrpge_m_alloc_hdr_t) + siz);
+ }else{
+  typ &= ~RRPGE_M_OBJ_LZY;
+  h = rrpge_m_malloc(sizeof(rrpge_m_alloc_hdr_t) + siz);
+ }
+ if (h == RRPGE_M_NULL){ return RRPGE_M_NULL; }
+ h->typ = typ;
+
+ return (void*)(h + 1);
+}
+
+
+
+/* Returns the type of a library object allocated by rrpge_m_alloc(). */
+auint rrpge_m_alloc_typ(void const* obj)
+{
+ return ((((rrpge_m_alloc_hdr_t const*)(obj)) - 1)->typ) & (~RRPGE_M_OBJ_LZY);
+}
+
+
+
+/* Returns nonzero if the library object was allocated by the zero filling
+** allocator. */
+auint rrpge_m_alloc_lzy(void const* obj)
+{
+ return ((((rrpge_m_alloc_hdr_t const*)(obj)) - 1)->typ) & RRPGE_M_OBJ_LZY;
+}
+
+
+
+/* Frees a library object allocated by rrpge_m_alloc(). */
+void  rrpge_m_alloc_free(void* obj)
+{
+ if (rrpge_m_alloc_lzy(obj)){
+  rrpge_m_frez(((rrpge_m_alloc_hdr_t*)(obj)) - 1);
+ }else{
+  rrpge_m_free(((rrpge_m_alloc_hdr_t*)(obj)) - 1);
+ }
+}
+
+
+
+/* Calculates the checksum of a loaded application image (code, initial
+** data, header and descriptor). */
+auint rrpge_m_app_sum(rrpge_app_t const* app)
+{
+ auint i;
+ auint s = 0x811C9DC5U;
+
+ for (i = 0U; i < 65536U; i++){ s = ((s ^ app->crom[i]) * 0x01000193U) & 0xFFFFFFFFU; }
+ for (i = 0U; i < 65536U; i++){ s = ((s ^ app->dini[i]) * 0x01000193U) & 0xFFFFFFFFU; }
+ for (i = 0U; i <    64U; i++){ s = ((s ^ app->apph[i]) * 0x01000193U) & 0xFFFFFFFFU; }
+ for (i = 0U; i <    64U; i++){ s = ((s ^ app->appd[i]) * 0x01000193U) & 0xFFFFFFFFU; }
+
+ return s;
+}
@@ -1,18 +1,18 @@
 /**
 **  \file
-**  \brief     Global information structure.
+**  \brief     Emulation instance structure.
 **  \author    Sandor Zsuga (Jubatian)
 **  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.16
+**  \date      2015.10.12
 **
 **
-** The global structure's fields are used within servicing one RRPGE library
-** call (and not across calls, so the library is able to handle more emulation
-** instances simultaneously as it is supposed to). The reason behind using
-** this architecture is performance.
+** The emulation instance holds all the state of the emulation, so the library
+** is able to handle more emulation instances simultaneously. The loaded
+** application is held in a separate application image which may be shared by
+** multiple emulation instances (see rrpge_clone() and rrpge_getapp()).
 **
 ** Some of the values are just copies from the application state, if modified,
 ** updated before return. The reason is that the app. state comes through an
@@ -33,6 +33,28 @@
 #include "rgm_devt.h"
 #include "rgm_mixt.h"
 #include "rgm_audt.h"
+#include "rgm_rlgt.h"
+
+
+
+/* Application image. It is filled by rrpge_init_run() while loading the
+** application, and is read only afterwards, so emulation instances of the
+** same application may share it (see rrpge_clone() and rrpge_getapp()). It
+** is freed when the last reference to it is released. */
+struct rrpge_app_s{
+
+ auint  ref;            /* Reference count: emulation instances using it */
+ auint  sum;            /* Checksum identifying the application (see
+                        ** rrpge_m_app_sum()), set once loaded */
+ uint16 crom[65536U];   /* Code memory */
+ uint16 dini[65536U];   /* Initial data memory (for resets) */
+ uint16 apph[64U];      /* Application header */
+ uint16 appd[64U];      /* Application descriptor */
+ auint  ulv;            /* User Library intact in the code memory, so its
+                        ** routines may run natively (rrpge_m_cpuh_check()) */
+ rrpge_m_cpu_dec_t cdec[65536U]; /* Pre-decoded code memory (rgm_cpu.c) */
+
+};
 
 
 
@@ -43,22 +65,36 @@ struct rrpge_object_s{
 
  rrpge_state_t st;   /* Complete emulator state as defined in the library interface */
 
- uint16 crom[65536U];   /* Code memory */
- uint16 dini[65536U];   /* Initial data memory (for resets) */
- uint16 apph[64U];      /* Application header */
- uint16 appd[64U];      /* Application descriptor */
+ rrpge_app_t* app;   /* Application image (code, initial data, header) */
+ rrpge_m_cpu_dec_t* cdec; /* Pre-decoded code memory in use: the application
+                     ** image's, or the instance's own copy holding the
+                     ** breakpoint traps (rgm_cpu.c) */
+ rrpge_m_cpu_prf_t* cprf; /* Execution profile of code memory (rgm_cpu.c), 65536
+                     ** records, allocated when profiling is first enabled
+                     ** (NULL until then) */
 
  uint32 brkp[2048U]; /* Bit map marking code addresses as breakpoints */
+ uint32 drtp[128U];  /* Bit map of dirty PRAM pages (rgm_drty.h) */
+ uint32 drtd[12U];   /* Bit map of dirty Data memory pages (rgm_drty.h) */
+ uint32 rstp[128U];  /* Bit map of PRAM pages written since reset (rgm_drty.h) */
+ uint32 rstd[12U];   /* Bit map of Data memory pages written since reset (rgm_drty.h) */
 
  uint16 recb[4096U]; /* Receive data buffer for network packets */
  uint16 reci[512U];  /* Receive source ID buffer (64 sources, 8 words each) */
  auint  recl[64U];   /* Receive packet length buffer */
 
  rrpge_cb_line_t*     cb_lin; /* Line renderer callback */
+ rrpge_cb_frame_t*    cb_frm; /* Frame renderer callback (rgm_vid.c) */
+ void*  frb;         /* Frame buffer set by rrpge_setframe(), NULL if none */
+ auint  frp;         /* Frame buffer pitch in bytes */
+ auint  frf;         /* Frame buffer pixel format */
+ uint32 frc[256U];   /* Palette converted to the pixel format (rgm_vidl.c) */
  rrpge_cb_kcalltsk_t* cb_tsk[RRPGE_CB_IDRANGE]; /* Kernel task callbacks */
  rrpge_cb_kcallsub_t* cb_sub[RRPGE_CB_IDRANGE]; /* Kernel subroutine callbacks */
  rrpge_cb_kcallfun_t* cb_fun[RRPGE_CB_IDRANGE]; /* Kernel function callbacks */
 
+ rrpge_m_rlog_t* rlg; /* Input log recorded or replayed, NULL if none (rgm_rlog.c) */
+
  rrpge_m_cpu_t cpu;  /* CPU emulation structure */
  rrpge_m_prm_t prm;  /* PRAM emulation structure */
  rrpge_m_vid_t vid;  /* Video (GDG) emulation structure */
@@ -81,35 +117,61 @@ struct rrpge_object_s{
 
  auint  kfc;         /* Free cycle count remaining between kernel internal
                      ** process takeovers. */
+ auint  prng;        /* Pseudorandom number generator state (rgm_prng.c) */
+
+ auint  cyf[2];      /* FIFO cycles, copied from the Application state
+                     ** during rrpge_run():
+                     ** 0: Cycles remaining from mixer op. (State: 0x062-0x063)
+                     ** 1: Cycles remaining from video acc. op. (State: 0x06A-0x06B) */
 
  auint  insm;        /* Initialization state machine */
  auint  inss;        /* Current reached initialization state (rrpge_init defines) */
 
+ auint  mzr;         /* Memories (PRAM and Data memory) are still zero as
+                     ** allocated by the zero filling allocator, so the next
+                     ** reset doesn't need to clear them (rgm_ires.c) */
+
 };
 
 
 
-/* Global info structure. This is used to accelerate emulation. Note that
-** preferably all globals are placed here to increase locality, and to have
-** everything preventing threaded use in one place. TODO: This will be removed
-** as part of the refactoring process once everything adapts the new
-** structure. */
-typedef struct{
+/* Allocator and deallocator */
 
- auint  cyf[2];      /* FIFO cycles:
-                     ** 0: Cycles remaining from mixer op. (State: 0x062-0x063)
-                     ** 1: Cycles remaining from video acc. op. (State: 0x06A-0x06B) */
+extern rrpge_malloc_t* rrpge_m_malloc;
+extern rrpge_free_t*   rrpge_m_free;
 
-}rrpge_m_info_t;
+/* Zero filling allocator, deallocator and releaser (NULL if not set) */
 
+extern rrpge_malloc_t*  rrpge_m_malz;
+extern rrpge_free_t*    rrpge_m_frez;
+extern rrpge_release_t* rrpge_m_rels;
 
-extern rrpge_m_info_t  rrpge_m_info;
-extern rrpge_object_t* rrpge_m_edat;
 
-/* Allocator and deallocator */
+/* Types of library allocated objects, so rrpge_delete() can tell how to
+** destroy them */
+#define RRPGE_M_OBJ_RAW 0U  /* Raw data, no destruction needed */
+#define RRPGE_M_OBJ_EMU 1U  /* Emulation instance (rrpge_object_t) */
+#define RRPGE_M_OBJ_APP 2U  /* Application image (rrpge_app_t) */
+#define RRPGE_M_OBJ_RWD 3U  /* Rewind buffer (rrpge_rewind_t), no destruction needed */
+#define RRPGE_M_OBJ_LZY 0x100U /* Flag: use the zero filling allocator if available */
 
-extern rrpge_malloc_t* rrpge_m_malloc;
-extern rrpge_free_t*   rrpge_m_free;
+/* Allocates a library object of the given type using the allocator. Returns
+** NULL if the allocation failed. */
+void* rrpge_m_alloc(auint siz, auint typ);
+
+/* Returns the type of a library object allocated by rrpge_m_alloc(). */
+auint rrpge_m_alloc_typ(void const* obj);
+
+/* Returns nonzero if the library object was allocated by the zero filling
+** allocator. */
+auint rrpge_m_alloc_lzy(void const* obj);
+
+/* Frees a library object allocated by rrpge_m_alloc(). */
+void  rrpge_m_alloc_free(void* obj);
+
+/* Calculates the checksum of a loaded application image (code, initial
+** data, header and descriptor). */
+auint rrpge_m_app_sum(rrpge_app_t const* app);
 
 
 #endif
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.18
+**  \date      2015.10.12
 */
 
 
@@ -17,6 +17,7 @@
 #include "rgm_vid.h"
 #include "rgm_dev.h"
 #include "rgm_aud.h"
+#include "rgm_drty.h"
 
 
 /* State: Nonzero elements in the VARS area (address, data high, data low) */
@@ -1031,17 +1032,17 @@ static void rrpge_m_ires_initl(rrpge_object_t* obj)
 
 
 
-/* Initializes the CPU data memory into the 'dini' member of the object. This
-** should be called before loading the application binary so data memory
-** portions not loaded from the binary are adequately initialized */
+/* Initializes the CPU data memory into the 'dini' member of the application
+** image. This should be called before loading the application binary so data
+** memory portions not loaded from the binary are adequately initialized */
 void rrpge_m_ires_initdata(rrpge_object_t* obj)
 {
  auint   i;
- uint16* d = &(obj->dini[0]);
+ uint16* d = &(obj->app->dini[0]);
 
  /* Reset data memory initializer */
 
- for (i = 0U; i < (sizeof(obj->dini) / sizeof(obj->dini[0])); i++){
+ for (i = 0U; i < (sizeof(obj->app->dini) / sizeof(obj->app->dini[0])); i++){
   d[i] = 0U;
  }
 
@@ -1095,11 +1096,11 @@ void rrpge_m_ires_initdata(rrpge_object_t* obj)
 void rrpge_m_ires_initcode(rrpge_object_t* obj)
 {
  auint   i;
- uint16* c = &(obj->crom[0]);
+ uint16* c = &(obj->app->crom[0]);
 
  /* Reset code memory */
 
- for (i = 0U; i < (sizeof(obj->crom) / sizeof(obj->crom[0])); i++){
+ for (i = 0U; i < (sizeof(obj->app->crom) / sizeof(obj->app->crom[0])); i++){
   c[i] = 0U;
  }
 
@@ -1143,14 +1144,14 @@ void rrpge_m_ires_initstat(rrpge_object_t* obj)
  /* Add application header and descriptor elements */
 
  for (i = 0U; i < 64U; i++){
-  rrpge_m_stat_set(obj, i, obj->apph[i]);
+  rrpge_m_stat_set(obj, i, obj->app->apph[i]);
  }
- rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x18U, obj->appd[0x0U]);
- rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x19U, obj->appd[0x1U]);
- rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1AU, obj->appd[0x8U]);
- rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1BU, obj->appd[0x9U]);
- rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1CU, obj->appd[0xAU]);
- rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1DU, obj->appd[0xBU]);
+ rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x18U, obj->app->appd[0x0U]);
+ rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x19U, obj->app->appd[0x1U]);
+ rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1AU, obj->app->appd[0x8U]);
+ rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1BU, obj->app->appd[0x9U]);
+ rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1CU, obj->app->appd[0xAU]);
+ rrpge_m_stat_set(obj, RRPGE_STA_VARS + 0x1DU, obj->app->appd[0xBU]);
 }
 
 
@@ -1192,33 +1193,13 @@ static void rrpge_m_ires_red(uint32* d, auint off)
 
 
 
-/* Initializes starting resources for an RRPGE emulator object after an
-** application was loaded. This should be used before starting emulation or
-** when resetting it. Does not depend on state correctness, so a state check
-** is not necessary before calling. */
-void rrpge_m_ires_init(rrpge_object_t* obj)
+/* Populates the PRAM's initial and boot data blocks (above 0xF7800) over
+** zero filled memory. */
+static void rrpge_m_ires_initpram(uint32* p)
 {
  auint   i;
  auint   j;
  auint   r;
- uint32 *p = &(obj->st.pram[0]);
-
-
- /* Reset memories */
-
- for (i = 0U; i < (sizeof(obj->dini   ) / sizeof(obj->dini[0]   )); i++){
-  obj->st.dram[i] = obj->dini[i];
- }
- for (      ; i < (sizeof(obj->st.dram) / sizeof(obj->st.dram[0])); i++){
-  obj->st.dram[i] = 0U;
- }
-
- for (i = 0U; i < RRPGE_M_PRAMS; i++){
-  p[i] = 0U;
- }
-
- rrpge_m_ires_initstat(obj);
-
 
  /* Populate Peripheral RAM with initial data blocks */
 
@@ -1360,8 +1341,155 @@ void rrpge_m_ires_init(rrpge_object_t* obj)
  for (i = 0U; i < 400U; i++){
   p[0xF8000U + (i * 4U) + 1U] = 0x00000400U + (i * 0x500000U);
  }
+}
+
 
 
+/* Resets the memories (PRAM and Data memory). If there are pages not
+** written since the last reset, only the written pages are restored (and
+** marked dirty), otherwise the memories are rewritten as a whole. The zero
+** areas (PRAM and the Data memory above the initial data) are left alone
+** then if they are still zero from the zero filling allocator, and are
+** released to the host if it provided a releaser, so their pages need not
+** be committed until used. Returns nonzero if the PRAM's data blocks have
+** to be populated (some of their pages were restored). */
+static auint rrpge_m_ires_initmem(rrpge_object_t* obj)
+{
+ auint   i;
+ auint   j;
+ auint   pop = 0U;
+ uint32 *p = &(obj->st.pram[0]);
+ uint16 *d = &(obj->st.dram[0]);
+
+ if (!rrpge_m_drty_rstall(obj)){
+
+  for (i = 0U; i < (RRPGE_M_PRAMS >> 8); i++){
+   if ((obj->rstp[i >> 5] & (0x80000000U >> (i & 0x1FU))) != 0U){
+    for (j = 0U; j < 256U; j++){ p[(i << 8) + j] = 0U; }
+    rrpge_m_drty_pram(obj, i << 8);
+    if (i >= (0xF7800U >> 8)){ pop = 1U; }
+   }
+  }
+
+  for (i = 0U; i < (RRPGE_M_DRTY_DRAMS >> 8); i++){
+   if ((obj->rstd[i >> 5] & (0x80000000U >> (i & 0x1FU))) != 0U){
+    if (i < (sizeof(obj->app->dini) / (sizeof(obj->app->dini[0]) << 8))){
+     for (j = 0U; j < 256U; j++){ d[(i << 8) + j] = obj->app->dini[(i << 8) + j]; }
+    }else{
+     for (j = 0U; j < 256U; j++){ d[(i << 8) + j] = 0U; }
+    }
+    rrpge_m_drty_dram(obj, i << 8);
+   }
+  }
+
+  rrpge_m_drty_rstclr(obj);
+  return pop;
+
+ }
+
+ for (i = 0U; i < (sizeof(obj->app->dini) / sizeof(obj->app->dini[0])); i++){
+  d[i] = obj->app->dini[i];
+ }
+
+ if (obj->mzr){
+
+  obj->mzr = 0U;
+
+ }else if ( (rrpge_m_alloc_lzy(obj)) &&
+            (rrpge_m_rels != RRPGE_M_NULL) ){
+
+  rrpge_m_rels(&(d[i]), sizeof(obj->st.dram) - (i * sizeof(d[0])));
+  rrpge_m_rels(p, RRPGE_M_PRAMS * sizeof(p[0]));
+
+ }else{
+
+  for (      ; i < RRPGE_M_DRTY_DRAMS; i++){
+   d[i] = 0U;
+  }
+  for (i = 0U; i < RRPGE_M_PRAMS; i++){
+   p[i] = 0U;
+  }
+
+ }
+
+ rrpge_m_drty_all(obj);
+ rrpge_m_drty_rstclr(obj);
+ return 1U;
+}
+
+
+
+/* Initializes the memories (PRAM and Data memory) of a new emulator object
+** from those of an other object using the same application, as part of
+** cloning it. Only the pages the source wrote since its last reset are
+** copied, the rest are initialized like a reset would: if the new object
+** was allocated by the zero filling allocator, its zero areas are left
+** alone, so their pages need not be committed until used. */
+void rrpge_m_ires_clonemem(rrpge_object_t* obj, rrpge_object_t const* src)
+{
+ auint   i;
+ auint   j;
+ auint   all = rrpge_m_drty_rstall(src);
+ uint32 *p = &(obj->st.pram[0]);
+ uint16 *d = &(obj->st.dram[0]);
+
+ /* Reset contents, unless all pages are copied */
+
+ if (!all){
+  for (i = 0U; i < (sizeof(obj->app->dini) / sizeof(obj->app->dini[0])); i++){
+   d[i] = obj->app->dini[i];
+  }
+  if (!rrpge_m_alloc_lzy(obj)){
+   for (      ; i < RRPGE_M_DRTY_DRAMS; i++){
+    d[i] = 0U;
+   }
+   for (i = 0U; i < RRPGE_M_PRAMS; i++){
+    p[i] = 0U;
+   }
+  }
+  rrpge_m_ires_initpram(p);
+ }
+
+ /* Pages written by the source since its reset */
+
+ for (i = 0U; i < (RRPGE_M_PRAMS >> 8); i++){
+  if ( all ||
+       ((src->rstp[i >> 5] & (0x80000000U >> (i & 0x1FU))) != 0U) ){
+   for (j = 0U; j < 256U; j++){ p[(i << 8) + j] = src->st.pram[(i << 8) + j]; }
+  }
+ }
+ for (i = 0U; i < (RRPGE_M_DRTY_DRAMS >> 8); i++){
+  if ( all ||
+       ((src->rstd[i >> 5] & (0x80000000U >> (i & 0x1FU))) != 0U) ){
+   for (j = 0U; j < 256U; j++){ d[(i << 8) + j] = src->st.dram[(i << 8) + j]; }
+  }
+ }
+
+ /* All pages are dirty for the host, and the same pages need restoring on
+ ** the next reset as in the source */
+
+ rrpge_m_drty_all(obj);
+ for (i = 0U; i < 128U; i++){ obj->rstp[i] = src->rstp[i]; }
+ for (i = 0U; i <  12U; i++){ obj->rstd[i] = src->rstd[i]; }
+ obj->mzr = 0U;
+}
+
+
+
+/* Initializes starting resources for an RRPGE emulator object after an
+** application was loaded. This should be used before starting emulation or
+** when resetting it. Does not depend on state correctness, so a state check
+** is not necessary before calling. */
+void rrpge_m_ires_init(rrpge_object_t* obj)
+{
+ /* Reset memories */
+
+ if (rrpge_m_ires_initmem(obj)){
+  rrpge_m_ires_initpram(&(obj->st.pram[0]));
+ }
+
+ rrpge_m_ires_initstat(obj);
+
  /* Prepare emulation library specific flags for a proper start */
 
  rrpge_m_ires_initl(obj);
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2014.11.06
+**  \date      2015.10.12
 */
 
 
@@ -39,4 +39,11 @@ void rrpge_m_ires_initstat(rrpge_object_t* obj);
 void rrpge_m_ires_init(rrpge_object_t* obj);
 
 
+/* Initializes the memories (PRAM and Data memory) of a new emulator object
+** from those of an other object using the same application, as part of
+** cloning it. Only the pages the source wrote since its last reset are
+** copied, the rest are initialized like a reset would. */
+void rrpge_m_ires_clonemem(rrpge_object_t* obj, rrpge_object_t const* src);
+
+
 #endif
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.04
+**  \date      2015.10.11
 */
 
 
@@ -16,26 +16,29 @@
 #include "rgm_task.h"
 #include "rgm_halt.h"
 #include "rgm_dev.h"
+#include "rgm_drty.h"
+#include "rgm_rlog.h"
+#include "rgm_vidl.h"
 
 
 
 /* Finds empty kernel task slot and populates & allocates it. Fills in resl
 ** according to the result. Returns nonzero if the  parameters don't make a
 ** valid task. (does not check parameter count!) */
-static auint rrpge_m_ktsalloc(uint16 const* par, auint n, auint* resl)
+static auint rrpge_m_ktsalloc(rrpge_object_t* hnd, uint16 const* par, auint n, auint* resl)
 {
  auint i;
  auint j;
  for (i = RRPGE_STA_KTASK; i < (RRPGE_STA_KTASK + 0x100U); i += 0x10U){
-  if ((rrpge_m_edat->st.stat[i + 0xFU] & 0xFFFFU) == 0U){
+  if ((hnd->st.stat[i + 0xFU] & 0xFFFFU) == 0U){
    for (j = 0U; j < n; j++){
-    rrpge_m_edat->st.stat[i + j] = par[j] & 0xFFFFU;
+    hnd->st.stat[i + j] = par[j] & 0xFFFFU;
    }
-   rrpge_m_edat->st.stat[i + 0xFU] = 0x0001U;
-   j = ((i - 0xD80U) >> 4);
-   rrpge_m_edat->tsfl &= ~((auint)(1U) << j); /* Task not started yet! */
+   hnd->st.stat[i + 0xFU] = 0x0001U;
+   j = ((i - RRPGE_STA_KTASK) >> 4);
+   hnd->tsfl &= ~((auint)(1U) << j); /* Task not started yet! */
    *resl = j;                                 /* Fill in result */
-   return rrpge_m_taskcheck(&(rrpge_m_edat->st.stat[0]), j);
+   return rrpge_m_taskcheck(&(hnd->st.stat[0]), j);
   }
  }
  *resl = 0x8000U;
@@ -52,12 +55,12 @@ static auint rrpge_m_ktsalloc(uint16 const* par, auint n, auint* resl)
 ** necessary for performing the call. The return value is produced in
 ** resh:resl (16 bits each), the original value retained if the specification
 ** does not specify a return. */
-auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
+auint rrpge_m_kcall(rrpge_object_t* hnd, uint16 const* par, auint n, auint* resh, auint* resl)
 {
  auint   i;
  auint   o;
  auint   r;       /* Return: Cycles consumed */
- uint16* stat = &(rrpge_m_edat->st.stat[0]);
+ uint16* stat = &(hnd->st.stat[0]);
  rrpge_cbp_setpal_t    cbp_setpal;
  rrpge_cbp_setst3d_t   cbp_setst3d;
  rrpge_cbp_getlocal_t  cbp_getlocal;
@@ -78,7 +81,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 800U;
    goto ret_callback;
 
@@ -89,7 +92,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 800U;
    goto ret_callback;
 
@@ -100,7 +103,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 800U;
    goto ret_callback;
 
@@ -111,7 +114,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 800U;
    goto ret_callback;
 
@@ -122,7 +125,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 800U;
    goto ret_callback;
 
@@ -136,7 +139,8 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
    cbp_setpal.id  = par[1] & 0xFFU;
    cbp_setpal.col = par[2] & 0xFFFU;
    stat[RRPGE_STA_PAL + cbp_setpal.id] = cbp_setpal.col;
-   rrpge_m_edat->cb_sub[RRPGE_CB_SETPAL](rrpge_m_edat, &cbp_setpal);
+   rrpge_m_vidl_setpal(hnd, cbp_setpal.id);
+   hnd->cb_sub[RRPGE_CB_SETPAL](hnd, &cbp_setpal);
 
    r = 100U;
    goto ret_callback;
@@ -150,7 +154,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
 
    cbp_setst3d.mod = par[1] & 0x7U;
    stat[RRPGE_STA_VARS + 0x17U] = cbp_setst3d.mod;
-   rrpge_m_edat->cb_sub[RRPGE_CB_SETST3D](rrpge_m_edat, &cbp_setst3d);
+   hnd->cb_sub[RRPGE_CB_SETST3D](hnd, &cbp_setst3d);
 
    r = 2400U;
    goto ret_callback;
@@ -162,7 +166,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_dev_req(rrpge_m_edat, par[1] & 0xFU, par[2] & 0xFU) == 0U){
+   if (rrpge_m_dev_req(hnd, par[1] & 0xFU, par[2] & 0xFU) == 0U){
     *resl = 0U;
    }else{
     *resl = 1U;
@@ -178,7 +182,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   rrpge_m_dev_drop(rrpge_m_edat, par[1] & 0xFU);
+   rrpge_m_dev_drop(hnd, par[1] & 0xFU);
 
    r = 800U;
    break;
@@ -190,7 +194,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   i = rrpge_m_dev_pop(rrpge_m_edat);
+   i = rrpge_m_dev_pop(hnd);
    *resh = (i >> 16) & 0xFFFFU;
    *resl = (i      ) & 0xFFFFU;
 
@@ -204,7 +208,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   i = rrpge_m_dev_peek(rrpge_m_edat);
+   i = rrpge_m_dev_peek(hnd);
    *resh = (i >> 16) & 0xFFFFU;
    *resl = (i      ) & 0xFFFFU;
 
@@ -218,7 +222,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   rrpge_m_dev_flush(rrpge_m_edat);
+   rrpge_m_dev_flush(hnd);
 
    r = 800U;
    break;
@@ -230,7 +234,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   r = (par[1] & 0xFFFFU) - (rrpge_m_prng() & 0x3FFU); /* 1024 cycle jitter */
+   r = (par[1] & 0xFFFFU) - (rrpge_m_prng(hnd) & 0x3FFU); /* 1024 cycle jitter */
    if (r > (par[1] & 0xFFFFU)){ r = 0U;   }            /* Underflow */
    if (r < 200U){               r = 200U; }            /* Minimal consumed cycles */
    break;
@@ -246,8 +250,12 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   cbp_getlocal.buf = &rrpge_m_edat->st.dram[par[1] & 0xFFFFU];
-   rrpge_m_edat->cb_sub[RRPGE_CB_GETLOCAL](rrpge_m_edat, &cbp_getlocal);
+   cbp_getlocal.buf = &hnd->st.dram[par[1] & 0xFFFFU];
+   if (!rrpge_m_rlog_isplay(hnd)){
+    hnd->cb_sub[RRPGE_CB_GETLOCAL](hnd, &cbp_getlocal);
+   }
+   rrpge_m_rlog_kcall(hnd, RRPGE_CB_GETLOCAL, RRPGE_M_NULL, cbp_getlocal.buf, 32U);
+   rrpge_m_drty_dram_rng(hnd, par[1] & 0xFFFFU, 32U);
 
    r = 2400U;
    goto ret_callback;
@@ -259,7 +267,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 1200U;
    goto ret_callback;
 
@@ -271,7 +279,10 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
    }
 
    cbp_getlang.lno = par[1] & 0xFFFFU;
-   *resl = rrpge_m_edat->cb_fun[RRPGE_CB_GETLANG](rrpge_m_edat, &cbp_getlang);
+   if (!rrpge_m_rlog_isplay(hnd)){
+    *resl = hnd->cb_fun[RRPGE_CB_GETLANG](hnd, &cbp_getlang);
+   }
+   rrpge_m_rlog_kcall(hnd, RRPGE_CB_GETLANG, resl, RRPGE_M_NULL, 0U);
    *resh = *resl >> 16;
 
    r = 2400U;
@@ -284,7 +295,10 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   *resl = rrpge_m_edat->cb_fun[RRPGE_CB_GETCOLORS](rrpge_m_edat, RRPGE_M_NULL);
+   if (!rrpge_m_rlog_isplay(hnd)){
+    *resl = hnd->cb_fun[RRPGE_CB_GETCOLORS](hnd, RRPGE_M_NULL);
+   }
+   rrpge_m_rlog_kcall(hnd, RRPGE_CB_GETCOLORS, resl, RRPGE_M_NULL, 0U);
    *resh = *resl >> 16;
 
    r = 2400U;
@@ -297,7 +311,10 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   *resl = rrpge_m_edat->cb_fun[RRPGE_CB_GETST3D](rrpge_m_edat, RRPGE_M_NULL) & 1U;
+   if (!rrpge_m_rlog_isplay(hnd)){
+    *resl = hnd->cb_fun[RRPGE_CB_GETST3D](hnd, RRPGE_M_NULL) & 1U;
+   }
+   rrpge_m_rlog_kcall(hnd, RRPGE_CB_GETST3D, resl, RRPGE_M_NULL, 0U);
 
    r = 2400U;
    goto ret_callback;
@@ -309,7 +326,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 2400U;
    goto ret_callback;
 
@@ -328,37 +345,39 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   /* Note: No validity checking in rrpge_m_edat. These elements are
+   /* Note: No validity checking in the emulation instance. These elements are
    ** maintained by the library, they shouldn't be wrong. */
 
-   rrpge_m_edat->reir &= 0x3FU; /* Some sanity masks to always prevent */
-   rrpge_m_edat->reiw &= 0x3FU; /* addressing out of array */
-   rrpge_m_edat->rebr &= 0xFFFU;
-   rrpge_m_edat->rebw &= 0xFFFU;
+   hnd->reir &= 0x3FU; /* Some sanity masks to always prevent */
+   hnd->reiw &= 0x3FU; /* addressing out of array */
+   hnd->rebr &= 0xFFFU;
+   hnd->rebw &= 0xFFFU;
 
-   if ((rrpge_m_edat->reir) == (rrpge_m_edat->reiw)){ /* No packet */
+   if ((hnd->reir) == (hnd->reiw)){ /* No packet */
 
     *resl = 0U;
 
    }else{                                             /* There are packets */
 
-    rrpge_m_edat->recl[rrpge_m_edat->reir] &= 0xFFFU; /* Sanity mask */
+    hnd->recl[hnd->reir] &= 0xFFFU; /* Sanity mask */
 
-    r = rrpge_m_edat->reir;
+    r = hnd->reir;
     for (i = 0U; i < 8U; i++){  /* Copy user ID data into target */
-     rrpge_m_edat->st.dram[(par[3] & 0xFFFFU) + i] = rrpge_m_edat->reci[(r << 3) + i];
+     hnd->st.dram[(par[3] & 0xFFFFU) + i] = hnd->reci[(r << 3) + i];
     }
+    rrpge_m_drty_dram_rng(hnd, par[3] & 0xFFFFU, 8U);
 
-    r = rrpge_m_edat->recl[r];
+    r = hnd->recl[r];
     if (r > (par[2] & 0xFFFFU)){ r = par[2] & 0xFFFFU; }
     for (i = 0U; i < r; i++){   /* Copy packet data */
-     rrpge_m_edat->st.dram[(par[1] & 0xFFFFU) + i] = rrpge_m_edat->recb[rrpge_m_edat->rebr];
-     rrpge_m_edat->rebr = (rrpge_m_edat->rebr + 1U) & 0xFFFU;
+     hnd->st.dram[(par[1] & 0xFFFFU) + i] = hnd->recb[hnd->rebr];
+     hnd->rebr = (hnd->rebr + 1U) & 0xFFFU;
     }
+    rrpge_m_drty_dram_rng(hnd, par[1] & 0xFFFFU, r);
 
     *resl = r;     /* A: the length of the packet */
 
-    rrpge_m_edat->reir = (rrpge_m_edat->reir + 1U) & 0x3FU;
+    hnd->reir = (hnd->reir + 1U) & 0x3FU;
 
    }
 
@@ -372,7 +391,7 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
     goto fault_inv;
    }
 
-   if (rrpge_m_ktsalloc(par, n, resl) != 0U){ goto fault_inv; }
+   if (rrpge_m_ktsalloc(hnd, par, n, resl) != 0U){ goto fault_inv; }
    r = 2400U;
    goto ret_callback;
 
@@ -450,12 +469,12 @@ auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl)
 
 ret_callback:     /* Return after servicing a callback */
 
- rrpge_m_halt_set(rrpge_m_edat, RRPGE_HLT_CALLBACK);
+ rrpge_m_halt_set(hnd, RRPGE_HLT_CALLBACK);
  return r;
 
 fault_inv:        /* Return with invalid kernel call */
 
- rrpge_m_halt_set(rrpge_m_edat, RRPGE_HLT_INVKCALL);
+ rrpge_m_halt_set(hnd, RRPGE_HLT_INVKCALL);
  return 0;
 
 }
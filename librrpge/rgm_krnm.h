@@ -24,7 +24,7 @@
 ** necessary for performing the call. The return value is produced in
 ** resh:resl (16 bits each), the original value retained if the specification
 ** does not specify a return. */
-auint rrpge_m_kcall(uint16 const* par, auint n, auint* resh, auint* resl);
+auint rrpge_m_kcall(rrpge_object_t* hnd, uint16 const* par, auint n, auint* resh, auint* resl);
 
 
 #endif
@@ -6,16 +6,18 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.16
+**  \date      2015.10.12
 */
 
 
 #include "rgm_main.h"
 #include "rgm_ires.h"
+#include "rgm_snap.h"
 #include "rgm_chk.h"
 #include "rgm_cb.h"
 #include "rgm_ser.h"
 #include "rgm_halt.h"
+#include "rgm_stat.h"
 #include "rgm_cpu.h"
 #include "rgm_pram.h"
 #include "rgm_vid.h"
@@ -23,6 +25,15 @@
 #include "rgm_dev.h"
 #include "rgm_mix.h"
 #include "rgm_aud.h"
+#include "rgm_task.h"
+#include "rgm_drty.h"
+#include "rgm_rlog.h"
+
+
+
+/* State of building the library's tables by rrpge_init_lib(): 0: Not
+** built, 1: Being built (by another thread), 2: Built */
+static auint rrpge_m_isinit = 0U;
 
 
 
@@ -32,6 +43,17 @@ void rrpge_init_lib(rrpge_malloc_t* alc, rrpge_free_t* fre)
  rrpge_m_malloc = alc;
  rrpge_m_free = fre;
 
+ /* The state handler table and the components' tables are only built once,
+ ** they are read only afterwards. If called concurrently, only one call
+ ** builds them, the others wait for it to complete. */
+
+ if (!RRPGE_M_ATOMIC_CAS(rrpge_m_isinit, 0U, 1U)){
+  while (((volatile auint*)(&rrpge_m_isinit))[0] != 2U){}
+  RRPGE_M_ATOMIC_SYNC();
+  return;
+ }
+
+ rrpge_m_stat_init();
  rrpge_m_cpu_init();
  rrpge_m_pram_init();
  rrpge_m_vid_init();
@@ -39,6 +61,49 @@ void rrpge_init_lib(rrpge_malloc_t* alc, rrpge_free_t* fre)
  rrpge_m_dev_init();
  rrpge_m_mix_init();
  rrpge_m_aud_init();
+
+ RRPGE_M_ATOMIC_SYNC();
+ ((volatile auint*)(&rrpge_m_isinit))[0] = 2U;
+}
+
+
+
+/* Set up zero filling allocator - implementation of RRPGE library function */
+void rrpge_init_mem(rrpge_malloc_t* alz, rrpge_free_t* frz, rrpge_release_t* rel)
+{
+ if ((alz == RRPGE_M_NULL) || (frz == RRPGE_M_NULL)){
+  rrpge_m_malz = RRPGE_M_NULL;
+  rrpge_m_frez = RRPGE_M_NULL;
+  rrpge_m_rels = RRPGE_M_NULL;
+ }else{
+  rrpge_m_malz = alz;
+  rrpge_m_frez = frz;
+  rrpge_m_rels = rel;
+ }
+}
+
+
+
+/* Allocates a new application image with a single reference. Returns NULL
+** if the allocation failed. */
+static rrpge_app_t* rrpge_m_app_new(void)
+{
+ rrpge_app_t* app;
+
+ app = rrpge_m_alloc(sizeof(rrpge_app_t), RRPGE_M_OBJ_APP);
+ if (app == RRPGE_M_NULL){ return RRPGE_M_NULL; }
+ app->ref = 1U;
+
+ return app;
+}
+
+
+
+/* Releases a reference to an application image, freeing it if it was the
+** last one. */
+static void rrpge_m_app_release(rrpge_app_t* app)
+{
+ if (RRPGE_M_ATOMIC_DEC(app->ref) == 0U){ rrpge_m_alloc_free(app); }
 }
 
 
@@ -46,31 +111,73 @@ void rrpge_init_lib(rrpge_malloc_t* alc, rrpge_free_t* fre)
 /* Delete library object - implementation of RRPGE library function */
 void rrpge_delete(void* obj)
 {
- rrpge_m_free(obj);
+ if (obj == RRPGE_M_NULL){ return; }
+
+ if (rrpge_m_alloc_typ(obj) == RRPGE_M_OBJ_APP){
+  rrpge_m_app_release(obj);
+  return;
+ }
+
+ if (rrpge_m_alloc_typ(obj) == RRPGE_M_OBJ_EMU){
+  if (((rrpge_object_t*)(obj))->cprf != RRPGE_M_NULL){
+   rrpge_m_alloc_free(((rrpge_object_t*)(obj))->cprf);
+  }
+  rrpge_m_rlog_free((rrpge_object_t*)(obj));
+  rrpge_m_cpu_decode_free((rrpge_object_t*)(obj));
+  rrpge_m_app_release(((rrpge_object_t*)(obj))->app);
+ }
+
+ rrpge_m_alloc_free(obj);
 }
 
 
 
-/* Initialize emulator - implementation of RRPGE library function */
-rrpge_object_t* rrpge_new_emu(rrpge_cbpack_t const* cb)
+/* Creates a new emulator instance over the given application image, taking
+** over the reference to it. The instance needs initialization. Returns NULL
+** if the allocation failed (the reference is not taken over then). */
+static rrpge_object_t* rrpge_m_new_obj(rrpge_cbpack_t const* cb, rrpge_app_t* app)
 {
  rrpge_object_t* hnd;
 
  /* Allocate memory for emulator instance */
 
- hnd = rrpge_m_malloc(sizeof(rrpge_object_t));
+ hnd = rrpge_m_alloc(sizeof(rrpge_object_t), RRPGE_M_OBJ_EMU | RRPGE_M_OBJ_LZY);
  if (hnd == RRPGE_M_NULL){ return RRPGE_M_NULL; }
+ hnd->app  = app;
+ hnd->cdec = &(app->cdec[0]);
+
+ /* If allocated by the zero filling allocator, the memories are zero, so
+ ** they need not be cleared (committed) by the first reset */
+
+ hnd->mzr = rrpge_m_alloc_lzy(hnd);
 
  /* Add callbacks */
 
  rrpge_m_cb_process(hnd, cb);
 
+ /* No input log, and line rendering */
+
+ hnd->rlg = RRPGE_M_NULL;
+ rrpge_setframe(hnd, RRPGE_M_NULL, 0U, RRPGE_PIX_IDX8, RRPGE_M_NULL);
+
  /* Init halt cause and initialization state machine */
 
  hnd->insm = 0x0U;
  hnd->inss = RRPGE_INI_BLANK;
+ hnd->prng = 0U;
  rrpge_m_halt_set(hnd, RRPGE_HLT_WAIT);
 
+ /* Native User Library routines and profiling are OFF by default, the
+ ** profile is only allocated when profiling is enabled */
+
+ hnd->cpu.hle = 0U;
+ hnd->cpu.prf = 0U;
+ hnd->cprf = RRPGE_M_NULL;
+
+ /* Memory contents are undefined, so all pages are dirty */
+
+ rrpge_m_drty_all(hnd);
+
  /* OK proper return */
 
  return hnd;
@@ -78,12 +185,153 @@ rrpge_object_t* rrpge_new_emu(rrpge_cbpack_t const* cb)
 
 
 
+/* Finishes initialization once the application image is complete, so
+** emulation may start. */
+static void rrpge_m_init_fin(rrpge_object_t* hnd)
+{
+ auint i;
+
+ /* Clear all breakpoints, using the application image's decoded code */
+ for (i = 0U; i < 2048U; i++){ hnd->brkp[i] = 0U; }
+ rrpge_m_cpu_decode_free(hnd);
+
+ /* Reset state reached */
+ hnd->inss = RRPGE_INI_RESET;
+
+ /* The memories may hold the data of a previously loaded application, so
+ ** the reset has to rewrite them as a whole, not only the pages written
+ ** since the last reset. */
+ rrpge_m_drty_all(hnd);
+
+ /* Do a reset to finish the initialization so emulation may start. */
+ rrpge_reset(hnd);
+}
+
+
+
+/* Initialize emulator - implementation of RRPGE library function */
+rrpge_object_t* rrpge_new_emu(rrpge_cbpack_t const* cb)
+{
+ rrpge_app_t*    app;
+ rrpge_object_t* hnd;
+
+ app = rrpge_m_app_new();
+ if (app == RRPGE_M_NULL){ return RRPGE_M_NULL; }
+
+ hnd = rrpge_m_new_obj(cb, app);
+ if (hnd == RRPGE_M_NULL){ rrpge_m_app_release(app); }
+
+ return hnd;
+}
+
+
+
+/* Initialize emulator over application image - implementation of RRPGE
+** library function */
+rrpge_object_t* rrpge_new_emu_app(rrpge_cbpack_t const* cb, rrpge_app_t* app)
+{
+ rrpge_object_t* hnd;
+
+ RRPGE_M_ATOMIC_INC(app->ref);
+
+ hnd = rrpge_m_new_obj(cb, app);
+ if (hnd == RRPGE_M_NULL){
+  rrpge_m_app_release(app);
+  return RRPGE_M_NULL;
+ }
+
+ /* The application image was loaded and checked already, only the steps of
+ ** initialization following the loads are necessary. */
+
+ rrpge_m_ires_initstat(hnd);
+ rrpge_m_init_fin(hnd);
+
+ return hnd;
+}
+
+
+
+/* Get application image - implementation of RRPGE library function */
+rrpge_app_t* rrpge_getapp(rrpge_object_t* hnd)
+{
+ /* The application has to be loaded, and initialization not in progress */
+
+ if ((hnd->inss != RRPGE_INI_RESET) || (hnd->insm != 0U)){ return RRPGE_M_NULL; }
+
+ RRPGE_M_ATOMIC_INC(hnd->app->ref);
+
+ return hnd->app;
+}
+
+
+
+/* Clone emulator - implementation of RRPGE library function */
+rrpge_object_t* rrpge_clone(rrpge_object_t* hnd)
+{
+ rrpge_object_t* nhd;
+ auint i;
+
+ /* The application has to be loaded, and initialization not in progress */
+
+ if ((hnd->inss != RRPGE_INI_RESET) || (hnd->insm != 0U)){ return RRPGE_M_NULL; }
+
+ /* Allocate memory for emulator instance */
+
+ nhd = rrpge_m_alloc(sizeof(rrpge_object_t), RRPGE_M_OBJ_EMU | RRPGE_M_OBJ_LZY);
+ if (nhd == RRPGE_M_NULL){ return RRPGE_M_NULL; }
+
+ /* Share the application image and its decoded code: breakpoints are not
+ ** copied, so the clone needs no decoded code of its own */
+
+ nhd->app  = hnd->app;
+ nhd->cdec = &(hnd->app->cdec[0]);
+ RRPGE_M_ATOMIC_INC(nhd->app->ref);
+ for (i = 0U; i < 2048U; i++){ nhd->brkp[i] = 0U; }
+
+ /* Callbacks and host set properties. The profile is not shared: if the
+ ** source is profiling, the clone starts with an empty profile of its own.
+ ** The input log belongs to the source instance. */
+
+ nhd->cb_lin = hnd->cb_lin;
+ for (i = 0U; i < RRPGE_CB_IDRANGE; i++){
+  nhd->cb_tsk[i] = hnd->cb_tsk[i];
+  nhd->cb_sub[i] = hnd->cb_sub[i];
+  nhd->cb_fun[i] = hnd->cb_fun[i];
+ }
+ nhd->cpu.hle = hnd->cpu.hle;
+ nhd->cpu.prf = 0U;
+ nhd->cprf = RRPGE_M_NULL;
+ if (hnd->cpu.prf != 0U){ rrpge_enaprofile(nhd, 1U); }
+ nhd->rlg = RRPGE_M_NULL;
+
+ /* Emulation state: the Application state and the component state are
+ ** copied, of the memories only what the source changed since its reset. */
+
+ for (i = 0U; i < (sizeof(hnd->st.stat) / sizeof(hnd->st.stat[0])); i++){
+  nhd->st.stat[i] = hnd->st.stat[i];
+ }
+ rrpge_m_ires_clonemem(nhd, hnd);
+ rrpge_m_snap_cmp_copy(nhd, hnd);
+ nhd->insm = hnd->insm;
+ nhd->inss = hnd->inss;
+
+ /* The frame buffer belongs to the source instance (this needs the palette
+ ** in the Application state) */
+
+ rrpge_setframe(nhd, RRPGE_M_NULL, 0U, RRPGE_PIX_IDX8, RRPGE_M_NULL);
+
+ return nhd;
+}
+
+
+
 /* Run initialization - implementation of RRPGE library function */
 rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
 {
  auint   f;
  auint   i;
  uint16* p;
+ rrpge_app_t* app;
  rrpge_cbp_loadbin_t cbp_loadbin;
 
  /* Select initialization target */
@@ -100,6 +348,17 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
 
  if (hnd->insm == 0x1U){  /* Initialization start */
 
+  /* The application image is written by loading, so if it is shared with
+  ** other instances (see rrpge_clone()), this instance needs a new one. */
+  if (hnd->app->ref != 1U){
+   app = rrpge_m_app_new();
+   if (app == RRPGE_M_NULL){ return RRPGE_ERR_UNK; }
+   rrpge_m_cpu_decode_free(hnd);
+   rrpge_m_app_release(hnd->app);
+   hnd->app  = app;
+   hnd->cdec = &(app->cdec[0]);
+  }
+
   hnd->inss = RRPGE_INI_BLANK; /* Blank state reached */
 
   if (tg == RRPGE_INI_BLANK){ /* No initialization needed, return */
@@ -108,7 +367,7 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
   }
 
   /* Load the application header */
-  cbp_loadbin.buf = &(hnd->apph[0]);
+  cbp_loadbin.buf = &(hnd->app->apph[0]);
   cbp_loadbin.scw = 64U;
   cbp_loadbin.sow = 0U;
   hnd->cb_tsk[RRPGE_CB_LOADBIN](hnd, 0U, &cbp_loadbin);
@@ -124,11 +383,11 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
 
  if (hnd->insm == 0x3U){  /* Start loading application descriptor */
 
-  f = rgm_chk_checkapphead(&(hnd->apph[0]), &i); /* Needed to retrieve descriptor offset */
+  f = rgm_chk_checkapphead(&(hnd->app->apph[0]), &i); /* Needed to retrieve descriptor offset */
   if (f != RRPGE_ERR_OK){ return f; }
 
   /* Load the application descriptor (12 words) */
-  cbp_loadbin.buf = &(hnd->appd[0]);
+  cbp_loadbin.buf = &(hnd->app->appd[0]);
   cbp_loadbin.scw = 12U;
   cbp_loadbin.sow = i;
   hnd->cb_tsk[RRPGE_CB_LOADBIN](hnd, 0U, &cbp_loadbin);
@@ -157,8 +416,8 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
 
   /* Load code area */
   rrpge_m_ires_initcode(hnd);
-  p = &(hnd->appd[0]);
-  cbp_loadbin.buf = &(hnd->crom[0]);
+  p = &(hnd->app->appd[0]);
+  cbp_loadbin.buf = &(hnd->app->crom[0]);
   cbp_loadbin.scw = ((p[0x6U] - 1U) & 0xFFFFU) + 1U;
   cbp_loadbin.sow = ((p[0x2U] & 0xFFFFU) << 16) + (p[0x3U] & 0xFFFFU);
   if ( (cbp_loadbin.scw + cbp_loadbin.sow) >
@@ -178,14 +437,14 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
 
  if (hnd->insm == 0x7U){  /* Check and start loading data */
 
-  p = &(hnd->appd[0]);
+  p = &(hnd->app->appd[0]);
   if (p[0x7U] > 0xFFC0U){
    return (RRPGE_ERR_DSC + 0x7U); /* Data wraparound */
   }
   rrpge_m_ires_initdata(hnd);     /* Reset data memory initializer */
 
   /* Load data area */
-  cbp_loadbin.buf = &(hnd->dini[0x40U]);
+  cbp_loadbin.buf = &(hnd->app->dini[0x40U]);
   cbp_loadbin.scw = ((p[0x7U] & 0xFFFFU));
   cbp_loadbin.sow = ((p[0x4U] & 0xFFFFU) << 16) + (p[0x5U] & 0xFFFFU);
   if ( (cbp_loadbin.scw + cbp_loadbin.sow) >
@@ -205,14 +464,13 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
 
  if (hnd->insm == 0x9U){  /* Finalize */
 
-  /* Clear all breakpoints */
-  for (i = 0U; i < 2048U; i++){ hnd->brkp[i] = 0U; }
-
-  /* Reset state reached */
-  hnd->inss = RRPGE_INI_RESET;
+  /* The application image is complete, pre-decode its code for the CPU
+  ** emulation */
+  hnd->app->sum = rrpge_m_app_sum(hnd->app);
+  rrpge_m_cpu_decode(hnd->app);
 
-  /* Do a reset to finish the initialization so emulation may start. */
-  rrpge_reset(hnd);
+  /* Reset so emulation may start. */
+  rrpge_m_init_fin(hnd);
 
   /* State machine ends. Halt causes are clear due to rrpge_reset() at this
   ** point. */
@@ -235,6 +493,7 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg)
 void rrpge_reset(rrpge_object_t* hnd)
 {
  if (hnd->inss != RRPGE_INI_RESET){ return; } /* No sufficient initialization */
+ if (!rrpge_m_rlog_reset(hnd)){ return; }
  rrpge_m_ires_init(hnd);
 }
 
@@ -263,11 +522,20 @@ rrpge_iuint rrpge_attachstate(rrpge_object_t* hnd)
 {
  auint f;
 
+ /* The changes can not be recorded in an input log, neither be made while
+ ** replaying one */
+
+ if (hnd->rlg != RRPGE_M_NULL){ return RRPGE_ERR_INI; }
+
  /* Check application state */
 
  f = rrpge_checkappstate(&(hnd->st.stat[0]));
  if (f != RRPGE_ERR_OK){ return f; }
 
+ /* The host might have changed anything in the memories */
+
+ rrpge_m_drty_all(hnd);
+
  /* Done */
 
  return RRPGE_ERR_OK;
@@ -291,9 +559,13 @@ void rrpge_taskend(rrpge_object_t* hnd, rrpge_iuint tsh, rrpge_iuint res)
   return;
  }
 
+ if (!rrpge_m_rlog_taskend(hnd, tsh, res)){ return; }
+
  res |= 0x8000U;
  tsh &= 0xFU;
 
+ rrpge_m_task_drty(hnd, tsh); /* The host filled the task's output areas */
+
  switch (hnd->st.stat[RRPGE_STA_KTASK + (tsh << 4)]){
 
   case 0x0100U: /* Start loading bin. page */
@@ -348,6 +620,8 @@ void rrpge_pushpacket(rrpge_object_t* hnd, rrpge_uint16 const* id,
  auint s;
  auint i;
 
+ if (!rrpge_m_rlog_packet(hnd, id, buf, len)){ return; }
+
  if (len > 4095U) return; /* This packet won't fit */
  if (len ==   0U) return; /* Zero length is not valid */
 
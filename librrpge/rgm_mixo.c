@@ -11,6 +11,7 @@
 
 
 #include "rgm_mixo.h"
+#include "rgm_drty.h"
 
 
 /* Peripheral memory size in 32bit units.
@@ -142,6 +143,7 @@ auint rrpge_m_mixo(rrpge_object_t* hnd)
  }
  pram[sdof | 1U] = (pram[sdof | 1U] & 0xFFFF0000U) |
                    (t & 0xFFFFU);
+ rrpge_m_drty_pram(hnd, sdof);
 
  /* Prepare amplitudo */
 
@@ -260,6 +262,7 @@ auint rrpge_m_mixo(rrpge_object_t* hnd)
   /* Write out destination */
 
   pram[dofh | (dofl & 0xFFFFU)] = (rsm0 << 16) | rsm1;
+  rrpge_m_drty_pram(hnd, dofh | (dofl & 0xFFFFU));
 
   /* Increment destination offset */
 
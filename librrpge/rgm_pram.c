@@ -12,6 +12,7 @@
 
 #include "rgm_pram.h"
 #include "rgm_stat.h"
+#include "rgm_drty.h"
 
 
 
@@ -128,6 +129,7 @@ RRPGE_M_FASTCALL static void  rrpge_m_pram_stat_write(rrpge_object_t* hnd, auint
  s = hnd->prm.pis;        /* Shift saved at read */
  val = (val << s);
  hnd->st.pram[hnd->prm.pia] = (hnd->prm.pid & (~m)) | (val & m);
+ rrpge_m_drty_pram(hnd, hnd->prm.pia);
 
  rrpge_m_pram_cys_add(hnd, 2U); /* Add PRAM stall cycles to Peripheral bus stall */
 }
@@ -17,15 +17,12 @@
 #define NUM2 0x4A8BU
 
 
-/* Random number generator's state */
-static auint rrpge_m_prng_s = 0U;
-
-
-/* Returns a 16bit pseudorandom number */
-auint rrpge_m_prng(void)
+/* Returns a 16bit pseudorandom number from the emulation instance's
+** generator */
+auint rrpge_m_prng(rrpge_object_t* hnd)
 {
- rrpge_m_prng_s = ( ( ((rrpge_m_prng_s >> 15) & 1U) +
-                      rrpge_m_prng_s + rrpge_m_prng_s + NUM1
-                    ) ^ NUM2) & 0xFFFFU;
- return rrpge_m_prng_s;
+ hnd->prng = ( ( ((hnd->prng >> 15) & 1U) +
+                 hnd->prng + hnd->prng + NUM1
+               ) ^ NUM2) & 0xFFFFU;
+ return hnd->prng;
 }
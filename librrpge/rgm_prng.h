@@ -16,8 +16,9 @@
 #include "rgm_info.h"
 
 
-/* Returns a 16bit pseudorandom number */
-auint rrpge_m_prng(void);
+/* Returns a 16bit pseudorandom number from the emulation instance's
+** generator */
+auint rrpge_m_prng(rrpge_object_t* hnd);
 
 
 #endif
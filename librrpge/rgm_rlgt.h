@@ -0,0 +1,47 @@
+/**
+**  \file
+**  \brief     Input log related types
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.08
+*/
+
+
+#ifndef RRPGE_M_RLGT_H
+#define RRPGE_M_RLGT_H
+
+
+#include "rgm_type.h"
+#include "rrpge_sr.h"
+
+
+/* Input log structure, allocated for an emulation instance while it is
+** recording or replaying. Components defined here are private to the input
+** log, only used by rgm_rlog.c and rgm_rlog.h. */
+typedef struct{
+
+ auint  ply;              /* Replaying if nonzero, recording otherwise */
+ auint  act;              /* The replay is applying a logged input */
+ auint  err;              /* Failed: writing, corrupt log or divergence */
+ auint  end;              /* Replay reached the end of the log */
+
+ rrpge_wrstream_t* wr;    /* Writer when recording */
+ rrpge_rdstream_t* rd;    /* Reader when replaying */
+ void*  ctx;              /* Context of the writer or reader */
+
+ auint  frm;              /* Frames since the last stamped input */
+ auint  cyc;              /* Cycles since the last frame */
+ auint  rnm;              /* Running mode of the pending rrpge_run() calls */
+ auint  rnc;              /* Count of pending rrpge_run() calls */
+
+ auint  bfp;              /* Buffer position */
+ auint  bfl;              /* Buffer fill (replaying) */
+ uint8  buf[4096U];       /* Write or read buffer */
+
+}rrpge_m_rlog_t;
+
+
+#endif
@@ -0,0 +1,745 @@
+/**
+**  \file
+**  \brief     Input log: recording and replaying emulation sessions
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.08
+**
+**
+**  Log format: a header of a 4 byte magic value, the application checksum,
+**  a checksum of the emulation state and the main clock frequency, then
+**  records until the end of the log. A record starts with a tag byte, and
+**  its fields are 16 bit words (Big Endian) or variable length numbers (7
+**  bits per byte, low bits first, bit 7 set if more follows). Stamps are
+**  the number of frames since the previous stamp, and the number of cycles
+**  since the last frame.
+*/
+
+
+#include "rgm_rlog.h"
+#include "rgm_halt.h"
+#include "rgm_task.h"
+#include "rgm_drty.h"
+
+
+/* Record tags */
+#define RRPGE_M_RLOG_RUN 0x10U /* rrpge_run() + mode; count */
+#define RRPGE_M_RLOG_AUD 0x20U /* rrpge_getaudio() */
+#define RRPGE_M_RLOG_TSK 0x30U /* Task callback; task */
+#define RRPGE_M_RLOG_RET 0x31U /* Return from task callback */
+#define RRPGE_M_RLOG_KCL 0x32U /* Kernel call; callback ID; result; count; words */
+#define RRPGE_M_RLOG_TEN 0x40U /* rrpge_taskend(); stamp; task; result; count; words */
+#define RRPGE_M_RLOG_DAD 0x41U /* rrpge_dev_add(); stamp; type */
+#define RRPGE_M_RLOG_DRM 0x42U /* rrpge_dev_rem(); stamp; device */
+#define RRPGE_M_RLOG_DPS 0x43U /* rrpge_dev_push(); stamp; device; type; count; words */
+#define RRPGE_M_RLOG_PKT 0x44U /* rrpge_pushpacket(); stamp; 8 ID words; count; words */
+#define RRPGE_M_RLOG_CLK 0x45U /* rrpge_set_clock(); stamp; clock */
+#define RRPGE_M_RLOG_RST 0x46U /* rrpge_reset(); stamp */
+
+/* Log magic value */
+static const uint8 rrpge_m_rlog_mag[4] = {0x52U, 0x50U, 0x4CU, 0x01U};
+
+
+
+/* Checksum of the emulation state (including which input devices are
+** present), so a log is only replayed from the same state it was recorded
+** from. */
+static auint rrpge_m_rlog_sum(rrpge_object_t const* hnd)
+{
+ auint i;
+ auint h = 0x811C9DC5U;
+
+ for (i = 0U; i < 1024U; i++){
+  h = ((h ^ hnd->st.stat[i]) * 0x01000193U) & 0xFFFFFFFFU;
+ }
+ for (i = 0U; i < (sizeof(hnd->st.dram) / sizeof(hnd->st.dram[0])); i++){
+  h = ((h ^ hnd->st.dram[i]) * 0x01000193U) & 0xFFFFFFFFU;
+ }
+ for (i = 0U; i < RRPGE_M_PRAMS; i++){
+  h = ((h ^ hnd->st.pram[i]) * 0x01000193U) & 0xFFFFFFFFU;
+ }
+ for (i = 0U; i < RRPGE_M_DEVT_MAX_DEV; i++){
+  h = ((h ^ hnd->dev.devo[i]) * 0x01000193U) & 0xFFFFFFFFU;
+ }
+ h = ((h ^ hnd->prng) * 0x01000193U) & 0xFFFFFFFFU;
+ h = ((h ^ hnd->kfc ) * 0x01000193U) & 0xFFFFFFFFU;
+
+ return h;
+}
+
+
+
+/* Allocates and attaches a log to an emulation instance. Returns NULL if
+** the instance is not initialized, already has a log, or the allocation
+** failed. */
+static rrpge_m_rlog_t* rrpge_m_rlog_new(rrpge_object_t* hnd)
+{
+ rrpge_m_rlog_t* rlg;
+
+ if ((hnd->inss != RRPGE_INI_RESET) || (hnd->insm != 0U)){ return RRPGE_M_NULL; }
+ if (hnd->rlg != RRPGE_M_NULL){ return RRPGE_M_NULL; }
+
+ rlg = rrpge_m_alloc(sizeof(rrpge_m_rlog_t), RRPGE_M_OBJ_RAW);
+ if (rlg == RRPGE_M_NULL){ return RRPGE_M_NULL; }
+
+ rlg->ply = 0U;
+ rlg->act = 0U;
+ rlg->err = 0U;
+ rlg->end = 0U;
+ rlg->wr  = RRPGE_M_NULL;
+ rlg->rd  = RRPGE_M_NULL;
+ rlg->ctx = RRPGE_M_NULL;
+ rlg->frm = 0U;
+ rlg->cyc = 0U;
+ rlg->rnm = 0U;
+ rlg->rnc = 0U;
+ rlg->bfp = 0U;
+ rlg->bfl = 0U;
+
+ return rlg;
+}
+
+
+
+/* Recording: returns nonzero if recording (so the input has to be logged).
+** Replaying: returns nonzero if the call comes from the replay. Without
+** input log always returns nonzero. Used to gate the entry points. */
+static auint rrpge_m_rlog_pass(rrpge_object_t const* hnd)
+{
+ if (hnd->rlg == RRPGE_M_NULL){ return 1U; }
+ if (hnd->rlg->ply == 0U){ return 1U; }
+ return hnd->rlg->act;
+}
+
+
+
+/* Recording: tells whether the input has to be logged. */
+static auint rrpge_m_rlog_isrec(rrpge_object_t const* hnd)
+{
+ return ((hnd->rlg != RRPGE_M_NULL) && (hnd->rlg->ply == 0U));
+}
+
+
+
+/* Writes out the buffer of a recording. */
+static void  rrpge_m_rlog_flush(rrpge_m_rlog_t* rlg)
+{
+ if ((rlg->err == 0U) && (rlg->bfp != 0U)){
+  if (!(rlg->wr(rlg->ctx, &(rlg->buf[0]), rlg->bfp))){ rlg->err = 1U; }
+ }
+ rlg->bfp = 0U;
+}
+
+
+
+/* Writes a byte into a recording. */
+static void  rrpge_m_rlog_wb(rrpge_m_rlog_t* rlg, auint v)
+{
+ rlg->buf[rlg->bfp] = v & 0xFFU;
+ rlg->bfp ++;
+ if (rlg->bfp == sizeof(rlg->buf)){ rrpge_m_rlog_flush(rlg); }
+}
+
+
+
+/* Writes a variable length number into a recording. */
+static void  rrpge_m_rlog_wv(rrpge_m_rlog_t* rlg, auint v)
+{
+ v &= 0xFFFFFFFFU;
+ while (v >= 0x80U){
+  rrpge_m_rlog_wb(rlg, (v & 0x7FU) | 0x80U);
+  v >>= 7;
+ }
+ rrpge_m_rlog_wb(rlg, v);
+}
+
+
+
+/* Writes 16 bit words into a recording. */
+static void  rrpge_m_rlog_ww(rrpge_m_rlog_t* rlg, uint16 const* buf, auint len)
+{
+ auint i;
+ for (i = 0U; i < len; i++){
+  rrpge_m_rlog_wb(rlg, buf[i] >> 8);
+  rrpge_m_rlog_wb(rlg, buf[i]);
+ }
+}
+
+
+
+/* Writes the pending rrpge_run() calls into a recording. */
+static void  rrpge_m_rlog_wrun(rrpge_m_rlog_t* rlg)
+{
+ if (rlg->rnc != 0U){
+  rrpge_m_rlog_wb(rlg, RRPGE_M_RLOG_RUN + rlg->rnm);
+  rrpge_m_rlog_wv(rlg, rlg->rnc);
+  rlg->rnc = 0U;
+ }
+}
+
+
+
+/* Starts a record in a recording, optionally with a stamp. */
+static void  rrpge_m_rlog_wtag(rrpge_m_rlog_t* rlg, auint tag, auint stm)
+{
+ rrpge_m_rlog_wrun(rlg);
+ rrpge_m_rlog_wb(rlg, tag);
+ if (stm){
+  rrpge_m_rlog_wv(rlg, rlg->frm);
+  rrpge_m_rlog_wv(rlg, rlg->cyc);
+  rlg->frm = 0U;
+ }
+}
+
+
+
+/* Replaying: tells whether there is more data in the log. */
+static auint rrpge_m_rlog_more(rrpge_m_rlog_t* rlg)
+{
+ if (rlg->bfp < rlg->bfl){ return 1U; }
+ rlg->bfp = 0U;
+ rlg->bfl = rlg->rd(rlg->ctx, &(rlg->buf[0]), sizeof(rlg->buf));
+ if (rlg->bfl > sizeof(rlg->buf)){ rlg->bfl = 0U; }
+ return (rlg->bfl != 0U);
+}
+
+
+
+/* Reads a byte from the log. The log is corrupt if it ends. */
+static auint rrpge_m_rlog_rb(rrpge_m_rlog_t* rlg)
+{
+ if (!rrpge_m_rlog_more(rlg)){
+  rlg->err = 1U;
+  return 0U;
+ }
+ rlg->bfp ++;
+ return rlg->buf[rlg->bfp - 1U];
+}
+
+
+
+/* Reads a variable length number from the log. */
+static auint rrpge_m_rlog_rv(rrpge_m_rlog_t* rlg)
+{
+ auint v = 0U;
+ auint s = 0U;
+ auint b;
+
+ do{
+  b  = rrpge_m_rlog_rb(rlg);
+  if (s > 28U){ rlg->err = 1U; return 0U; }
+  v |= (b & 0x7FU) << s;
+  s += 7U;
+ }while ((b & 0x80U) != 0U);
+
+ return v & 0xFFFFFFFFU;
+}
+
+
+
+/* Reads 16 bit words from the log. */
+static void  rrpge_m_rlog_rw(rrpge_m_rlog_t* rlg, uint16* buf, auint len)
+{
+ auint i;
+ auint t;
+ for (i = 0U; i < len; i++){
+  t      = rrpge_m_rlog_rb(rlg) << 8;
+  buf[i] = t | rrpge_m_rlog_rb(rlg);
+ }
+}
+
+
+
+/* Reads a stamp from the log, the replay diverged if it does not match. */
+static void  rrpge_m_rlog_rstamp(rrpge_m_rlog_t* rlg)
+{
+ if (rrpge_m_rlog_rv(rlg) != rlg->frm){ rlg->err = 1U; }
+ if (rrpge_m_rlog_rv(rlg) != rlg->cyc){ rlg->err = 1U; }
+ rlg->frm = 0U;
+}
+
+
+
+/* Gets the Data memory areas of a task's output, clipped to the Data
+** memory. Returns the count of areas. */
+static auint rrpge_m_rlog_outs(rrpge_object_t const* hnd, auint tsh, auint* rng)
+{
+ auint c = rrpge_m_task_outs(hnd, tsh, rng);
+ auint i;
+
+ for (i = 0U; i < c; i++){
+  if (rng[(i << 1) + 0U] >= RRPGE_M_DRTY_DRAMS){
+   rng[(i << 1) + 1U] = 0U;
+  }else if ((rng[(i << 1) + 0U] + rng[(i << 1) + 1U]) > RRPGE_M_DRTY_DRAMS){
+   rng[(i << 1) + 1U] = RRPGE_M_DRTY_DRAMS - rng[(i << 1) + 0U];
+  }
+ }
+
+ return c;
+}
+
+
+
+/* Replays a record (except rrpge_run() calls and task callbacks). */
+static void  rrpge_m_rlog_apply(rrpge_object_t* hnd, auint tag)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+ uint16 lbuf[512];
+ uint16 rbuf[512];
+ uint16 msg[4096];
+ auint  rng[4];
+ auint  c;
+ auint  i;
+ auint  t;
+ auint  r;
+ auint  n;
+
+ switch (tag){
+
+  case RRPGE_M_RLOG_AUD:
+   rrpge_getaudio(hnd, &(lbuf[0]), &(rbuf[0]));
+   break;
+
+  case RRPGE_M_RLOG_TEN:
+   rrpge_m_rlog_rstamp(rlg);
+   t = rrpge_m_rlog_rb(rlg) & 0xFU;
+   r = rrpge_m_rlog_rv(rlg);
+   c = rrpge_m_rlog_outs(hnd, t, &(rng[0]));
+   for (i = 0U; i < c; i++){
+    n = rrpge_m_rlog_rv(rlg);
+    if (n != rng[(i << 1) + 1U]){ rlg->err = 1U; }
+    if (rlg->err != 0U){ return; }
+    rrpge_m_rlog_rw(rlg, &(hnd->st.dram[rng[i << 1]]), n);
+   }
+   if (rlg->err != 0U){ return; }
+   rrpge_taskend(hnd, t, r);
+   break;
+
+  case RRPGE_M_RLOG_DAD:
+   rrpge_m_rlog_rstamp(rlg);
+   t = rrpge_m_rlog_rv(rlg);
+   if (rlg->err != 0U){ return; }
+   rrpge_dev_add(hnd, t);
+   break;
+
+  case RRPGE_M_RLOG_DRM:
+   rrpge_m_rlog_rstamp(rlg);
+   t = rrpge_m_rlog_rv(rlg);
+   if (rlg->err != 0U){ return; }
+   rrpge_dev_rem(hnd, t);
+   break;
+
+  case RRPGE_M_RLOG_DPS:
+   rrpge_m_rlog_rstamp(rlg);
+   t = rrpge_m_rlog_rv(rlg);
+   r = rrpge_m_rlog_rv(rlg);
+   n = rrpge_m_rlog_rv(rlg);
+   if (n > 8U){ rlg->err = 1U; }
+   if (rlg->err != 0U){ return; }
+   rrpge_m_rlog_rw(rlg, &(msg[0]), n);
+   if (rlg->err != 0U){ return; }
+   rrpge_dev_push(hnd, t, r, n, &(msg[0]));
+   break;
+
+  case RRPGE_M_RLOG_PKT:
+   rrpge_m_rlog_rstamp(rlg);
+   rrpge_m_rlog_rw(rlg, &(lbuf[0]), 8U);
+   n = rrpge_m_rlog_rv(rlg);
+   if (n > 4095U){ rlg->err = 1U; }
+   if (rlg->err != 0U){ return; }
+   rrpge_m_rlog_rw(rlg, &(msg[0]), n);
+   if (rlg->err != 0U){ return; }
+   rrpge_pushpacket(hnd, &(lbuf[0]), &(msg[0]), n);
+   break;
+
+  case RRPGE_M_RLOG_CLK:
+   rrpge_m_rlog_rstamp(rlg);
+   t = rrpge_m_rlog_rv(rlg);
+   if (rlg->err != 0U){ return; }
+   rrpge_set_clock(hnd, t);
+   break;
+
+  case RRPGE_M_RLOG_RST:
+   rrpge_m_rlog_rstamp(rlg);
+   if (rlg->err != 0U){ return; }
+   rrpge_reset(hnd);
+   break;
+
+  default:        /* Not valid here */
+   rlg->err = 1U;
+   break;
+ }
+}
+
+
+
+/* rrpge_run() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_run(rrpge_object_t* hnd, auint rmod)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd)){
+  rmod &= 0x3U;
+  if (rlg->rnm != rmod){ rrpge_m_rlog_wrun(rlg); }
+  rlg->rnm = rmod;
+  rlg->rnc ++;
+ }
+ return 1U;
+}
+
+
+
+/* rrpge_run() exit with the count of cycles emulated. */
+void  rrpge_m_rlog_tick(rrpge_object_t* hnd, auint cy)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+
+ if (rlg == RRPGE_M_NULL){ return; }
+ if (rrpge_m_halt_isset(hnd, RRPGE_HLT_FRAME)){
+  rlg->frm ++;
+  rlg->cyc = 0U;
+ }else{
+  rlg->cyc = (rlg->cyc + cy) & 0xFFFFFFFFU;
+ }
+}
+
+
+
+/* rrpge_getaudio() consuming an audio event. */
+void  rrpge_m_rlog_aud(rrpge_object_t* hnd)
+{
+ if (!rrpge_m_rlog_isrec(hnd)){ return; }
+ rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_AUD, 0U);
+}
+
+
+
+/* Kernel task dispatch. Returns nonzero if replaying, the host's actions on
+** the task were replayed then, so its callback must not be called. */
+auint rrpge_m_rlog_task(rrpge_object_t* hnd, auint tsh)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+ auint t;
+
+ if (rlg == RRPGE_M_NULL){ return 0U; }
+
+ if (rlg->ply == 0U){
+  rrpge_m_rlog_wtag(rlg, RRPGE_M_RLOG_TSK, 0U);
+  rrpge_m_rlog_wb(rlg, tsh);
+  return 0U;
+ }
+
+ /* Replay the host's actions within the callback */
+
+ if (rrpge_m_rlog_rb(rlg) != RRPGE_M_RLOG_TSK){ rlg->err = 1U; }
+ if (rrpge_m_rlog_rb(rlg) != tsh){ rlg->err = 1U; }
+ while (rlg->err == 0U){
+  t = rrpge_m_rlog_rb(rlg);
+  if (t == RRPGE_M_RLOG_RET){ break; }
+  rrpge_m_rlog_apply(hnd, t);
+ }
+ return 1U;
+}
+
+
+
+/* Return from a kernel task callback. */
+void  rrpge_m_rlog_ret(rrpge_object_t* hnd)
+{
+ if (!rrpge_m_rlog_isrec(hnd)){ return; }
+ rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_RET, 0U);
+}
+
+
+
+/* Kernel call served by a callback. 'res' (may be NULL) is the result and
+** 'buf' is the 'len' words output area of the call. These are recorded
+** after the callback, or filled in from the log when replaying (then the
+** callback must not be called). */
+void  rrpge_m_rlog_kcall(rrpge_object_t* hnd, auint id, auint* res,
+                         uint16* buf, auint len)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+ auint r;
+ auint i;
+
+ if (rlg == RRPGE_M_NULL){ return; }
+
+ if (rlg->ply == 0U){
+  rrpge_m_rlog_wtag(rlg, RRPGE_M_RLOG_KCL, 0U);
+  rrpge_m_rlog_wb(rlg, id);
+  rrpge_m_rlog_wv(rlg, (res != RRPGE_M_NULL) ? (*res) : 0U);
+  rrpge_m_rlog_wv(rlg, len);
+  rrpge_m_rlog_ww(rlg, buf, len);
+  return;
+ }
+
+ if (rrpge_m_rlog_rb(rlg) != RRPGE_M_RLOG_KCL){ rlg->err = 1U; }
+ if (rrpge_m_rlog_rb(rlg) != id){ rlg->err = 1U; }
+ r = rrpge_m_rlog_rv(rlg);
+ if (rrpge_m_rlog_rv(rlg) != len){ rlg->err = 1U; }
+ if (rlg->err == 0U){ rrpge_m_rlog_rw(rlg, buf, len); }
+ else{ for (i = 0U; i < len; i++){ buf[i] = 0U; } }
+ if (res != RRPGE_M_NULL){ *res = r; }
+}
+
+
+
+/* rrpge_taskend() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_taskend(rrpge_object_t* hnd, auint tsh, auint res)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+ auint rng[4];
+ auint c;
+ auint i;
+
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd)){
+  tsh &= 0xFU;
+  rrpge_m_rlog_wtag(rlg, RRPGE_M_RLOG_TEN, 1U);
+  rrpge_m_rlog_wb(rlg, tsh);
+  rrpge_m_rlog_wv(rlg, res);
+  c = rrpge_m_rlog_outs(hnd, tsh, &(rng[0]));
+  for (i = 0U; i < c; i++){
+   rrpge_m_rlog_wv(rlg, rng[(i << 1) + 1U]);
+   rrpge_m_rlog_ww(rlg, &(hnd->st.dram[rng[i << 1]]), rng[(i << 1) + 1U]);
+  }
+ }
+ return 1U;
+}
+
+
+
+/* rrpge_dev_add() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_devadd(rrpge_object_t* hnd, auint typ)
+{
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd)){
+  rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_DAD, 1U);
+  rrpge_m_rlog_wv(hnd->rlg, typ);
+ }
+ return 1U;
+}
+
+
+
+/* rrpge_dev_rem() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_devrem(rrpge_object_t* hnd, auint dev)
+{
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd)){
+  rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_DRM, 1U);
+  rrpge_m_rlog_wv(hnd->rlg, dev);
+ }
+ return 1U;
+}
+
+
+
+/* rrpge_dev_push() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_devpush(rrpge_object_t* hnd, auint dev, auint emt,
+                           auint cnt, uint16 const* msg)
+{
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd) && (cnt <= 8U)){ /* Longer events are dropped */
+  rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_DPS, 1U);
+  rrpge_m_rlog_wv(hnd->rlg, dev);
+  rrpge_m_rlog_wv(hnd->rlg, emt);
+  rrpge_m_rlog_wv(hnd->rlg, cnt);
+  rrpge_m_rlog_ww(hnd->rlg, msg, cnt);
+ }
+ return 1U;
+}
+
+
+
+/* rrpge_pushpacket() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_packet(rrpge_object_t* hnd, uint16 const* id,
+                          uint16 const* buf, auint len)
+{
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd) && (len != 0U) && (len <= 4095U)){ /* Others are dropped */
+  rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_PKT, 1U);
+  rrpge_m_rlog_ww(hnd->rlg, id, 8U);
+  rrpge_m_rlog_wv(hnd->rlg, len);
+  rrpge_m_rlog_ww(hnd->rlg, buf, len);
+ }
+ return 1U;
+}
+
+
+
+/* rrpge_set_clock() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_clock(rrpge_object_t* hnd, auint clk)
+{
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd)){
+  rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_CLK, 1U);
+  rrpge_m_rlog_wv(hnd->rlg, clk);
+ }
+ return 1U;
+}
+
+
+
+/* rrpge_reset() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_reset(rrpge_object_t* hnd)
+{
+ if (!rrpge_m_rlog_pass(hnd)){ return 0U; }
+ if (rrpge_m_rlog_isrec(hnd)){
+  rrpge_m_rlog_wtag(hnd->rlg, RRPGE_M_RLOG_RST, 1U);
+ }
+ return 1U;
+}
+
+
+
+/* Ends recording or replaying, flushing a recording, and frees the log.
+** Returns nonzero if the log was complete (recording: all written). */
+auint rrpge_m_rlog_free(rrpge_object_t* hnd)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+ auint r;
+
+ if (rlg == RRPGE_M_NULL){ return 0U; }
+
+ if (rlg->ply == 0U){
+  rrpge_m_rlog_wrun(rlg);
+  rrpge_m_rlog_flush(rlg);
+  r = (rlg->err == 0U);
+ }else{
+  r = ((rlg->err == 0U) && (rlg->end != 0U));
+ }
+
+ hnd->rlg = RRPGE_M_NULL;
+ rrpge_m_alloc_free(rlg);
+
+ return r;
+}
+
+
+
+/* Starts recording - implementation of RRPGE library function */
+rrpge_iuint rrpge_rec_start(rrpge_object_t* hnd, rrpge_wrstream_t* wr, void* ctx)
+{
+ rrpge_m_rlog_t* rlg;
+ auint t;
+
+ rlg = rrpge_m_rlog_new(hnd);
+ if (rlg == RRPGE_M_NULL){ return RRPGE_ERR_INI; }
+
+ rlg->wr  = wr;
+ rlg->ctx = ctx;
+
+ /* Header */
+
+ for (t = 0U; t < 4U; t++){ rrpge_m_rlog_wb(rlg, rrpge_m_rlog_mag[t]); }
+ rrpge_m_rlog_wv(rlg, hnd->app->sum);
+ rrpge_m_rlog_wv(rlg, rrpge_m_rlog_sum(hnd));
+ rrpge_m_rlog_wv(rlg, hnd->aud.mclk);
+
+ hnd->rlg = rlg;
+
+ return RRPGE_ERR_OK;
+}
+
+
+
+/* Ends recording - implementation of RRPGE library function */
+rrpge_ibool rrpge_rec_stop(rrpge_object_t* hnd)
+{
+ if (!rrpge_m_rlog_isrec(hnd)){ return 0U; }
+ return rrpge_m_rlog_free(hnd);
+}
+
+
+
+/* Starts replaying - implementation of RRPGE library function */
+rrpge_iuint rrpge_play_start(rrpge_object_t* hnd, rrpge_rdstream_t* rd, void* ctx)
+{
+ rrpge_m_rlog_t* rlg;
+ auint t;
+ auint r = RRPGE_ERR_OK;
+
+ rlg = rrpge_m_rlog_new(hnd);
+ if (rlg == RRPGE_M_NULL){ return RRPGE_ERR_INI; }
+
+ rlg->ply = 1U;
+ rlg->rd  = rd;
+ rlg->ctx = ctx;
+
+ /* Header: the log has to be recorded from the same state */
+
+ for (t = 0U; t < 4U; t++){
+  if (rrpge_m_rlog_rb(rlg) != rrpge_m_rlog_mag[t]){ r = RRPGE_ERR_VER; }
+ }
+ if (rrpge_m_rlog_rv(rlg) != hnd->app->sum){ r = RRPGE_ERR_VER; }
+ if (rrpge_m_rlog_rv(rlg) != rrpge_m_rlog_sum(hnd)){ r = RRPGE_ERR_VER; }
+ t = rrpge_m_rlog_rv(rlg);
+ if (rlg->err != 0U){ r = RRPGE_ERR_VER; }
+
+ if (r != RRPGE_ERR_OK){
+  rrpge_m_alloc_free(rlg);
+  return r;
+ }
+
+ rrpge_set_clock(hnd, t);
+ hnd->rlg = rlg;
+
+ return RRPGE_ERR_OK;
+}
+
+
+
+/* Replays up to a run - implementation of RRPGE library function */
+rrpge_iuint rrpge_play_run(rrpge_object_t* hnd)
+{
+ rrpge_m_rlog_t* rlg = hnd->rlg;
+ auint t;
+
+ if (!rrpge_m_rlog_isplay(hnd)){ return RRPGE_PLAY_BAD; }
+
+ rlg->act = 1U;
+
+ while ((rlg->err == 0U) && (rlg->end == 0U)){
+
+  if (rlg->rnc != 0U){
+   rlg->rnc --;
+   rrpge_run(hnd, rlg->rnm);
+   break;
+  }
+
+  if (!rrpge_m_rlog_more(rlg)){
+   rlg->end = 1U;
+   break;
+  }
+
+  t = rrpge_m_rlog_rb(rlg);
+  if ((t & 0xFCU) == RRPGE_M_RLOG_RUN){
+   rlg->rnm = t & 0x3U;
+   rlg->rnc = rrpge_m_rlog_rv(rlg);
+   if (rlg->rnc == 0U){ rlg->err = 1U; }
+  }else{
+   rrpge_m_rlog_apply(hnd, t);
+  }
+ }
+
+ rlg->act = 0U;
+
+ if (rlg->err != 0U){ return RRPGE_PLAY_BAD; }
+ if (rlg->end != 0U){ return RRPGE_PLAY_END; }
+ return RRPGE_PLAY_RUN;
+}
+
+
+
+/* Ends replaying - implementation of RRPGE library function */
+void rrpge_play_stop(rrpge_object_t* hnd)
+{
+ if (!rrpge_m_rlog_isplay(hnd)){ return; }
+ rrpge_m_rlog_free(hnd);
+}
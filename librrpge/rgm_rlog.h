@@ -0,0 +1,94 @@
+/**
+**  \file
+**  \brief     Input log: recording and replaying emulation sessions
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.08
+**
+**
+**  The emulation is deterministic, so a session is reproduced by repeating
+**  everything the host passed to the emulator: the rrpge_run() calls with
+**  their modes, the inputs (devices, network packets, clock, resets), and
+**  the results of kernel tasks and kernel calls served by callbacks. The
+**  entry points of these call the appropriate functions here, which record
+**  the call when recording, and tell whether the call may proceed when
+**  replaying (only the replay may feed the emulator then).
+**
+**  The inputs are stamped with the frame and cycle they arrived at, so a
+**  replay diverging from the recording (such as by a different build of the
+**  library) is detected.
+*/
+
+
+#ifndef RRPGE_M_RLOG_H
+#define RRPGE_M_RLOG_H
+
+
+#include "rgm_info.h"
+#include "rrpge.h"
+
+
+/* Tells whether an input log is being replayed. The callbacks serving
+** kernel tasks and calls are not called then, their results come from the
+** log. */
+static auint rrpge_m_rlog_isplay(rrpge_object_t const* hnd)
+{
+ return ((hnd->rlg != RRPGE_M_NULL) && (hnd->rlg->ply != 0U));
+}
+
+
+/* rrpge_run() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_run(rrpge_object_t* hnd, auint rmod);
+
+/* rrpge_run() exit with the count of cycles emulated. */
+void  rrpge_m_rlog_tick(rrpge_object_t* hnd, auint cy);
+
+/* rrpge_getaudio() consuming an audio event. */
+void  rrpge_m_rlog_aud(rrpge_object_t* hnd);
+
+/* Kernel task dispatch. Returns nonzero if replaying, the host's actions on
+** the task were replayed then, so its callback must not be called. */
+auint rrpge_m_rlog_task(rrpge_object_t* hnd, auint tsh);
+
+/* Return from a kernel task callback. */
+void  rrpge_m_rlog_ret(rrpge_object_t* hnd);
+
+/* Kernel call served by a callback. 'res' (may be NULL) is the result and
+** 'buf' is the 'len' words output area of the call. These are recorded
+** after the callback, or filled in from the log when replaying (then the
+** callback must not be called). */
+void  rrpge_m_rlog_kcall(rrpge_object_t* hnd, auint id, auint* res,
+                         uint16* buf, auint len);
+
+/* rrpge_taskend() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_taskend(rrpge_object_t* hnd, auint tsh, auint res);
+
+/* rrpge_dev_add() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_devadd(rrpge_object_t* hnd, auint typ);
+
+/* rrpge_dev_rem() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_devrem(rrpge_object_t* hnd, auint dev);
+
+/* rrpge_dev_push() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_devpush(rrpge_object_t* hnd, auint dev, auint emt,
+                           auint cnt, uint16 const* msg);
+
+/* rrpge_pushpacket() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_packet(rrpge_object_t* hnd, uint16 const* id,
+                          uint16 const* buf, auint len);
+
+/* rrpge_set_clock() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_clock(rrpge_object_t* hnd, auint clk);
+
+/* rrpge_reset() entry. Returns nonzero if the call may proceed. */
+auint rrpge_m_rlog_reset(rrpge_object_t* hnd);
+
+/* Ends recording or replaying, flushing a recording, and frees the log.
+** Returns nonzero if the log was complete (recording: all written). */
+auint rrpge_m_rlog_free(rrpge_object_t* hnd);
+
+
+#endif
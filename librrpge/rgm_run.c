@@ -20,6 +20,7 @@
 #include "rgm_cpu.h"
 #include "rgm_pram.h"
 #include "rgm_dev.h"
+#include "rgm_rlog.h"
 
 
 
@@ -31,8 +32,11 @@ rrpge_iuint rrpge_run(rrpge_object_t* hnd, rrpge_iuint rmod)
  auint r  = 0U;                /* Return number of cycles */
  uint16* stat;
 
- rrpge_m_edat = hnd;
- stat = &(rrpge_m_edat->st.stat[0]);
+ stat = &(hnd->st.stat[0]);
+
+ /* Input log: when replaying, runs are only done by the replay */
+
+ if (!rrpge_m_rlog_run(hnd, rmod)){ return 0U; }
 
  /* Check halt causes, break emulation if necessary. */
 
@@ -46,12 +50,12 @@ rrpge_iuint rrpge_run(rrpge_object_t* hnd, rrpge_iuint rmod)
  }
  rrpge_m_halt_clrall(hnd);     /* All other halt causes simply clear */
 
- /* Export Application state data into info structure */
+ /* Export Application state data into the emulation instance */
 
- rrpge_m_info.cyf[0] = ((stat[RRPGE_STA_VARS + 0x22U] & 0xFFFFU) << 16) +
-                       ((stat[RRPGE_STA_VARS + 0x23U] & 0xFFFFU));
- rrpge_m_info.cyf[1] = ((stat[RRPGE_STA_VARS + 0x2AU] & 0xFFFFU) << 16) +
-                       ((stat[RRPGE_STA_VARS + 0x2BU] & 0xFFFFU));
+ hnd->cyf[0] = ((stat[RRPGE_STA_VARS + 0x22U] & 0xFFFFU) << 16) +
+               ((stat[RRPGE_STA_VARS + 0x23U] & 0xFFFFU));
+ hnd->cyf[1] = ((stat[RRPGE_STA_VARS + 0x2AU] & 0xFFFFU) << 16) +
+               ((stat[RRPGE_STA_VARS + 0x2BU] & 0xFFFFU));
 
  rrpge_m_pram_cys_clr(hnd);    /* Stall cycles are always consumed right away (no carry-over between runs) */
 
@@ -69,10 +73,10 @@ rrpge_iuint rrpge_run(rrpge_object_t* hnd, rrpge_iuint rmod)
   /* Roll and add kernel internal task cycles if necessary. This is done here
   ** since it needs to produce CPU cycles. */
 
-  while ((rrpge_m_edat->kfc & 0x80000000U) != 0U){ /* Free cycles exhausted */
-   i   = (rrpge_m_prng() & 0x7FU) * 100U;
+  while ((hnd->kfc & 0x80000000U) != 0U){ /* Free cycles exhausted */
+   i   = (rrpge_m_prng(hnd) & 0x7FU) * 100U;
    i  += 400U * 32U;           /* 32 - 64 lines of free time */
-   rrpge_m_edat->kfc += i + (i >> 2);
+   hnd->kfc += i + (i >> 2);
    i >>= 2;
    cy += i;                    /*  8 - 16 lines of kernel time */
                                /* (Above i >> 2 is also added to the free time
@@ -83,7 +87,7 @@ rrpge_iuint rrpge_run(rrpge_object_t* hnd, rrpge_iuint rmod)
   ** asynchronous tasks may start and catch up with the CPU. */
 
   r += cy;                     /* Sum emulated cycles for return value */
-  rrpge_m_edat->kfc -= cy;     /* Free cycles remaining until next kernel takeover */
+  hnd->kfc -= cy;              /* Free cycles remaining until next kernel takeover */
 
 
   /* Process asynchronous tasks which should perform during the consumed
@@ -91,7 +95,7 @@ rrpge_iuint rrpge_run(rrpge_object_t* hnd, rrpge_iuint rmod)
 
   /* Peripheral processing (FIFO: Mixer and Accelerator) */
 
-  rrpge_m_fifoproc(cy);
+  rrpge_m_fifoproc(hnd, cy);
 
   /* Audio processing. This may also raise an audio halt cause indicating an
   ** 512 sample streak. */
@@ -118,7 +122,7 @@ rrpge_iuint rrpge_run(rrpge_object_t* hnd, rrpge_iuint rmod)
 
   /* Schedule kernel tasks if necessary. */
 
-  rrpge_m_tasksched();
+  rrpge_m_tasksched(hnd);
 
 
   /* When in single stepping mode, an operation is carried out to this point,
@@ -129,12 +133,16 @@ rrpge_iuint rrpge_run(rrpge_object_t* hnd, rrpge_iuint rmod)
  }while (1);
 
 
- /* Write-back Application state data from info structure */
+ /* Write-back Application state data from the emulation instance */
+
+ stat[RRPGE_STA_VARS + 0x22U] = (hnd->cyf[0] >> 16) & 0xFFFFU;
+ stat[RRPGE_STA_VARS + 0x23U] = (hnd->cyf[0]      ) & 0xFFFFU;
+ stat[RRPGE_STA_VARS + 0x2AU] = (hnd->cyf[1] >> 16) & 0xFFFFU;
+ stat[RRPGE_STA_VARS + 0x2BU] = (hnd->cyf[1]      ) & 0xFFFFU;
+
+ /* Input log: count frames and cycles for stamping the inputs */
 
- stat[RRPGE_STA_VARS + 0x22U] = (rrpge_m_info.cyf[0] >> 16) & 0xFFFFU;
- stat[RRPGE_STA_VARS + 0x23U] = (rrpge_m_info.cyf[0]      ) & 0xFFFFU;
- stat[RRPGE_STA_VARS + 0x2AU] = (rrpge_m_info.cyf[1] >> 16) & 0xFFFFU;
- stat[RRPGE_STA_VARS + 0x2BU] = (rrpge_m_info.cyf[1]      ) & 0xFFFFU;
+ rrpge_m_rlog_tick(hnd, r);
 
  /* OK, all done, return consumed cycles */
 
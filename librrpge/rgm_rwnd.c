@@ -0,0 +1,360 @@
+/**
+**  \file
+**  \brief     Rewind buffer
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.12
+*/
+
+
+#include "rgm_rwnd.h"
+#include "rgm_drty.h"
+
+
+
+/* Rounds a size up to the alignment unit of the ring */
+#define RRPGE_M_RWND_ALN(x) ((((x) + sizeof(rrpge_m_rwnd_aln_t) - 1U) / sizeof(rrpge_m_rwnd_aln_t)) * sizeof(rrpge_m_rwnd_aln_t))
+
+/* Size of the rewind buffer object before the ring */
+#define RRPGE_M_RWND_OBJ    RRPGE_M_RWND_ALN(sizeof(rrpge_rewind_t))
+
+/* Size of a record header, and of the page entries */
+#define RRPGE_M_RWND_HDR    RRPGE_M_RWND_ALN(sizeof(rrpge_m_rwnd_rec_t))
+#define RRPGE_M_RWND_PGP    (4U + (256U * 4U))
+#define RRPGE_M_RWND_PGD    (4U + (256U * 2U))
+
+
+
+/* Returns a record of the ring by its offset */
+static rrpge_m_rwnd_rec_t* rrpge_m_rwnd_rec(rrpge_rewind_t* rew, auint off)
+{
+ return (rrpge_m_rwnd_rec_t*)(((uint8*)(rew)) + RRPGE_M_RWND_OBJ + off);
+}
+
+
+
+/* Returns whether the emulation instance is usable with the rewind buffer */
+static auint rrpge_m_rwnd_isok(rrpge_rewind_t const* rew, rrpge_object_t const* hnd)
+{
+ if ((hnd->inss != RRPGE_INI_RESET) || (hnd->insm != 0U)){ return 0U; }
+ return (hnd->app->sum == rew->app);
+}
+
+
+
+/* Drops the oldest record from the ring */
+static void  rrpge_m_rwnd_drop(rrpge_rewind_t* rew)
+{
+ rew->rdp += rrpge_m_rwnd_rec(rew, rew->rdp)->siz;
+ rew->cnt --;
+
+ if (rew->cnt == 0U){           /* Empty: restart from the beginning */
+  rew->rdp = 0U;
+  rew->wrp = 0U;
+  rew->end = rew->siz;
+ }else if (rew->rdp >= rew->end){ /* Oldest record wraps around */
+  rew->rdp = 0U;
+  rew->end = rew->siz;
+ }
+}
+
+
+
+/* Makes room for a record of the given size (at most the size of the ring),
+** dropping the oldest records as needed. Returns the offset to place it at. */
+static auint rrpge_m_rwnd_room(rrpge_rewind_t* rew, auint n)
+{
+ while (1){
+
+  if (rew->cnt == 0U){
+   return 0U;
+  }
+
+  if (rew->wrp > rew->rdp){     /* Records are not wrapping around */
+   if ((rew->siz - rew->wrp) >= n){ return rew->wrp; }
+   if (rew->rdp >= n){          /* Fits at the beginning */
+    rew->end = rew->wrp;
+    return 0U;
+   }
+  }else{                        /* Records are wrapping around */
+   if ((rew->rdp - rew->wrp) >= n){ return rew->wrp; }
+  }
+
+  rrpge_m_rwnd_drop(rew);
+
+ }
+}
+
+
+
+/* Captures the state of the emulation instance into a new record */
+static void  rrpge_m_rwnd_capture(rrpge_rewind_t* rew, rrpge_object_t* hnd)
+{
+ auint   i;
+ auint   j;
+ auint   b;
+ auint   m;
+ auint   n;
+ auint   off;
+ auint   npg = 0U;
+ auint   sto = 1U;
+ uint8*  p;
+ uint32* e;
+ rrpge_m_rwnd_rec_t* rec;
+
+ /* Collect the changed pages: the dirty ones, or all if the reference is
+ ** not valid yet. */
+
+ n = RRPGE_M_RWND_HDR;
+
+ for (i = 0U; i < 4096U; i++){
+  m = 0x80000000U >> (i & 0x1FU);
+  rew->chgp[i >> 5] &= ~m;
+  if ( (rew->ini == 0U) || ((hnd->drtp[i >> 5] & m) != 0U) ){
+   b = i << 8;
+   for (j = 0U; j < 256U; j++){
+    if (hnd->st.pram[b + j] != rew->refp[b + j]){ break; }
+   }
+   if (j != 256U){
+    rew->chgp[i >> 5] |= m;
+    n += RRPGE_M_RWND_PGP;
+    npg ++;
+   }
+  }
+ }
+
+ for (i = 0U; i < 384U; i++){
+  m = 0x80000000U >> (i & 0x1FU);
+  rew->chgd[i >> 5] &= ~m;
+  if ( (rew->ini == 0U) || ((hnd->drtd[i >> 5] & m) != 0U) ){
+   b = i << 8;
+   for (j = 0U; j < 256U; j++){
+    if (hnd->st.dram[b + j] != rew->refd[b + j]){ break; }
+   }
+   if (j != 256U){
+    rew->chgd[i >> 5] |= m;
+    n += RRPGE_M_RWND_PGD;
+    npg ++;
+   }
+  }
+ }
+
+ rrpge_clrdirty(hnd, RRPGE_DIRTY_PRAM);
+ rrpge_clrdirty(hnd, RRPGE_DIRTY_DRAM);
+
+ /* Make room. The previous page contents are only needed if there are
+ ** older records to step back to, so if the record can not fit with them,
+ ** it is stored alone without the pages. */
+
+ n = RRPGE_M_RWND_ALN(n);
+ if ((n > rew->siz) || (rew->ini == 0U)){
+  while (rew->cnt != 0U){ rrpge_m_rwnd_drop(rew); }
+ }
+ if (rew->cnt == 0U){
+  sto = 0U;
+  n   = RRPGE_M_RWND_HDR;
+ }
+ off = rrpge_m_rwnd_room(rew, n);
+ if (rew->cnt == 0U){
+  sto = 0U;
+  n   = RRPGE_M_RWND_HDR;
+ }
+
+ /* Fill in the record, updating the reference memories */
+
+ rec = rrpge_m_rwnd_rec(rew, off);
+ rec->siz = n;
+ rec->prv = rew->lst;
+ rec->frm = rew->frm;
+ rec->npg = 0U;
+ rrpge_m_snap_cmp_save(hnd, &(rec->cmp));
+ for (i = 0U; i < 1024U; i++){ rec->stat[i] = hnd->st.stat[i]; }
+
+ p = ((uint8*)(rec)) + RRPGE_M_RWND_HDR;
+
+ for (i = 0U; i < 4096U; i++){
+  if ((rew->chgp[i >> 5] & (0x80000000U >> (i & 0x1FU))) != 0U){
+   b = i << 8;
+   if (sto != 0U){
+    e = (uint32*)(p);
+    e[0] = i;
+    for (j = 0U; j < 256U; j++){ e[j + 1U] = rew->refp[b + j]; }
+    p += RRPGE_M_RWND_PGP;
+    rec->npg ++;
+   }
+   for (j = 0U; j < 256U; j++){ rew->refp[b + j] = hnd->st.pram[b + j]; }
+  }
+ }
+
+ for (i = 0U; i < 384U; i++){
+  if ((rew->chgd[i >> 5] & (0x80000000U >> (i & 0x1FU))) != 0U){
+   b = i << 8;
+   if (sto != 0U){
+    e = (uint32*)(p);
+    e[0] = i | 0x80000000U;
+    for (j = 0U; j < 256U; j++){ ((uint16*)(&e[1]))[j] = rew->refd[b + j]; }
+    p += RRPGE_M_RWND_PGD;
+    rec->npg ++;
+   }
+   for (j = 0U; j < 256U; j++){ rew->refd[b + j] = hnd->st.dram[b + j]; }
+  }
+ }
+
+ rew->lst = off;
+ rew->wrp = off + n;
+ rew->cnt ++;
+ rew->ini = 1U;
+}
+
+
+
+/* Steps the reference memories back by a record, marking the pages it
+** restores */
+static void  rrpge_m_rwnd_undo(rrpge_rewind_t* rew, rrpge_m_rwnd_rec_t const* rec)
+{
+ auint   i;
+ auint   j;
+ auint   b;
+ uint8 const*  p = ((uint8 const*)(rec)) + RRPGE_M_RWND_HDR;
+ uint32 const* e;
+
+ for (i = 0U; i < rec->npg; i++){
+  e = (uint32 const*)(p);
+  b = (e[0] & 0xFFFU) << 8;
+  if ((e[0] & 0x80000000U) == 0U){
+   for (j = 0U; j < 256U; j++){ rew->refp[b + j] = e[j + 1U]; }
+   rew->chgp[(e[0] & 0xFFFU) >> 5] |= 0x80000000U >> (e[0] & 0x1FU);
+   p += RRPGE_M_RWND_PGP;
+  }else{
+   for (j = 0U; j < 256U; j++){ rew->refd[b + j] = ((uint16 const*)(&e[1]))[j]; }
+   rew->chgd[(e[0] & 0x1FFU) >> 5] |= 0x80000000U >> (e[0] & 0x1FU);
+   p += RRPGE_M_RWND_PGD;
+  }
+ }
+}
+
+
+
+/* Creates a rewind buffer - implementation of RRPGE library function */
+rrpge_rewind_t* rrpge_new_rewind(rrpge_object_t* hnd, rrpge_iuint bud, rrpge_iuint per)
+{
+ rrpge_rewind_t* rew;
+
+ if ((hnd->inss != RRPGE_INI_RESET) || (hnd->insm != 0U)){ return RRPGE_M_NULL; }
+
+ if (bud < RRPGE_M_RWND_HDR){ bud = RRPGE_M_RWND_HDR; }
+ bud = RRPGE_M_RWND_ALN(bud);
+ if (per == 0U){ per = 1U; }
+
+ rew = rrpge_m_alloc(RRPGE_M_RWND_OBJ + bud, RRPGE_M_OBJ_RWD);
+ if (rew == RRPGE_M_NULL){ return RRPGE_M_NULL; }
+
+ rew->app = hnd->app->sum;
+ rew->per = per;
+ rew->frm = 0U;
+ rew->ini = 0U;
+ rew->siz = bud;
+ rew->cnt = 0U;
+ rew->rdp = 0U;
+ rew->wrp = 0U;
+ rew->end = bud;
+ rew->lst = 0U;
+
+ return rew;
+}
+
+
+
+/* Notifies rewind buffer of a frame - implementation of RRPGE library function */
+void rrpge_rewind_frame(rrpge_rewind_t* rew, rrpge_object_t* hnd)
+{
+ if (!rrpge_m_rwnd_isok(rew, hnd)){ return; }
+
+ rew->frm ++;
+ if ( (rew->ini == 0U) || ((rew->frm % rew->per) == 0U) ){
+  rrpge_m_rwnd_capture(rew, hnd);
+ }
+}
+
+
+
+/* Gets frames available for rewinding - implementation of RRPGE library function */
+rrpge_iuint rrpge_rewind_avail(rrpge_rewind_t* rew)
+{
+ if (rew->cnt == 0U){ return 0U; }
+ return rew->frm - rrpge_m_rwnd_rec(rew, rew->rdp)->frm;
+}
+
+
+
+/* Steps back using rewind buffer - implementation of RRPGE library function */
+rrpge_iuint rrpge_rewind_back(rrpge_rewind_t* rew, rrpge_object_t* hnd, rrpge_iuint frm)
+{
+ auint   i;
+ auint   j;
+ auint   b;
+ auint   m;
+ auint   t;
+ auint   off;
+ rrpge_m_rwnd_rec_t* rec;
+
+ if (rew->cnt == 0U){ return 0U; }
+ if (!rrpge_m_rwnd_isok(rew, hnd)){ return 0U; }
+ if (hnd->rlg != RRPGE_M_NULL){ return 0U; } /* Can not be logged */
+
+ /* Find the newest record not after the target frame, stepping the
+ ** reference memories back to it */
+
+ if (frm > rew->frm){ t = 0U; }
+ else               { t = rew->frm - frm; }
+
+ for (i = 0U; i < 128U; i++){ rew->chgp[i] = 0U; }
+ for (i = 0U; i <  12U; i++){ rew->chgd[i] = 0U; }
+
+ off = rew->lst;
+ rec = rrpge_m_rwnd_rec(rew, off);
+ while ((rec->frm > t) && (off != rew->rdp)){
+  rrpge_m_rwnd_undo(rew, rec);
+  off = rec->prv;
+  rec = rrpge_m_rwnd_rec(rew, off);
+  rew->cnt --;
+ }
+
+ /* Restore the pages of the instance which differ from the reference: the
+ ** ones written since the last capture and the ones stepped back. They are
+ ** left marked dirty. */
+
+ for (i = 0U; i < 4096U; i++){
+  m = 0x80000000U >> (i & 0x1FU);
+  if (((rew->chgp[i >> 5] | hnd->drtp[i >> 5]) & m) != 0U){
+   b = i << 8;
+   for (j = 0U; j < 256U; j++){ hnd->st.pram[b + j] = rew->refp[b + j]; }
+   rrpge_m_drty_pram(hnd, b);
+  }
+ }
+
+ for (i = 0U; i < 384U; i++){
+  m = 0x80000000U >> (i & 0x1FU);
+  if (((rew->chgd[i >> 5] | hnd->drtd[i >> 5]) & m) != 0U){
+   b = i << 8;
+   for (j = 0U; j < 256U; j++){ hnd->st.dram[b + j] = rew->refd[b + j]; }
+   rrpge_m_drty_dram(hnd, b);
+  }
+ }
+
+ rrpge_m_snap_cmp_load(hnd, &(rec->cmp));
+ for (i = 0U; i < 1024U; i++){ hnd->st.stat[i] = rec->stat[i]; }
+
+ /* The newer records are dropped */
+
+ rew->lst = off;
+ rew->wrp = off + rec->siz;
+ if (off >= rew->rdp){ rew->end = rew->siz; }
+
+ t = rew->frm - rec->frm;
+ rew->frm = rec->frm;
+ return t;
+}
@@ -0,0 +1,73 @@
+/**
+**  \file
+**  \brief     Rewind buffer
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.06
+**
+**
+**  The rewind buffer keeps a reference copy of the memories (PRAM and Data
+**  memory) as of the last capture, and a ring of capture records. Every
+**  record holds the component state of its capture, and the previous
+**  contents of the memory pages which changed since the capture before it
+**  (so applying them on the reference steps it back by one capture). The
+**  changed pages are found by the dirty page tracking (rgm_drty.h), the
+**  capture consumes (clears) the dirty page bit maps.
+**
+**  The records are placed in the ring one after another, wrapping around to
+**  the beginning of the ring when a record does not fit at the end. The
+**  oldest records are dropped to make room for new ones.
+*/
+
+
+#ifndef RRPGE_M_RWND_H
+#define RRPGE_M_RWND_H
+
+
+#include "rgm_snap.h"
+
+
+/* Alignment unit of the records in the ring */
+typedef union{
+ auint  typ;
+ void*  ptr;
+ double dbl;
+}rrpge_m_rwnd_aln_t;
+
+
+/* Capture record header. It is followed by npg page entries, each an uint32
+** page ID (bit 31 set for the Data memory, clear for the PRAM, page number
+** in the low bits) followed by the page's previous contents. */
+typedef struct{
+ auint  siz;           /* Size of the record in bytes (aligned) */
+ auint  prv;           /* Offset of the previous (older) record */
+ auint  frm;           /* Frame count at the capture */
+ auint  npg;           /* Number of page entries */
+ rrpge_m_snap_cmp_t cmp;
+ uint16 stat[1024U];   /* Application state */
+}rrpge_m_rwnd_rec_t;
+
+
+/* Rewind buffer object. The ring follows it in the same allocation. */
+struct rrpge_rewind_s{
+ auint  app;           /* Application checksum (rrpge_m_app_sum()) */
+ auint  per;           /* Capture period in frames */
+ auint  frm;           /* Frame count */
+ auint  ini;           /* Reference memories valid */
+ auint  siz;           /* Size of the ring in bytes */
+ auint  cnt;           /* Count of records in the ring */
+ auint  rdp;           /* Offset of the oldest record */
+ auint  wrp;           /* Offset to write the next record at */
+ auint  end;           /* End of the records in the ring (wrapping around) */
+ auint  lst;           /* Offset of the newest record */
+ uint32 chgp[128U];    /* Bit map of PRAM pages to process */
+ uint32 chgd[12U];     /* Bit map of Data memory pages to process */
+ uint32 refp[1048576U];/* Reference PRAM */
+ uint16 refd[98304U];  /* Reference Data memory */
+};
+
+
+#endif
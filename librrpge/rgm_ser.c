@@ -2,11 +2,11 @@
 **  \file
 **  \brief     Serialization functions
 **  \author    Sandor Zsuga (Jubatian)
-**  \copyright 2013 - 2014, GNU GPLv3 (version 3 of the GNU General Public
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2014.12.10
+**  \date      2015.10.07
 */
 
 
@@ -88,3 +88,303 @@ void rrpge_raw2state(rrpge_uint8 const* src, rrpge_state_t* dst)
                  ((src[(i << 2) + 3U] & 0xFFU));
  }
 }
+
+
+
+/* Compressed state serialization: the raw state (as by rrpge_state2raw())
+** is processed in blocks of RRPGE_M_SER_BLK bytes, the Application state
+** being a shorter block on its own. The stream starts with a 4 byte magic
+** value, then every block follows as a 2 byte (Big Endian) packed size and
+** the packed data. The packed data is a sequence of tokens:
+** 0x00 - 0x7F: Literal bytes follow, count is the token + 1.
+** 0x80 - 0xBF: Zero run, the length is the low 6 bits and the next byte as
+**              a 14 bit value + 1.
+** 0xC0 - 0xFF: Match, the length is the low 6 bits + 4, the next 2 bytes
+**              (Big Endian) give the distance backwards within the block.
+** Matches are found greedily with a hash table of previous positions within
+** the block, so the packing runs at memory copy class speeds. */
+
+/* Raw block size */
+#define RRPGE_M_SER_BLK 4096U
+/* Maximal packed block size (all literals) */
+#define RRPGE_M_SER_PKB (RRPGE_M_SER_BLK + (RRPGE_M_SER_BLK / 128U))
+/* Hash table size of the packer (bits) */
+#define RRPGE_M_SER_HSB 12U
+
+/* Block counts of the areas */
+#define RRPGE_M_SER_DRB (sizeof(((rrpge_state_t*)(0))->dram) / RRPGE_M_SER_BLK)
+#define RRPGE_M_SER_PRB (sizeof(((rrpge_state_t*)(0))->pram) / RRPGE_M_SER_BLK)
+
+/* Stream magic value */
+static const uint8 rrpge_m_ser_mag[4] = {0x52U, 0x50U, 0x5AU, 0x01U};
+
+
+
+/* Produces a block of raw state, returns its size. Block 0 is the
+** Application state, then the Data memory and the PRAM blocks follow. */
+static auint rrpge_m_ser_blkget(rrpge_state_t const* src, auint blk, uint8* dst)
+{
+ auint i;
+ auint t;
+ uint32 const* pr;
+
+ if (blk == 0U){
+  rrpge_conv_w2b(&(src->stat[0]), dst, sizeof(src->stat));
+  return sizeof(src->stat);
+ }
+ blk -= 1U;
+
+ if (blk < RRPGE_M_SER_DRB){
+  rrpge_conv_w2b(&(src->dram[blk * (RRPGE_M_SER_BLK >> 1)]), dst, RRPGE_M_SER_BLK);
+  return RRPGE_M_SER_BLK;
+ }
+ blk -= RRPGE_M_SER_DRB;
+
+ pr = &(src->pram[blk * (RRPGE_M_SER_BLK >> 2)]);
+ for (i = 0U; i < (RRPGE_M_SER_BLK >> 2); i++){
+  t = pr[i];
+  dst[(i << 2) + 0U] = (t >> 24) & 0xFFU;
+  dst[(i << 2) + 1U] = (t >> 16) & 0xFFU;
+  dst[(i << 2) + 2U] = (t >>  8) & 0xFFU;
+  dst[(i << 2) + 3U] = (t      ) & 0xFFU;
+ }
+ return RRPGE_M_SER_BLK;
+}
+
+
+
+/* Stores a block of raw state (reverse of rrpge_m_ser_blkget()). Returns
+** the size of the block. */
+static auint rrpge_m_ser_blkput(rrpge_state_t* dst, auint blk, uint8 const* src)
+{
+ auint i;
+ uint32* pr;
+
+ if (blk == 0U){
+  rrpge_conv_b2w(src, &(dst->stat[0]), sizeof(dst->stat));
+  return sizeof(dst->stat);
+ }
+ blk -= 1U;
+
+ if (blk < RRPGE_M_SER_DRB){
+  rrpge_conv_b2w(src, &(dst->dram[blk * (RRPGE_M_SER_BLK >> 1)]), RRPGE_M_SER_BLK);
+  return RRPGE_M_SER_BLK;
+ }
+ blk -= RRPGE_M_SER_DRB;
+
+ pr = &(dst->pram[blk * (RRPGE_M_SER_BLK >> 2)]);
+ for (i = 0U; i < (RRPGE_M_SER_BLK >> 2); i++){
+  pr[i] = ((src[(i << 2) + 0U] & 0xFFU) << 24) |
+          ((src[(i << 2) + 1U] & 0xFFU) << 16) |
+          ((src[(i << 2) + 2U] & 0xFFU) <<  8) |
+          ((src[(i << 2) + 3U] & 0xFFU));
+ }
+ return RRPGE_M_SER_BLK;
+}
+
+
+
+/* Emits literals for the packer, returns new output position. */
+static auint rrpge_m_ser_lit(uint8 const* src, auint beg, auint end, uint8* dst, auint o)
+{
+ auint n;
+
+ while (beg != end){
+  n = end - beg;
+  if (n > 128U){ n = 128U; }
+  dst[o] = (uint8)(n - 1U);
+  o ++;
+  while (n != 0U){
+   dst[o] = src[beg];
+   o ++;
+   beg ++;
+   n --;
+  }
+ }
+ return o;
+}
+
+
+
+/* Packs a block, returns the packed size (at most RRPGE_M_SER_PKB). The hash
+** table (1 << RRPGE_M_SER_HSB entries) is used as work area. */
+static auint rrpge_m_ser_pack(uint8 const* src, auint len, uint8* dst, uint16* htb)
+{
+ auint i;
+ auint l;   /* Start of pending literals */
+ auint o;   /* Output position */
+ auint n;
+ auint h;
+ auint p;
+
+ for (i = 0U; i < (1U << RRPGE_M_SER_HSB); i++){ htb[i] = 0U; }
+
+ i = 0U;
+ l = 0U;
+ o = 0U;
+
+ while (i < len){
+
+  /* Zero run (a block is short enough for the 14 bit length) */
+
+  if (src[i] == 0U){
+   n = i + 1U;
+   while ((n < len) && (src[n] == 0U)){ n ++; }
+   if ((n - i) >= 4U){
+    o = rrpge_m_ser_lit(src, l, i, dst, o);
+    n -= i;
+    dst[o     ] = 0x80U | (((n - 1U) >> 8) & 0x3FU);
+    dst[o + 1U] = (n - 1U) & 0xFFU;
+    o += 2U;
+    i += n;
+    l  = i;
+    continue;
+   }
+  }
+
+  /* Match */
+
+  if ((i + 4U) <= len){
+   h = ((src[i     ] & 0xFFU) << 24) |
+       ((src[i + 1U] & 0xFFU) << 16) |
+       ((src[i + 2U] & 0xFFU) <<  8) |
+       ((src[i + 3U] & 0xFFU));
+   h = ((h * 2654435761U) & 0xFFFFFFFFU) >> (32U - RRPGE_M_SER_HSB);
+   p = htb[h];
+   htb[h] = (uint16)(i + 1U);
+   if (p != 0U){
+    p --;
+    n = 0U;
+    while ( ((i + n) < len) &&
+            (n < 67U) &&
+            (src[p + n] == src[i + n]) ){ n ++; }
+    if (n >= 4U){
+     o = rrpge_m_ser_lit(src, l, i, dst, o);
+     p = i - p;
+     dst[o     ] = 0xC0U | (n - 4U);
+     dst[o + 1U] = (p >> 8) & 0xFFU;
+     dst[o + 2U] = (p     ) & 0xFFU;
+     o += 3U;
+     i += n;
+     l  = i;
+     continue;
+    }
+   }
+  }
+
+  i ++;
+ }
+
+ return rrpge_m_ser_lit(src, l, len, dst, o);
+}
+
+
+
+/* Unpacks a block. Returns nonzero if the packed data is valid and produces
+** exactly len bytes. */
+static auint rrpge_m_ser_unpack(uint8 const* src, auint siz, uint8* dst, auint len)
+{
+ auint i = 0U;
+ auint o = 0U;
+ auint n;
+ auint p;
+ auint c;
+
+ while (i < siz){
+  c = src[i];
+  i ++;
+
+  if       (c < 0x80U){     /* Literals */
+   n = c + 1U;
+   if (((i + n) > siz) || ((o + n) > len)){ return 0U; }
+   while (n != 0U){
+    dst[o] = src[i];
+    o ++;
+    i ++;
+    n --;
+   }
+
+  }else if (c < 0xC0U){     /* Zero run (a block is short enough for the 14 bit length) */
+   if (i >= siz){ return 0U; }
+   n = (((c & 0x3FU) << 8) | (src[i] & 0xFFU)) + 1U;
+   i ++;
+   if ((o + n) > len){ return 0U; }
+   while (n != 0U){
+    dst[o] = 0U;
+    o ++;
+    n --;
+   }
+
+  }else{                    /* Match */
+   if ((i + 2U) > siz){ return 0U; }
+   n = (c & 0x3FU) + 4U;
+   p = ((src[i] & 0xFFU) << 8) | (src[i + 1U] & 0xFFU);
+   i += 2U;
+   if ((p == 0U) || (p > o) || ((o + n) > len)){ return 0U; }
+   while (n != 0U){
+    dst[o] = dst[o - p];
+    o ++;
+    n --;
+   }
+  }
+ }
+
+ return (o == len);
+}
+
+
+
+/* Compressed state serialization - Implementation of RRPGE library function */
+rrpge_iuint rrpge_state2cmp(rrpge_state_t const* src, rrpge_wrstream_t* wr, void* ctx)
+{
+ uint8  raw[RRPGE_M_SER_BLK];
+ uint8  pkb[RRPGE_M_SER_PKB + 2U];
+ uint16 htb[1U << RRPGE_M_SER_HSB];
+ auint  blk;
+ auint  len;
+ auint  siz;
+ auint  tot;
+
+ if (!wr(ctx, &(rrpge_m_ser_mag[0]), 4U)){ return 0U; }
+ tot = 4U;
+
+ for (blk = 0U; blk < (1U + RRPGE_M_SER_DRB + RRPGE_M_SER_PRB); blk++){
+  len = rrpge_m_ser_blkget(src, blk, &(raw[0]));
+  siz = rrpge_m_ser_pack(&(raw[0]), len, &(pkb[2]), &(htb[0]));
+  pkb[0] = (siz >> 8) & 0xFFU;
+  pkb[1] = (siz     ) & 0xFFU;
+  if (!wr(ctx, &(pkb[0]), siz + 2U)){ return 0U; }
+  tot += siz + 2U;
+ }
+
+ return tot;
+}
+
+
+
+/* Compressed state deserialization - Implementation of RRPGE library function */
+rrpge_iuint rrpge_cmp2state(rrpge_rdstream_t* rd, void* ctx, rrpge_state_t* dst)
+{
+ uint8  raw[RRPGE_M_SER_BLK];
+ uint8  pkb[RRPGE_M_SER_PKB];
+ auint  blk;
+ auint  len;
+ auint  siz;
+
+ if (rd(ctx, &(pkb[0]), 4U) != 4U){ return RRPGE_ERR_VER; }
+ for (siz = 0U; siz < 4U; siz++){
+  if (pkb[siz] != rrpge_m_ser_mag[siz]){ return RRPGE_ERR_VER; }
+ }
+
+ for (blk = 0U; blk < (1U + RRPGE_M_SER_DRB + RRPGE_M_SER_PRB); blk++){
+  if (rd(ctx, &(pkb[0]), 2U) != 2U){ return RRPGE_ERR_UNK; }
+  siz = ((pkb[0] & 0xFFU) << 8) | (pkb[1] & 0xFFU);
+  if (siz > RRPGE_M_SER_PKB){ return RRPGE_ERR_UNK; }
+  if (rd(ctx, &(pkb[0]), siz) != siz){ return RRPGE_ERR_UNK; }
+  len = (blk == 0U) ? sizeof(dst->stat) : RRPGE_M_SER_BLK;
+  if (!rrpge_m_ser_unpack(&(pkb[0]), siz, &(raw[0]), len)){ return RRPGE_ERR_UNK; }
+  rrpge_m_ser_blkput(dst, blk, &(raw[0]));
+ }
+
+ return RRPGE_ERR_OK;
+}
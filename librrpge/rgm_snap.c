@@ -0,0 +1,170 @@
+/**
+**  \file
+**  \brief     Native layout snapshots of the emulation instance
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.12
+*/
+
+
+#include "rgm_snap.h"
+#include "rgm_drty.h"
+
+
+
+/* Saves the component state of an emulation instance. */
+void  rrpge_m_snap_cmp_save(rrpge_object_t const* hnd, rrpge_m_snap_cmp_t* dst)
+{
+ auint i;
+
+ for (i = 0U; i < 4096U; i++){ dst->recb[i] = hnd->recb[i]; }
+ for (i = 0U; i <  512U; i++){ dst->reci[i] = hnd->reci[i]; }
+ for (i = 0U; i <   64U; i++){ dst->recl[i] = hnd->recl[i]; }
+
+ dst->cpu    = hnd->cpu;
+ dst->prm    = hnd->prm;
+ dst->vid    = hnd->vid;
+ dst->acc    = hnd->acc;
+ dst->dev    = hnd->dev;
+ dst->mix    = hnd->mix;
+ dst->aud    = hnd->aud;
+
+ dst->hlt    = hnd->hlt;
+ dst->rebr   = hnd->rebr;
+ dst->rebw   = hnd->rebw;
+ dst->reir   = hnd->reir;
+ dst->reiw   = hnd->reiw;
+ dst->tsfl   = hnd->tsfl;
+ dst->kfc    = hnd->kfc;
+ dst->prng   = hnd->prng;
+ dst->cyf[0] = hnd->cyf[0];
+ dst->cyf[1] = hnd->cyf[1];
+}
+
+
+
+/* Loads the component state into an emulation instance, keeping the host
+** set properties of it. The instance must be initialized with the same
+** application. */
+void  rrpge_m_snap_cmp_load(rrpge_object_t* hnd, rrpge_m_snap_cmp_t const* src)
+{
+ auint i;
+ auint hle = hnd->cpu.hle;
+ auint prf = hnd->cpu.prf;
+
+ for (i = 0U; i < 4096U; i++){ hnd->recb[i] = src->recb[i]; }
+ for (i = 0U; i <  512U; i++){ hnd->reci[i] = src->reci[i]; }
+ for (i = 0U; i <   64U; i++){ hnd->recl[i] = src->recl[i]; }
+
+ hnd->cpu    = src->cpu;
+ hnd->prm    = src->prm;
+ hnd->vid    = src->vid;
+ hnd->acc    = src->acc;
+ hnd->dev    = src->dev;
+ hnd->mix    = src->mix;
+ hnd->aud    = src->aud;
+
+ hnd->hlt    = src->hlt;
+ hnd->rebr   = src->rebr;
+ hnd->rebw   = src->rebw;
+ hnd->reir   = src->reir;
+ hnd->reiw   = src->reiw;
+ hnd->tsfl   = src->tsfl;
+ hnd->kfc    = src->kfc;
+ hnd->prng   = src->prng;
+ hnd->cyf[0] = src->cyf[0];
+ hnd->cyf[1] = src->cyf[1];
+
+ /* Host set properties of the CPU emulation are kept, and the pre-decoded
+ ** record pointer has to point in this instance */
+
+ hnd->cpu.hle = hle;
+ hnd->cpu.prf = prf;
+ hnd->cpu.dec = &(hnd->cdec[hnd->cpu.pc & 0xFFFFU]);
+}
+
+
+
+/* Copies the component state of an emulation instance into another using
+** the same application, keeping the host set properties of the target (like
+** rrpge_m_snap_cmp_load()). */
+void  rrpge_m_snap_cmp_copy(rrpge_object_t* hnd, rrpge_object_t const* src)
+{
+ auint i;
+ auint hle = hnd->cpu.hle;
+ auint prf = hnd->cpu.prf;
+
+ for (i = 0U; i < 4096U; i++){ hnd->recb[i] = src->recb[i]; }
+ for (i = 0U; i <  512U; i++){ hnd->reci[i] = src->reci[i]; }
+ for (i = 0U; i <   64U; i++){ hnd->recl[i] = src->recl[i]; }
+
+ hnd->cpu    = src->cpu;
+ hnd->prm    = src->prm;
+ hnd->vid    = src->vid;
+ hnd->acc    = src->acc;
+ hnd->dev    = src->dev;
+ hnd->mix    = src->mix;
+ hnd->aud    = src->aud;
+
+ hnd->hlt    = src->hlt;
+ hnd->rebr   = src->rebr;
+ hnd->rebw   = src->rebw;
+ hnd->reir   = src->reir;
+ hnd->reiw   = src->reiw;
+ hnd->tsfl   = src->tsfl;
+ hnd->kfc    = src->kfc;
+ hnd->prng   = src->prng;
+ hnd->cyf[0] = src->cyf[0];
+ hnd->cyf[1] = src->cyf[1];
+
+ /* The pre-decoded record pointer is moved into this instance's decoded
+ ** code at the same position (it is not necessarily at the PC) */
+
+ hnd->cpu.hle = hle;
+ hnd->cpu.prf = prf;
+ hnd->cpu.dec = &(hnd->cdec[(src->cpu.dec - src->cdec) & 0xFFFFU]);
+}
+
+
+
+/* Gets the size of snapshots - implementation of RRPGE library function */
+rrpge_iuint rrpge_snapsize(void)
+{
+ return sizeof(rrpge_m_snap_t);
+}
+
+
+
+/* Takes a snapshot - implementation of RRPGE library function */
+void rrpge_snapshot(rrpge_object_t* hnd, void* buf)
+{
+ rrpge_m_snap_t* snp = (rrpge_m_snap_t*)(buf);
+
+ snp->siz = sizeof(rrpge_m_snap_t);
+ snp->app = hnd->app->sum;
+
+ rrpge_m_snap_cmp_save(hnd, &(snp->cmp));
+ snp->st = hnd->st;
+}
+
+
+
+/* Restores a snapshot - implementation of RRPGE library function */
+rrpge_iuint rrpge_restore(rrpge_object_t* hnd, void const* buf)
+{
+ rrpge_m_snap_t const* snp = (rrpge_m_snap_t const*)(buf);
+
+ if ((hnd->inss != RRPGE_INI_RESET) || (hnd->insm != 0U)){ return RRPGE_ERR_INI; }
+ if (hnd->rlg != RRPGE_M_NULL){ return RRPGE_ERR_INI; } /* Can not be logged */
+ if (snp->siz != sizeof(rrpge_m_snap_t)){ return RRPGE_ERR_VER; }
+ if (snp->app != hnd->app->sum){ return RRPGE_ERR_VER; }
+
+ rrpge_m_snap_cmp_load(hnd, &(snp->cmp));
+ hnd->st = snp->st;
+ rrpge_m_drty_all(hnd);
+
+ return RRPGE_ERR_OK;
+}
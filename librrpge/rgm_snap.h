@@ -0,0 +1,79 @@
+/**
+**  \file
+**  \brief     Native layout snapshots of the emulation instance
+**  \author    Sandor Zsuga (Jubatian)
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
+**             License) extended as RRPGEvt (temporary version of the RRPGE
+**             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
+**             root.
+**  \date      2015.10.12
+**
+**
+**  A snapshot is the emulation state of an instance copied as-is, so it is
+**  only valid within the same build of the library (and process, as the CPU
+**  emulation structure holds function pointers). Instance properties set by
+**  the host (callbacks, breakpoints, profiling, native User Library) and the
+**  application image are not part of it.
+*/
+
+
+#ifndef RRPGE_M_SNAP_H
+#define RRPGE_M_SNAP_H
+
+
+#include "rgm_info.h"
+#include "rrpge.h"
+
+
+/* Component state of the emulation: everything except the emulator state
+** (rrpge_state_t: memories and Application state) */
+typedef struct{
+ uint16 recb[4096U];   /* Receive data buffer for network packets */
+ uint16 reci[512U];    /* Receive source ID buffer */
+ auint  recl[64U];     /* Receive packet length buffer */
+ rrpge_m_cpu_t cpu;
+ rrpge_m_prm_t prm;
+ rrpge_m_vid_t vid;
+ rrpge_m_acc_t acc;
+ rrpge_m_dev_t dev;
+ rrpge_m_mix_t mix;
+ rrpge_m_aud_t aud;
+ auint  hlt;
+ auint  rebr;
+ auint  rebw;
+ auint  reir;
+ auint  reiw;
+ auint  tsfl;
+ auint  kfc;
+ auint  prng;
+ auint  cyf[2];
+}rrpge_m_snap_cmp_t;
+
+
+/* Complete snapshot */
+typedef struct{
+ auint  siz;           /* Size of the snapshot for sanity checking */
+ auint  app;           /* Application checksum, so a snapshot is only
+                       ** restored for the same application */
+ rrpge_m_snap_cmp_t cmp;
+ rrpge_state_t st;
+}rrpge_m_snap_t;
+
+
+/* Saves the component state of an emulation instance. */
+void  rrpge_m_snap_cmp_save(rrpge_object_t const* hnd, rrpge_m_snap_cmp_t* dst);
+
+
+/* Loads the component state into an emulation instance, keeping the host
+** set properties of it. The instance must be initialized with the same
+** application. */
+void  rrpge_m_snap_cmp_load(rrpge_object_t* hnd, rrpge_m_snap_cmp_t const* src);
+
+
+/* Copies the component state of an emulation instance into another using
+** the same application, keeping the host set properties of the target (like
+** rrpge_m_snap_cmp_load()). */
+void  rrpge_m_snap_cmp_copy(rrpge_object_t* hnd, rrpge_object_t const* src);
+
+
+#endif
@@ -17,26 +17,23 @@
 #define STAT_LEN 0x400U
 
 
-/* Initialized? */
-static auint rrpge_m_stat_isinit = 0U;
+/* Handlers of a cell. The Read and Write handlers share their base offset
+** as they are always added together, similarly the Get and Set handlers. The
+** members used for bus accesses are placed first so a bus access normally
+** only touches a single cache line. */
+typedef struct{
+ rrpge_m_stat_readh_t*  readf;  /* Read handler */
+ rrpge_m_stat_writeh_t* writef; /* Write handler */
+ uint16                 rwb;    /* Base offset for the Read & Write handlers */
+ uint16                 acb;    /* Base offset for the Get & Set handlers */
+ rrpge_m_stat_geth_t*   getf;   /* Get handler */
+ rrpge_m_stat_seth_t*   setf;   /* Set handler */
+}rrpge_m_stat_hnd_t;
 
 
-/* Table of read handlers */
-static rrpge_m_stat_readh_t*  rrpge_m_stat_readf[STAT_LEN];
-/* Base offsets for each get handler */
-static auint                  rrpge_m_stat_readb[STAT_LEN];
-/* Table of write handlers */
-static rrpge_m_stat_writeh_t* rrpge_m_stat_writef[STAT_LEN];
-/* Base offsets for each set handler */
-static auint                  rrpge_m_stat_writeb[STAT_LEN];
-/* Table of get handlers */
-static rrpge_m_stat_geth_t*   rrpge_m_stat_getf[STAT_LEN];
-/* Base offsets for each get handler */
-static auint                  rrpge_m_stat_getb[STAT_LEN];
-/* Table of set handlers */
-static rrpge_m_stat_seth_t*   rrpge_m_stat_setf[STAT_LEN];
-/* Base offsets for each set handler */
-static auint                  rrpge_m_stat_setb[STAT_LEN];
+/* Table of handlers. It is built by the component initializers called from
+** rrpge_init_lib(), afterwards it is only read. */
+static rrpge_m_stat_hnd_t rrpge_m_stat_hnd[STAT_LEN];
 
 
 
@@ -48,7 +45,7 @@ static auint                  rrpge_m_stat_setb[STAT_LEN];
 /* Default get handler */
 RRPGE_M_FASTCALL static auint rrpge_m_stat_def_get(rrpge_object_t* hnd, auint adr){
  if (adr >= STAT_LEN){ return 0U; }
- return rrpge_m_stat_readf[adr](hnd, adr - rrpge_m_stat_readb[adr], 0U);
+ return rrpge_m_stat_hnd[adr].readf(hnd, adr - rrpge_m_stat_hnd[adr].rwb, 0U);
 }
 /* Default set handler (can use the normal write function) */
 #define rrpge_m_stat_def_set rrpge_m_stat_write
@@ -68,23 +65,19 @@ RRPGE_M_FASTCALL static void  rrpge_m_stat_def_write(rrpge_object_t* hnd, auint
 }
 
 
-/* Initializator */
-static void rrpge_m_stat_init(void)
+/* Initializes the handler table to the default handlers. */
+void  rrpge_m_stat_init(void)
 {
  auint i;
 
  for (i = 0U; i < STAT_LEN; i++){
-  rrpge_m_stat_readf[i]  = &rrpge_m_stat_def_read;
-  rrpge_m_stat_readb[i]  = 0U;
-  rrpge_m_stat_writef[i] = &rrpge_m_stat_def_write;
-  rrpge_m_stat_writeb[i] = 0U;
-  rrpge_m_stat_getf[i]   = &rrpge_m_stat_def_get;
-  rrpge_m_stat_getb[i]   = 0U;
-  rrpge_m_stat_setf[i]   = &rrpge_m_stat_def_set;
-  rrpge_m_stat_setb[i]   = 0U;
+  rrpge_m_stat_hnd[i].readf  = &rrpge_m_stat_def_read;
+  rrpge_m_stat_hnd[i].writef = &rrpge_m_stat_def_write;
+  rrpge_m_stat_hnd[i].rwb    = 0U;
+  rrpge_m_stat_hnd[i].acb    = 0U;
+  rrpge_m_stat_hnd[i].getf   = &rrpge_m_stat_def_get;
+  rrpge_m_stat_hnd[i].setf   = &rrpge_m_stat_def_set;
  }
-
- rrpge_m_stat_isinit = 1U;
 }
 
 
@@ -94,7 +87,7 @@ RRPGE_M_FASTCALL auint rrpge_m_stat_get(rrpge_object_t* hnd, auint adr)
 {
  if (adr >= STAT_LEN){ return 0U; }
 
- return rrpge_m_stat_getf[adr](hnd, adr - rrpge_m_stat_getb[adr]);
+ return rrpge_m_stat_hnd[adr].getf(hnd, adr - rrpge_m_stat_hnd[adr].acb);
 }
 
 
@@ -105,7 +98,7 @@ RRPGE_M_FASTCALL void  rrpge_m_stat_set(rrpge_object_t* hnd, auint adr, auint va
 {
  if (adr >= STAT_LEN){ return; }
 
- rrpge_m_stat_setf[adr](hnd, adr - rrpge_m_stat_setb[adr], val);
+ rrpge_m_stat_hnd[adr].setf(hnd, adr - rrpge_m_stat_hnd[adr].acb, val);
 }
 
 
@@ -115,7 +108,7 @@ RRPGE_M_FASTCALL auint rrpge_m_stat_read(rrpge_object_t* hnd, auint adr, auint r
 {
  if (adr >= STAT_LEN){ return 0U; }
 
- return rrpge_m_stat_readf[adr](hnd, adr - rrpge_m_stat_readb[adr], rmw);
+ return rrpge_m_stat_hnd[adr].readf(hnd, adr - rrpge_m_stat_hnd[adr].rwb, rmw);
 }
 
 
@@ -125,7 +118,7 @@ RRPGE_M_FASTCALL void  rrpge_m_stat_write(rrpge_object_t* hnd, auint adr, auint
 {
  if (adr >= STAT_LEN){ return; }
 
- rrpge_m_stat_writef[adr](hnd, adr - rrpge_m_stat_writeb[adr], val);
+ rrpge_m_stat_hnd[adr].writef(hnd, adr - rrpge_m_stat_hnd[adr].rwb, val);
 }
 
 
@@ -137,16 +130,13 @@ void  rrpge_m_stat_add_rw_handler(rrpge_m_stat_readh_t* readh,
 {
  auint i;
 
- if (!rrpge_m_stat_isinit){ rrpge_m_stat_init(); }
-
  if (adr >= STAT_LEN){ return; }
  if (adr + len >= STAT_LEN){ len = STAT_LEN - adr; }
 
  for (i = adr; i < (adr + len); i++){
-  rrpge_m_stat_readf[i]  = readh;
-  rrpge_m_stat_readb[i]  = adr;
-  rrpge_m_stat_writef[i] = writeh;
-  rrpge_m_stat_writeb[i] = adr;
+  rrpge_m_stat_hnd[i].readf  = readh;
+  rrpge_m_stat_hnd[i].writef = writeh;
+  rrpge_m_stat_hnd[i].rwb    = adr;
  }
 }
 
@@ -160,15 +150,12 @@ void  rrpge_m_stat_add_ac_handler(rrpge_m_stat_geth_t* geth,
 {
  auint i;
 
- if (!rrpge_m_stat_isinit){ rrpge_m_stat_init(); }
-
  if (adr >= STAT_LEN){ return; }
  if (adr + len >= STAT_LEN){ len = STAT_LEN - adr; }
 
  for (i = adr; i < (adr + len); i++){
-  rrpge_m_stat_getf[i] = geth;
-  rrpge_m_stat_getb[i] = adr;
-  rrpge_m_stat_setf[i] = seth;
-  rrpge_m_stat_setb[i] = adr;
+  rrpge_m_stat_hnd[i].getf = geth;
+  rrpge_m_stat_hnd[i].setf = seth;
+  rrpge_m_stat_hnd[i].acb  = adr;
  }
 }
@@ -24,9 +24,10 @@
 **
 **  By default every location ignores writes and returns zero.
 **
-**  Note that it assumes at least one call to rrpge_m_stat_add_rw_handler()
-**  or rrpge_m_stat_ac_handler() before use, which should be utilized to
-**  initialize.
+**  The function table is built once by rrpge_init_lib(): it first calls
+**  rrpge_m_stat_init(), then the initializers of the components which add
+**  their handlers. Afterwards the table is only read, so emulation instances
+**  may use it concurrently.
 */
 
 
@@ -60,6 +61,11 @@ typedef RRPGE_M_FASTCALL auint rrpge_m_stat_readh_t (rrpge_object_t* hnd, auint
 typedef RRPGE_M_FASTCALL void  rrpge_m_stat_writeh_t (rrpge_object_t* hnd, auint adr, auint val);
 
 
+/* Initializes the handler table to the default handlers. Must be called
+** before adding any handlers. */
+void  rrpge_m_stat_init(void);
+
+
 /* Retrieve the content of a cell in the state using the get handler. */
 RRPGE_M_FASTCALL auint rrpge_m_stat_get(rrpge_object_t* hnd, auint adr);
 
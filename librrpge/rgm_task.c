@@ -12,6 +12,8 @@
 
 #include "rgm_task.h"
 #include "rgm_halt.h"
+#include "rgm_drty.h"
+#include "rgm_rlog.h"
 
 
 
@@ -92,13 +94,63 @@ auint rrpge_m_taskcheck(uint16 const* d, auint n)
 
 
 
+/* Gets the Data memory areas a kernel task outputs into. Fills up to 2
+** start - length pairs into 'rng', returns the number of areas. 'n' is the
+** task (0-15, unchecked). */
+auint rrpge_m_task_outs(rrpge_object_t const* hnd, auint n, auint* rng)
+{
+ uint16 const* tskp = &(hnd->st.stat[RRPGE_STA_KTASK + (n << 4)]);
+
+ switch (tskp[0]){
+  case 0x00U:   /* Loading binary data page */
+  case 0x03U:   /* Find next file */
+   rng[0] = tskp[1] & 0xFFFFU;
+   rng[1] = tskp[2] & 0xFFFFU;
+   return 1U;
+  case 0x01U:   /* Loading page from file */
+   rng[0] = tskp[1] & 0xFFFFU;
+   rng[1] = ((tskp[2] & 0xFFFFU) + 1U) >> 1;
+   return 1U;
+  case 0x21U:   /* Get UTF-8 representation of User ID */
+   rng[0] = tskp[1] & 0xFFFFU;
+   rng[1] = tskp[2] & 0xFFFFU;
+   rng[2] = tskp[3] & 0xFFFFU;
+   rng[3] = tskp[4] & 0xFFFFU;
+   return 2U;
+  case 0x2AU:   /* List accessible users */
+   rng[0] = tskp[1] & 0xFFFFU;
+   rng[1] = (tskp[2] & 0xFFFFU) << 3;
+   return 1U;
+  default:      /* Other tasks don't output into the Data memory */
+   return 0U;
+ }
+}
+
+
+
+/* Marks the Data memory areas a kernel task outputs into dirty. The host
+** may fill these any time until the task ends, so this is used when ending
+** it. 'n' is the task (0-15, unchecked). */
+void rrpge_m_task_drty(rrpge_object_t* hnd, auint n)
+{
+ auint rng[4];
+ auint c = rrpge_m_task_outs(hnd, n, &(rng[0]));
+ auint i;
+
+ for (i = 0U; i < c; i++){
+  rrpge_m_drty_dram_rng(hnd, rng[(i << 1) + 0U], rng[(i << 1) + 1U]);
+ }
+}
+
+
+
 /* Schedule kernel tasks if any is waiting to be started. This includes all
 ** preparatory actions for the particular task (such as clearing memories),
 ** calling the appropriate handler (callback), and setting task state
-** indicating it is scheduled. Technically this is a part of rrpge_run(),
-** excepts rrpge_m_info to be set up, it is just seperated for manageability.
+** indicating it is scheduled. Technically this is a part of rrpge_run(), it
+** is just seperated for manageability.
 ** It generates RRPGE_HLT_FAULT causes if it fails (shouldn't happen). */
-void rrpge_m_tasksched(void)
+void rrpge_m_tasksched(rrpge_object_t* hnd)
 {
  auint i;
  uint16* tskp;
@@ -113,17 +165,22 @@ void rrpge_m_tasksched(void)
 
 
  for (i = 0U; i < 16U; i++){
-  if ( ((rrpge_m_edat->st.stat[RRPGE_STA_KTASK + 0xFU + (i << 4)] & 0xFFFFU) == 0x0001U) &&
-       ((rrpge_m_edat->tsfl & (1U << i)) == 0) ){
+  if ( ((hnd->st.stat[RRPGE_STA_KTASK + 0xFU + (i << 4)] & 0xFFFFU) == 0x0001U) &&
+       ((hnd->tsfl & (1U << i)) == 0) ){
 
    /* Kernel task is waiting to be dispatched, so do it! It's parameter 0
    ** provides the type to select the appropriate host callback. */
 
-   rrpge_m_edat->tsfl |= (1U << i); /* Task is marked running (rrpge_taskend()
+   hnd->tsfl |= (1U << i); /* Task is marked running (rrpge_taskend()
                                     ** will clear this or any reset. */
 
-   if (rrpge_m_taskcheck(&(rrpge_m_edat->st.stat[0]), i)){ /* Check if task has proper parameters */
-    rrpge_m_halt_set(rrpge_m_edat, RRPGE_HLT_FAULT);
+   if (rrpge_m_taskcheck(&(hnd->st.stat[0]), i)){ /* Check if task has proper parameters */
+    rrpge_m_halt_set(hnd, RRPGE_HLT_FAULT);
+
+   }else if (rrpge_m_rlog_task(hnd, i)){
+
+    /* Replaying an input log: what the host did on the task was replayed
+    ** from the log. */
 
    }else{
 
@@ -131,104 +188,106 @@ void rrpge_m_tasksched(void)
     ** the emulated machine's memories. It is so safe to use the parameters to
     ** form memory pointers from. */
 
-    tskp = &(rrpge_m_edat->st.stat[RRPGE_STA_KTASK + (i << 4)]);
+    tskp = &(hnd->st.stat[RRPGE_STA_KTASK + (i << 4)]);
 
     switch (tskp[0]){
 
 
      case 0x00U:   /* Start loading binary data page */
 
-      cbp_loadbin.buf = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_loadbin.buf = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_loadbin.scw = tskp[2] & 0xFFFFU;
       cbp_loadbin.sow = ((tskp[3] & 0xFFFFU) << 16) + (tskp[4] & 0xFFFFU);
-      rrpge_m_edat->cb_tsk[RRPGE_CB_LOADBIN](rrpge_m_edat, i, &cbp_loadbin);
+      hnd->cb_tsk[RRPGE_CB_LOADBIN](hnd, i, &cbp_loadbin);
 
       break;
 
 
      case 0x01U:   /* Start loaing page from file */
 
-      cbp_load.buf = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_load.buf = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_load.scb = tskp[2] & 0xFFFFU;
       cbp_load.sob = ((tskp[3] & 0xFFFFU) << 16) + (tskp[4] & 0xFFFFU);
-      cbp_load.nam = &rrpge_m_edat->st.dram[tskp[5] & 0xFFFFU];
+      cbp_load.nam = &hnd->st.dram[tskp[5] & 0xFFFFU];
       cbp_load.ncw = tskp[6] & 0xFFFFU;
-      rrpge_m_edat->cb_tsk[RRPGE_CB_LOAD](rrpge_m_edat, i, &cbp_load);
+      hnd->cb_tsk[RRPGE_CB_LOAD](hnd, i, &cbp_load);
 
       break;
 
 
      case 0x02U:   /* Start saving page into file */
 
-      cbp_save.buf = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_save.buf = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_save.tcb = tskp[2] & 0xFFFFU;
       cbp_save.tob = ((tskp[3] & 0xFFFFU) << 16) + (tskp[4] & 0xFFFFU);
-      cbp_save.nam = &rrpge_m_edat->st.dram[tskp[5] & 0xFFFFU];
+      cbp_save.nam = &hnd->st.dram[tskp[5] & 0xFFFFU];
       cbp_save.ncw = tskp[6] & 0xFFFFU;
-      rrpge_m_edat->cb_tsk[RRPGE_CB_SAVE](rrpge_m_edat, i, &cbp_save);
+      hnd->cb_tsk[RRPGE_CB_SAVE](hnd, i, &cbp_save);
 
       break;
 
 
      case 0x03U:   /* Find next file */
 
-      cbp_next.nam = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_next.nam = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_next.ncw = tskp[2] & 0xFFFFU;
-      rrpge_m_edat->cb_tsk[RRPGE_CB_NEXT](rrpge_m_edat, i, &cbp_next);
+      hnd->cb_tsk[RRPGE_CB_NEXT](hnd, i, &cbp_next);
 
       break;
 
 
      case 0x04U:   /* Move a file */
 
-      cbp_move.tnm = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_move.tnm = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_move.tcw = tskp[2] & 0xFFFFU;
-      cbp_move.snm = &rrpge_m_edat->st.dram[tskp[3] & 0xFFFFU];
+      cbp_move.snm = &hnd->st.dram[tskp[3] & 0xFFFFU];
       cbp_move.scw = tskp[4] & 0xFFFFU;
-      rrpge_m_edat->cb_tsk[RRPGE_CB_MOVE](rrpge_m_edat, i, &cbp_move);
+      hnd->cb_tsk[RRPGE_CB_MOVE](hnd, i, &cbp_move);
 
       break;
 
 
      case 0x21U:   /* Get UTF-8 representation of User ID */
 
-      cbp_getutf.nam = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_getutf.nam = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_getutf.ncw = tskp[2] & 0xFFFFU;
-      cbp_getutf.ext = &rrpge_m_edat->st.dram[tskp[3] & 0xFFFFU];
+      cbp_getutf.ext = &hnd->st.dram[tskp[3] & 0xFFFFU];
       cbp_getutf.ecw = tskp[4] & 0xFFFFU;
-      cbp_getutf.id  = &rrpge_m_edat->st.dram[tskp[5] & 0xFFFFU];
-      rrpge_m_edat->cb_tsk[RRPGE_CB_GETUTF](rrpge_m_edat, i, &cbp_getutf);
+      cbp_getutf.id  = &hnd->st.dram[tskp[5] & 0xFFFFU];
+      hnd->cb_tsk[RRPGE_CB_GETUTF](hnd, i, &cbp_getutf);
 
       break;
 
 
      case 0x28U:   /* Send data to user */
 
-      cbp_send.buf = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_send.buf = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_send.bcw = tskp[2] & 0xFFFFU;
-      cbp_send.id  = &rrpge_m_edat->st.dram[tskp[3] & 0xFFFFU];
-      rrpge_m_edat->cb_tsk[RRPGE_CB_SEND](rrpge_m_edat, i, &cbp_send);
+      cbp_send.id  = &hnd->st.dram[tskp[3] & 0xFFFFU];
+      hnd->cb_tsk[RRPGE_CB_SEND](hnd, i, &cbp_send);
 
       break;
 
 
      case 0x2AU:   /* List accessible users */
 
-      cbp_listusers.buf = &rrpge_m_edat->st.dram[tskp[1] & 0xFFFFU];
+      cbp_listusers.buf = &hnd->st.dram[tskp[1] & 0xFFFFU];
       cbp_listusers.bcu = tskp[2] & 0xFFFFU;
-      cbp_listusers.id  = &rrpge_m_edat->st.dram[tskp[3] & 0xFFFFU];
-      rrpge_m_edat->cb_tsk[RRPGE_CB_LISTUSERS](rrpge_m_edat, i, &cbp_listusers);
+      cbp_listusers.id  = &hnd->st.dram[tskp[3] & 0xFFFFU];
+      hnd->cb_tsk[RRPGE_CB_LISTUSERS](hnd, i, &cbp_listusers);
 
       break;
 
 
      default:      /* Not a valid kernel function for tasks - invalid! (Should not get here) */
 
-      rrpge_m_halt_set(rrpge_m_edat, RRPGE_HLT_FAULT);
+      rrpge_m_halt_set(hnd, RRPGE_HLT_FAULT);
       break;
 
     }
 
+    rrpge_m_rlog_ret(hnd);
+
    }
   }
  }
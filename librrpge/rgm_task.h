@@ -31,13 +31,25 @@ RRPGE_M_FASTCALL auint rrpge_m_task_chkdata(auint off, auint len);
 auint rrpge_m_taskcheck(uint16 const* d, auint n);
 
 
+/* Gets the Data memory areas a kernel task outputs into. Fills up to 2
+** start - length pairs into 'rng', returns the number of areas. 'n' is the
+** task (0-15, unchecked). */
+auint rrpge_m_task_outs(rrpge_object_t const* hnd, auint n, auint* rng);
+
+
+/* Marks the Data memory areas a kernel task outputs into dirty. The host
+** may fill these any time until the task ends, so this is used when ending
+** it. 'n' is the task (0-15, unchecked). */
+void rrpge_m_task_drty(rrpge_object_t* hnd, auint n);
+
+
 /* Schedule kernel tasks if any is waiting to be started. This includes all
 ** preparatory actions for the particular task (such as clearing memories),
 ** calling the appropriate handler (callback), and setting task state
-** indicating it is scheduled. Technically this is a part of rrpge_run(),
-** excepts rrpge_m_info to be set up, it is just seperated for manageability.
+** indicating it is scheduled. Technically this is a part of rrpge_run(), it
+** is just seperated for manageability.
 ** It generates RRPGE_HLT_FAULT causes if it fails (shouldn't happen). */
-void rrpge_m_tasksched(void);
+void rrpge_m_tasksched(rrpge_object_t* hnd);
 
 
 #endif
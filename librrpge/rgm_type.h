@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.11
+**  \date      2015.10.12
 */
 
 
@@ -53,5 +53,30 @@ typedef unsigned int auint;
 #define RRPGE_M_FASTCALL
 #endif
 
+/* Atomic increment and decrement returning the new value, for reference
+** counts of objects shared by emulation instances which may be used from
+** different threads. Atomic compare and swap returning nonzero if the value
+** was swapped, and a full memory barrier, for one time initializations.
+** Without compiler support, the host has to serialize creating and deleting
+** such instances, and the initializations. */
+#if (defined (__GNUC__))
+#define RRPGE_M_ATOMIC_INC(x) (__sync_add_and_fetch(&(x), 1U))
+#define RRPGE_M_ATOMIC_DEC(x) (__sync_sub_and_fetch(&(x), 1U))
+#define RRPGE_M_ATOMIC_CAS(x, o, n) (__sync_bool_compare_and_swap(&(x), (o), (n)))
+#define RRPGE_M_ATOMIC_SYNC() (__sync_synchronize())
+#else
+#define RRPGE_M_ATOMIC_INC(x) ((x) += 1U)
+#define RRPGE_M_ATOMIC_DEC(x) ((x) -= 1U)
+#define RRPGE_M_ATOMIC_CAS(x, o, n) (((x) == (o)) ? (((x) = (n)), 1) : 0)
+#define RRPGE_M_ATOMIC_SYNC()
+#endif
+
+/* Threaded CPU dispatch using computed gotos (GCC's labels as values). If
+** not available, or RRPGE_M_NOTHREADED is defined, the function table
+** dispatch is used. */
+#if (defined (__GNUC__) && !defined(RRPGE_M_NOTHREADED))
+#define RRPGE_M_THREADED
+#endif
+
 
 #endif
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.10
+**  \date      2015.10.11
 */
 
 
@@ -16,6 +16,7 @@
 #include "rgm_halt.h"
 #include "rgm_stat.h"
 #include "rgm_fifo.h"
+#include "rgm_drty.h"
 
 
 
@@ -175,6 +176,7 @@ void  rrpge_m_vid_init(void)
                              RRPGE_STA_VARS + 0x10U, 1U);
  rrpge_m_stat_add_rw_handler(&rrpge_m_vid_stat_read_vlc,  &rrpge_m_vid_stat_write_vlc,
                              RRPGE_STA_VARS + 0x11U, 1U);
+ rrpge_m_vidl_init();
 }
 
 
@@ -197,7 +199,7 @@ void  rrpge_m_vid_initres(rrpge_object_t* hnd)
 
 /* Based on the cycles needing emulation, process the video, and the Graphics
 ** Display Generator's Display List clear function. Also calls back the line
-** renderer as needed. */
+** renderer, and the frame callback on the end of rendered frames. */
 void  rrpge_m_vid_proc(rrpge_object_t* hnd, auint cy)
 {
  auint a;
@@ -232,6 +234,11 @@ void  rrpge_m_vid_proc(rrpge_object_t* hnd, auint cy)
   hnd->vid.vln ++;
   hnd->vid.vln &= 0xFFFFU;
   if ((hnd->vid.vln >= 400U) && ((hnd->vid.vln & 0x8000U) == 0U)){
+   if ( (((hnd->vid.rena) & 0x2U) != 0U) &&
+        (hnd->frb != RRPGE_M_NULL) &&
+        (hnd->cb_frm != RRPGE_M_NULL) ){ /* Rendered frame completed */
+    hnd->cb_frm(hnd, hnd->frb);
+   }
    hnd->vid.vln = 0x10000U + 400U - RRPGE_M_VLN;
    hnd->vid.rena = (hnd->vid.rena & (~0x2U)) | /* Transfer requested render state */
                    ((hnd->vid.rena & (0x1U)) << 1);
@@ -265,6 +272,7 @@ void  rrpge_m_vid_proc(rrpge_object_t* hnd, auint cy)
     do{
      for (t = 0U; t < c; t++){ /* Clear */
       hnd->st.pram[a + o] = 0U;
+      rrpge_m_drty_pram(hnd, a + o);
       o  = (o + 1U) & 0xFFFFU;
       j --;
       if (j == 0U){ break; }
@@ -316,3 +324,21 @@ void rrpge_enarender(rrpge_object_t* hnd, rrpge_ibool tg)
  if (tg){ hnd->vid.rena = (hnd->vid.rena) |   1U;  }
  else   { hnd->vid.rena = (hnd->vid.rena) & (~1U); }
 }
+
+
+
+/* Set up frame rendering - implementation of RRPGE library function */
+void rrpge_setframe(rrpge_object_t* hnd, void* buf, rrpge_iuint pit,
+                    rrpge_iuint fmt, rrpge_cb_frame_t* cb)
+{
+ auint i;
+
+ if (fmt > RRPGE_PIX_XRGB8888){ fmt = RRPGE_PIX_IDX8; }
+
+ hnd->frb    = buf;
+ hnd->frp    = pit;
+ hnd->frf    = fmt;
+ hnd->cb_frm = cb;
+
+ for (i = 0U; i < 256U; i++){ rrpge_m_vidl_setpal(hnd, i); }
+}
@@ -6,13 +6,33 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.10
+**  \date      2015.10.12
 */
 
 
 #include "rgm_vidl.h"
 
 
+/* SIMD kernels (an exception to the freestanding C89 code, see CODING.rst).
+** They are only compiled by GCC compatible compilers targeting x86, which
+** supply the intrinsics headers, and not at all if RRPGE_M_NOSIMD is
+** defined. SSE2 is used if the compiler targets it, AVX2 is selected at
+** runtime if the compiler is capable to produce it (GCC 5 or later, for the
+** target attribute and the CPU detection builtins) and the CPU supports it.
+** In any other case the portable kernels are used (they are also the
+** reference for the SIMD ones). */
+#if (!defined(RRPGE_M_NOSIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#if (defined(__SSE2__))
+#define RRPGE_M_VIDL_SSE2
+#include <emmintrin.h>
+#if (__GNUC__ >= 5)
+#define RRPGE_M_VIDL_AVX2
+#include <immintrin.h>
+#endif
+#endif
+#endif
+
+
 /* Peripheral memory size in 32bit units.
 ** Must be a power of 2 and a multiple of 64K. */
 #define  PRAMS  RRPGE_M_PRAMS
@@ -57,6 +77,434 @@ static void rrpge_m_vidl_cbup(rrpge_object_t* hnd, auint id, auint tg)
 }
 
 
+/* Combines a run of source cells over the render buffer (portable kernel).
+** For each cell, the colorkey mask is created and added to the cell's mask,
+** the high half is calculated by the half-palette selects, then both halves
+** are combined over the destination. */
+static void rrpge_m_vidl_comb_c(uint32* bufl, uint32* bufh,
+                                uint32 const* src, uint32 const* msk, auint n,
+                                auint cky, auint plh, auint pll)
+{
+ auint i;
+ auint s;
+ auint m;
+ auint h;
+
+ for (i = 0U; i < n; i++){
+
+  s    = src[i];
+
+  m    = s ^ cky;                 /* Prepare for colorkey */
+  m    = (((m & 0x77777777U) + 0x77777777U) | m); /* Colorkey mask on the highest bit of pixel */
+  m   &= 0x88888888U;             /* Mask out lower pixel bits */
+  m    = (m - (m >> 3)) + m;      /* Expand to lower pixels */
+  m   &= msk[i];                  /* Add begin / end and clipping masks */
+
+  h    = s & 0x88888888U;
+  h    = h - (h >> 3);
+  h    = (plh & h) | (pll & (~h));
+
+  bufl[i] = (s & m) | (bufl[i] & (~m));
+  bufh[i] = (h & m) | (bufh[i] & (~m));
+
+ }
+}
+
+
+
+/* Combines the render buffer halves to produce 6 bit pixels for the 640
+** pixels wide output (portable kernel) */
+static void rrpge_m_vidl_exp_c(uint8* buf, uint32 const* bufl, uint32 const* bufh)
+{
+ auint i;
+ auint t0;
+ auint t1;
+ auint m0;
+
+ for (i = 0U; i < 80U; i++){
+  m0 = bufl[i];
+  t1 = bufh[i];
+  t0 = ((m0 & 0x07070707U)     ) | ((t1 & 0x07070707U) << 3);
+  t1 = ((m0 & 0x70707070U) >> 4) | ((t1 & 0x70707070U) >> 1);
+  m0 = i << 3;
+  buf[m0 + 0U] = (uint8)((t1 >> 24)        );
+  buf[m0 + 1U] = (uint8)((t0 >> 24)        );
+  buf[m0 + 2U] = (uint8)((t1 >> 16) & 0xFFU);
+  buf[m0 + 3U] = (uint8)((t0 >> 16) & 0xFFU);
+  buf[m0 + 4U] = (uint8)((t1 >>  8) & 0xFFU);
+  buf[m0 + 5U] = (uint8)((t0 >>  8) & 0xFFU);
+  buf[m0 + 6U] = (uint8)((t1      ) & 0xFFU);
+  buf[m0 + 7U] = (uint8)((t0      ) & 0xFFU);
+ }
+}
+
+
+
+/* Combines the render buffer halves like rrpge_m_vidl_exp_c(), producing 16
+** bit pixels for the 640 pixels wide output by the colors of the pixel
+** format (portable kernel) */
+static void rrpge_m_vidl_pix16_c(uint16* dst, uint32 const* bufl, uint32 const* bufh,
+                                uint32 const* col)
+{
+ auint i;
+ auint t0;
+ auint t1;
+ auint m0;
+
+ for (i = 0U; i < 80U; i++){
+  m0 = bufl[i];
+  t1 = bufh[i];
+  t0 = ((m0 & 0x07070707U)     ) | ((t1 & 0x07070707U) << 3);
+  t1 = ((m0 & 0x70707070U) >> 4) | ((t1 & 0x70707070U) >> 1);
+  m0 = i << 3;
+  dst[m0 + 0U] = (uint16)(col[(t1 >> 24)        ]);
+  dst[m0 + 1U] = (uint16)(col[(t0 >> 24)        ]);
+  dst[m0 + 2U] = (uint16)(col[(t1 >> 16) & 0xFFU]);
+  dst[m0 + 3U] = (uint16)(col[(t0 >> 16) & 0xFFU]);
+  dst[m0 + 4U] = (uint16)(col[(t1 >>  8) & 0xFFU]);
+  dst[m0 + 5U] = (uint16)(col[(t0 >>  8) & 0xFFU]);
+  dst[m0 + 6U] = (uint16)(col[(t1      ) & 0xFFU]);
+  dst[m0 + 7U] = (uint16)(col[(t0      ) & 0xFFU]);
+ }
+}
+
+
+
+/* Combines the render buffer halves like rrpge_m_vidl_exp_c(), producing 32
+** bit pixels for the 640 pixels wide output by the colors of the pixel
+** format (portable kernel) */
+static void rrpge_m_vidl_pix32_c(uint32* dst, uint32 const* bufl, uint32 const* bufh,
+                                uint32 const* col)
+{
+ auint i;
+ auint t0;
+ auint t1;
+ auint m0;
+
+ for (i = 0U; i < 80U; i++){
+  m0 = bufl[i];
+  t1 = bufh[i];
+  t0 = ((m0 & 0x07070707U)     ) | ((t1 & 0x07070707U) << 3);
+  t1 = ((m0 & 0x70707070U) >> 4) | ((t1 & 0x70707070U) >> 1);
+  m0 = i << 3;
+  dst[m0 + 0U] = col[(t1 >> 24)        ];
+  dst[m0 + 1U] = col[(t0 >> 24)        ];
+  dst[m0 + 2U] = col[(t1 >> 16) & 0xFFU];
+  dst[m0 + 3U] = col[(t0 >> 16) & 0xFFU];
+  dst[m0 + 4U] = col[(t1 >>  8) & 0xFFU];
+  dst[m0 + 5U] = col[(t0 >>  8) & 0xFFU];
+  dst[m0 + 6U] = col[(t1      ) & 0xFFU];
+  dst[m0 + 7U] = col[(t0      ) & 0xFFU];
+ }
+}
+
+
+
+#ifdef RRPGE_M_VIDL_SSE2
+
+/* Combines a run of source cells over the render buffer (SSE2 kernel, 4
+** cells per iteration) */
+static void rrpge_m_vidl_comb_sse2(uint32* bufl, uint32* bufh,
+                                   uint32 const* src, uint32 const* msk, auint n,
+                                   auint cky, auint plh, auint pll)
+{
+ auint   i;
+ __m128i s;
+ __m128i m;
+ __m128i h;
+ __m128i vky = _mm_set1_epi32((int)(cky));
+ __m128i vph = _mm_set1_epi32((int)(plh));
+ __m128i vpl = _mm_set1_epi32((int)(pll));
+ __m128i v7  = _mm_set1_epi32(0x77777777);
+ __m128i v8  = _mm_set1_epi32((int)(0x88888888U));
+
+ for (i = 0U; (i + 4U) <= n; i += 4U){
+
+  s = _mm_loadu_si128((__m128i const*)(&src[i]));
+
+  m = _mm_xor_si128(s, vky);
+  m = _mm_or_si128(_mm_add_epi32(_mm_and_si128(m, v7), v7), m);
+  m = _mm_and_si128(m, v8);
+  m = _mm_add_epi32(_mm_sub_epi32(m, _mm_srli_epi32(m, 3)), m);
+  m = _mm_and_si128(m, _mm_loadu_si128((__m128i const*)(&msk[i])));
+
+  h = _mm_and_si128(s, v8);
+  h = _mm_sub_epi32(h, _mm_srli_epi32(h, 3));
+  h = _mm_or_si128(_mm_and_si128(vph, h), _mm_andnot_si128(h, vpl));
+
+  _mm_storeu_si128((__m128i*)(&bufl[i]), _mm_or_si128(_mm_and_si128(s, m),
+                   _mm_andnot_si128(m, _mm_loadu_si128((__m128i const*)(&bufl[i])))));
+  _mm_storeu_si128((__m128i*)(&bufh[i]), _mm_or_si128(_mm_and_si128(h, m),
+                   _mm_andnot_si128(m, _mm_loadu_si128((__m128i const*)(&bufh[i])))));
+
+ }
+
+ rrpge_m_vidl_comb_c(&bufl[i], &bufh[i], &src[i], &msk[i], n - i, cky, plh, pll);
+}
+
+
+
+/* Combines the render buffer halves to produce 6 bit pixels (SSE2 kernel, 4
+** cells per iteration). The pixels of a cell pair are interleaved from the
+** low (odd pixels) and high (even pixels) nibbles, then put in display order
+** reversing the byte pairs (the CPU is little endian). */
+static void rrpge_m_vidl_exp_sse2(uint8* buf, uint32 const* bufl, uint32 const* bufh)
+{
+ auint   i;
+ __m128i l;
+ __m128i h;
+ __m128i t0;
+ __m128i t1;
+ __m128i v7  = _mm_set1_epi32(0x07070707);
+ __m128i v38 = _mm_set1_epi32(0x38383838);
+
+ for (i = 0U; i < 80U; i += 4U){
+
+  l  = _mm_loadu_si128((__m128i const*)(&bufl[i]));
+  h  = _mm_loadu_si128((__m128i const*)(&bufh[i]));
+  t0 = _mm_or_si128(_mm_and_si128(l, v7),
+                    _mm_slli_epi32(_mm_and_si128(h, v7), 3));
+  t1 = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(l, 4), v7),
+                    _mm_and_si128(_mm_srli_epi32(h, 1), v38));
+
+  l  = _mm_unpacklo_epi8(t1, t0);
+  h  = _mm_unpackhi_epi8(t1, t0);
+  l  = _mm_shufflehi_epi16(_mm_shufflelo_epi16(l, 0x1B), 0x1B);
+  h  = _mm_shufflehi_epi16(_mm_shufflelo_epi16(h, 0x1B), 0x1B);
+
+  _mm_storeu_si128((__m128i*)(&buf[(i << 3)      ]), l);
+  _mm_storeu_si128((__m128i*)(&buf[(i << 3) + 16U]), h);
+
+ }
+}
+
+#endif
+
+
+
+#ifdef RRPGE_M_VIDL_AVX2
+
+/* Combines a run of source cells over the render buffer (AVX2 kernel, 8
+** cells per iteration) */
+__attribute__((target("avx2")))
+static void rrpge_m_vidl_comb_avx2(uint32* bufl, uint32* bufh,
+                                   uint32 const* src, uint32 const* msk, auint n,
+                                   auint cky, auint plh, auint pll)
+{
+ auint   i;
+ __m256i s;
+ __m256i m;
+ __m256i h;
+ __m256i vky = _mm256_set1_epi32((int)(cky));
+ __m256i vph = _mm256_set1_epi32((int)(plh));
+ __m256i vpl = _mm256_set1_epi32((int)(pll));
+ __m256i v7  = _mm256_set1_epi32(0x77777777);
+ __m256i v8  = _mm256_set1_epi32((int)(0x88888888U));
+
+ for (i = 0U; (i + 8U) <= n; i += 8U){
+
+  s = _mm256_loadu_si256((__m256i const*)(&src[i]));
+
+  m = _mm256_xor_si256(s, vky);
+  m = _mm256_or_si256(_mm256_add_epi32(_mm256_and_si256(m, v7), v7), m);
+  m = _mm256_and_si256(m, v8);
+  m = _mm256_add_epi32(_mm256_sub_epi32(m, _mm256_srli_epi32(m, 3)), m);
+  m = _mm256_and_si256(m, _mm256_loadu_si256((__m256i const*)(&msk[i])));
+
+  h = _mm256_and_si256(s, v8);
+  h = _mm256_sub_epi32(h, _mm256_srli_epi32(h, 3));
+  h = _mm256_or_si256(_mm256_and_si256(vph, h), _mm256_andnot_si256(h, vpl));
+
+  _mm256_storeu_si256((__m256i*)(&bufl[i]), _mm256_or_si256(_mm256_and_si256(s, m),
+                      _mm256_andnot_si256(m, _mm256_loadu_si256((__m256i const*)(&bufl[i])))));
+  _mm256_storeu_si256((__m256i*)(&bufh[i]), _mm256_or_si256(_mm256_and_si256(h, m),
+                      _mm256_andnot_si256(m, _mm256_loadu_si256((__m256i const*)(&bufh[i])))));
+
+ }
+
+ rrpge_m_vidl_comb_sse2(&bufl[i], &bufh[i], &src[i], &msk[i], n - i, cky, plh, pll);
+}
+
+
+
+/* Combines the render buffer halves to produce 6 bit pixels (AVX2 kernel, 8
+** cells per iteration). Works like the SSE2 kernel, the unpacks operate
+** within the 128 bit lanes, so the lanes are reordered when storing. */
+__attribute__((target("avx2")))
+static void rrpge_m_vidl_exp_avx2(uint8* buf, uint32 const* bufl, uint32 const* bufh)
+{
+ auint   i;
+ __m256i l;
+ __m256i h;
+ __m256i t0;
+ __m256i t1;
+ __m256i v7  = _mm256_set1_epi32(0x07070707);
+ __m256i v38 = _mm256_set1_epi32(0x38383838);
+
+ for (i = 0U; i < 80U; i += 8U){
+
+  l  = _mm256_loadu_si256((__m256i const*)(&bufl[i]));
+  h  = _mm256_loadu_si256((__m256i const*)(&bufh[i]));
+  t0 = _mm256_or_si256(_mm256_and_si256(l, v7),
+                       _mm256_slli_epi32(_mm256_and_si256(h, v7), 3));
+  t1 = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(l, 4), v7),
+                       _mm256_and_si256(_mm256_srli_epi32(h, 1), v38));
+
+  l  = _mm256_unpacklo_epi8(t1, t0);
+  h  = _mm256_unpackhi_epi8(t1, t0);
+  l  = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(l, 0x1B), 0x1B);
+  h  = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(h, 0x1B), 0x1B);
+
+  _mm256_storeu_si256((__m256i*)(&buf[(i << 3)      ]), _mm256_permute2x128_si256(l, h, 0x20));
+  _mm256_storeu_si256((__m256i*)(&buf[(i << 3) + 32U]), _mm256_permute2x128_si256(l, h, 0x31));
+
+ }
+}
+
+
+
+/* Produces the palette indices of the 8 pixels of a cell pair in display
+** order, one in each 32 bit lane (for the AVX2 gather kernels) */
+__attribute__((target("avx2")))
+static __m256i rrpge_m_vidl_idx_avx2(auint l, auint h)
+{
+ __m256i vsh = _mm256_set_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+ __m256i v7  = _mm256_set1_epi32(7);
+
+ return _mm256_or_si256(
+         _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(l)), vsh), v7),
+         _mm256_slli_epi32(
+          _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(h)), vsh), v7), 3));
+}
+
+
+
+/* Combines the render buffer halves producing 16 bit pixels (AVX2 kernel, 2
+** cells per iteration). The colors are gathered as 32 bit values, then
+** packed (they are 16 bit for this pixel format, so the saturation of the
+** pack has no effect), reordering the 64 bit parts since the pack works
+** within the 128 bit lanes. */
+__attribute__((target("avx2")))
+static void rrpge_m_vidl_pix16_avx2(uint16* dst, uint32 const* bufl, uint32 const* bufh,
+                                   uint32 const* col)
+{
+ auint   i;
+ __m256i c0;
+ __m256i c1;
+
+ for (i = 0U; i < 80U; i += 2U){
+
+  c0 = _mm256_i32gather_epi32((int const*)(col),
+                              rrpge_m_vidl_idx_avx2(bufl[i     ], bufh[i     ]), 4);
+  c1 = _mm256_i32gather_epi32((int const*)(col),
+                              rrpge_m_vidl_idx_avx2(bufl[i + 1U], bufh[i + 1U]), 4);
+
+  _mm256_storeu_si256((__m256i*)(&dst[i << 3]),
+                      _mm256_permute4x64_epi64(_mm256_packus_epi32(c0, c1), 0xD8));
+
+ }
+}
+
+
+
+/* Combines the render buffer halves producing 32 bit pixels (AVX2 kernel, 1
+** cell per iteration) */
+__attribute__((target("avx2")))
+static void rrpge_m_vidl_pix32_avx2(uint32* dst, uint32 const* bufl, uint32 const* bufh,
+                                   uint32 const* col)
+{
+ auint i;
+
+ for (i = 0U; i < 80U; i++){
+  _mm256_storeu_si256((__m256i*)(&dst[i << 3]),
+                      _mm256_i32gather_epi32((int const*)(col),
+                                             rrpge_m_vidl_idx_avx2(bufl[i], bufh[i]), 4));
+ }
+}
+
+#endif
+
+
+
+/* Kernels in use: the portable kernels, unless rrpge_m_vidl_init() selects
+** SIMD kernels suiting the CPU */
+static void (*rrpge_m_vidl_comb)(uint32* bufl, uint32* bufh,
+                                 uint32 const* src, uint32 const* msk, auint n,
+                                 auint cky, auint plh, auint pll) = &rrpge_m_vidl_comb_c;
+static void (*rrpge_m_vidl_exp)(uint8* buf, uint32 const* bufl,
+                                uint32 const* bufh) = &rrpge_m_vidl_exp_c;
+static void (*rrpge_m_vidl_pix16)(uint16* dst, uint32 const* bufl,
+                                  uint32 const* bufh, uint32 const* col) = &rrpge_m_vidl_pix16_c;
+static void (*rrpge_m_vidl_pix32)(uint32* dst, uint32 const* bufl,
+                                  uint32 const* bufh, uint32 const* col) = &rrpge_m_vidl_pix32_c;
+
+
+
+/* Selects the line renderer kernels suiting the CPU. Without SIMD kernels
+** compiled the portable ones stay in use. */
+void rrpge_m_vidl_init(void)
+{
+#ifdef RRPGE_M_VIDL_SSE2
+ rrpge_m_vidl_comb  = &rrpge_m_vidl_comb_sse2;
+ rrpge_m_vidl_exp   = &rrpge_m_vidl_exp_sse2;
+#endif
+#ifdef RRPGE_M_VIDL_AVX2
+ __builtin_cpu_init();
+ if (__builtin_cpu_supports("avx2")){
+  rrpge_m_vidl_comb  = &rrpge_m_vidl_comb_avx2;
+  rrpge_m_vidl_exp   = &rrpge_m_vidl_exp_avx2;
+  rrpge_m_vidl_pix16 = &rrpge_m_vidl_pix16_avx2;
+  rrpge_m_vidl_pix32 = &rrpge_m_vidl_pix32_avx2;
+ }
+#endif
+}
+
+
+
+/* Converts a palette entry from the application state for the frame buffer's
+** pixel format. Called when the palette entry changes. */
+void rrpge_m_vidl_setpal(rrpge_object_t* hnd, auint id)
+{
+ auint c = hnd->st.stat[RRPGE_STA_PAL + (id & 0xFFU)];
+ auint r = (c >> 8) & 0xFU;
+ auint g = (c >> 4) & 0xFU;
+ auint b = (c     ) & 0xFU;
+
+ if       (hnd->frf == RRPGE_PIX_RGB565){
+  c = (((r << 1) | (r >> 3)) << 11) |
+      (((g << 2) | (g >> 2)) <<  5) |
+      (((b << 1) | (b >> 3))      );
+ }else if (hnd->frf == RRPGE_PIX_XRGB8888){
+  c = ((r * 0x11U) << 16) |
+      ((g * 0x11U) <<  8) |
+      ((b * 0x11U)      );
+ }else{
+  c = id & 0xFFU;
+ }
+
+ hnd->frc[id & 0xFFU] = c;
+}
+
+
+
+/* Combines a run of source cells (cell pairs) over the render buffer
+** starting at cell "beg", wrapping around at its end (128 cells, 64 cell
+** pairs). The run is combined in order, so if it overlaps itself after
+** wrapping around, the latter cells take precedence. */
+static void rrpge_m_vidl_run(uint32* bufl, uint32* bufh, auint beg,
+                             uint32 const* src, uint32 const* msk, auint n,
+                             auint cky, auint plh, auint pll)
+{
+ auint l = 128U - beg;
+
+ if (l > n){ l = n; }
+ rrpge_m_vidl_comb(&bufl[beg], &bufh[beg], src, msk, l, cky, plh, pll);
+ if (l < n){
+  rrpge_m_vidl_comb(&bufl[0], &bufh[0], &src[l], &msk[l], n - l, cky, plh, pll);
+ }
+}
+
+
 
 /* Renders current graphics line. Also performs callback to host. */
 void rrpge_m_vidl(rrpge_object_t* hnd)
@@ -64,6 +512,9 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
  uint32 bufl[128];             /* Render buffer, low half */
  uint32 bufh[128];             /* Render buffer, high half */
  uint8  buf [640];             /* Render buffer, output */
+ uint8* lout;                  /* Output line (buf or in the frame buffer) */
+ uint32 srcc[130];             /* Source cells of a run to combine */
+ uint32 srcm[130];             /* Masks of the source cells */
  uint32 const* dlin;           /* Display list line */
  uint32 const* sbnk;           /* Source PRAM bank */
  uint32 const* tbnk;           /* Tileset PRAM bank */
@@ -96,6 +547,8 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
  auint  pll;                   /* Low half-palette select expanded */
  auint  tds;                   /* Tile descriptor */
  auint  trow;                  /* Tile row XOR value for source offset generation */
+ auint  beg;                   /* Begin cell of a run in the render buffer */
+ auint  n;                     /* Number of cells in a run */
  auint  i;
  auint  t0;
  auint  t1;
@@ -106,6 +559,15 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
 
  if (hnd->vid.vln >= 400U){ return; }
 
+ /* At the beginning of a frame, bring the colors of the pixel format in sync
+ ** with the palette, which may have been replaced with the state */
+
+ if ( (hnd->vid.vln == 0U) &&
+      (hnd->frb != RRPGE_M_NULL) &&
+      (hnd->frf != RRPGE_PIX_IDX8) ){
+  for (i = 0U; i < 256U; i++){ rrpge_m_vidl_setpal(hnd, i); }
+ }
+
  /* Read display list offset & entry size */
 
  t0   = hnd->vid.dlat; /* Display list definition */
@@ -158,6 +620,14 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
 
  dlin += doff;
 
+ /* Output to the frame buffer if any, otherwise for the line callback */
+
+ if (hnd->frb != RRPGE_M_NULL){
+  lout = ((uint8*)(hnd->frb)) + ((hnd->vid.vln) * (hnd->frp));
+ }else{
+  lout = &buf[0];
+ }
+
  /* Render line if possible */
 
  if ( (dbl == 0U) ||
@@ -318,9 +788,11 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
      shr[0] = shr[2];
      shr[1] = shr[3];
 
-     /* Do the blitting loop */
+     /* Collect the source cells, then combine them over the render buffer.
+     ** Shift sources are not clipped. */
 
-     i = opb;
+     beg = opb << 1;
+     n   = 0U;
      do{
 
       if ((csr & 0x0800U) == 0U){    /* No X expansion */
@@ -344,54 +816,99 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
       shr[bit3 + 1U]  = ((csd[0] << dshl) << dshl) | (csd[1] >> dshr);
       shr[bit3 + 2U]  = ((csd[1] << dshl) << dshl);
 
-      /* Left cell: Create mask from colorkey */
+      srcc[n + 0U] = shr[0];
+      srcc[n + 1U] = shr[1];
+      srcm[n + 0U] = 0xFFFFFFFFU;
+      srcm[n + 1U] = 0xFFFFFFFFU;
+      n   += 2U;
 
-      m0   = shr[0] ^ cky;           /* Prepare for colorkey */
-      m0   = (((m0 & 0x77777777U) + 0x77777777U) | m0); /* Colorkey mask on the highest bit of pixel */
-      m0  &= 0x88888888U;            /* Mask out lower pixel bits */
-      m0   = (m0 - (m0 >> 3)) + m0;  /* Expand to lower pixels */
+      shr[0] = shr[2];
+      shr[1] = shr[3];
+      cnt --;
 
-      /* Left cell: Calculate low and high halves */
+     }while(cnt != 0U);
 
-      t0   = shr[0];
-      t1   = shr[0] & 0x88888888U;
-      t1   = t1 - (t1 >> 3);
-      t1   = (plh & t1) | (pll & (~t1));
+     rrpge_m_vidl_run(&bufl[0], &bufh[0], beg, &srcc[0], &srcm[0], n, cky, plh, pll);
 
-      /* Left cell: Combine destination */
+    }else if ((csr & 0x0040U) == 0U){ /* Positioned source */
 
-      bufl[(i << 1) + 0U] = (t0 & m0) | (bufl[(i << 1) + 0U] & (~m0));
-      bufh[(i << 1) + 0U] = (t1 & m0) | (bufh[(i << 1) + 0U] & (~m0));
+     /* Initial (begin) mask */
 
-      /* Right cell: Create mask from colorkey */
+     if (bit3 == 0U){
+      m0 = 0xFFFFFFFFU >> dshr;
+      m1 = 0xFFFFFFFFU;
+     }else{
+      m0 = 0x00000000U;
+      m1 = 0xFFFFFFFFU >> dshr;
+     }
 
-      m1   = shr[1] ^ cky;           /* Prepare for colorkey */
-      m1   = (((m1 & 0x77777777U) + 0x77777777U) | m1); /* Colorkey mask on the highest bit of pixel */
-      m1  &= 0x88888888U;            /* Mask out lower pixel bits */
-      m1   = (m1 - (m1 >> 3)) + m1;  /* Expand to lower pixels */
+     /* Collect the source cells with their begin / end and clipping masks,
+     ** then combine them over the render buffer. */
 
-      /* Right cell: Calculate low and high halves */
+     spos = 0U;
+     i    = (cmd >> 4) & 0x3FU;   /* Cell pair offset */
+     beg  = i << 1;
+     n    = 0U;
+     shr[0] = 0U;                 /* Empty shift register's left (output cells) */
+     shr[1] = 0U;                 /* Necessary since OR further below does not replace contents over the necessary bit range! */
+     while (1){
 
-      t0   = shr[1];
-      t1   = shr[1] & 0x88888888U;
-      t1   = t1 - (t1 >> 3);
-      t1   = (plh & t1) | (pll & (~t1));
+      /* Determine if end cell pair, if so, do an end mask, otherwise fetch
+      ** source */
 
-      /* Right cell: Combine destination */
+      if (cnt == 0U){                /* End cell */
+       if (bit3 == 0U){
+        m0 = (0xFFFFFFFFU << dshl) << dshl;
+        m1 =  0x00000000U;
+       }else{
+        m0 =  0xFFFFFFFFU;
+        m1 = (0xFFFFFFFFU << dshl) << dshl;
+       }
+      }else{                         /* Not an end cell */
+       t0 = (soff + spos) & 0xFFFFU;
+       if ((csr & 0x0800U) == 0U){   /* No X expansion */
+        csd[0] = sbnk[t0     ];
+        csd[1] = sbnk[t0 | 1U];
+       }else{                        /* X expansion enabled */
+        t0     = sbnk[t0];
+        t1     = t0 & 0xFFFF0000U;
+        t1     = t1 | (t1 >> 8);
+        csd[0] = ((t1 & 0xFF00FF00U) >> 4) |
+                 ((t1 & 0x0F000F00U) >> 8) |
+                 ((t1 & 0xF000F000U));
+        t1     = t0 & 0x0000FFFFU;
+        t1     = t1 | (t1 << 8);
+        csd[1] = ((t1 & 0x00FF00FFU) << 4) |
+                 ((t1 & 0x00F000F0U) << 8) |
+                 ((t1 & 0x000F000FU));
+       }
+       spos += sadd;
+       shr[bit3 + 0U] |= (csd[0] >> dshr);
+       shr[bit3 + 1U]  = ((csd[0] << dshl) << dshl) | (csd[1] >> dshr);
+       shr[bit3 + 2U]  = ((csd[1] << dshl) << dshl);
+      }
 
-      bufl[(i << 1) + 1U] = (t0 & m1) | (bufl[(i << 1) + 1U] & (~m1));
-      bufh[(i << 1) + 1U] = (t1 & m1) | (bufh[(i << 1) + 1U] & (~m1));
+      srcc[n + 0U] = shr[0];
+      srcc[n + 1U] = shr[1];
+      srcm[n + 0U] = m0 & clpb[i];
+      srcm[n + 1U] = m1 & clpb[i];
+      n   += 2U;
 
       /* Done, finalize */
 
+      if (cnt == 0U){ break; }       /* End of render */
+      m0   = 0xFFFFFFFFU;            /* Clear (all enabled) mask */
+      m1   = 0xFFFFFFFFU;
       i    = (i + 1U) & 0x3FU;
       shr[0] = shr[2];
       shr[1] = shr[3];
       cnt --;
 
-     }while(cnt != 0U);
+     }
+
+     rrpge_m_vidl_run(&bufl[0], &bufh[0], beg, &srcc[0], &srcm[0], n, cky, plh, pll);
 
-    }else{                        /* Position and Tiled source */
+    }else{                        /* Tiled source */
 
      /* Initial (begin) mask */
 
@@ -432,21 +949,19 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
         m1 = (0xFFFFFFFFU << dshl) << dshl;
        }
       }else{                         /* Not an end cell */
-       t0 = (soff + spos) & 0xFFFFU;
-       if ((csr & 0x0040U) != 0U){   /* Tiled mode */
-        tds = tbnk[t0];              /* Load tile descriptor */
-        if ((cmd & 0x1000U) == 0U){  /* Normal mode (No pseudo 6 bit) */
-         sbnk = &(hnd->st.pram[(tds & 0xF0000U) & (PRAMS - 1U)]); /* Bank select for tile */
-         plh = (tds >> 28) & 0x7U;   /* Half-palettes */
-         pll = (tds >> 24) & 0x7U;
-         plh = rrpge_m_vidl_ex32[plh];
-         pll = rrpge_m_vidl_ex32[pll];
-         cky = (tds >> 20) & 0xFU;   /* Colorkey */
-         cky = rrpge_m_vidl_ex32[cky];
-        }
-        t0  = (tds >> 16) & 0xFFFFU; /* Source offset */
-        t0 ^= trow;
+       t0  = (soff + spos) & 0xFFFFU;
+       tds = tbnk[t0];               /* Load tile descriptor */
+       if ((cmd & 0x1000U) == 0U){   /* Normal mode (No pseudo 6 bit) */
+        sbnk = &(hnd->st.pram[(tds & 0xF0000U) & (PRAMS - 1U)]); /* Bank select for tile */
+        plh = (tds >> 28) & 0x7U;    /* Half-palettes */
+        pll = (tds >> 24) & 0x7U;
+        plh = rrpge_m_vidl_ex32[plh];
+        pll = rrpge_m_vidl_ex32[pll];
+        cky = (tds >> 20) & 0xFU;    /* Colorkey */
+        cky = rrpge_m_vidl_ex32[cky];
        }
+       t0  = (tds >> 16) & 0xFFFFU;  /* Source offset */
+       t0 ^= trow;
        if ((csr & 0x0800U) == 0U){   /* No X expansion */
         csd[0] = sbnk[t0     ];
         csd[1] = sbnk[t0 | 1U];
@@ -481,8 +996,7 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
       /* Left cell: Calculate low and high halves */
 
       t0   = shr[0];
-      if ( ((csr & 0x0040U) == 0U) ||
-           ((cmd & 0x1000U) == 0U) ){   /* Not Pseudo 6 bit mode in Tiled mode */
+      if ((cmd & 0x1000U) == 0U){    /* Not Pseudo 6 bit mode */
        t1   = shr[0] & 0x88888888U;
        t1   = t1 - (t1 >> 3);
        t1   = (plh & t1) | (pll & (~t1));
@@ -510,8 +1024,7 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
       /* Right cell: Calculate low and high halves */
 
       t0   = shr[1];
-      if ( ((csr & 0x0040U) == 0U) ||
-           ((cmd & 0x1000U) == 0U) ){   /* Not Pseudo 6 bit mode in Tiled mode */
+      if ((cmd & 0x1000U) == 0U){    /* Not Pseudo 6 bit mode */
        t1   = shr[1] & 0x88888888U;
        t1   = t1 - (t1 >> 3);
        t1   = (plh & t1) | (pll & (~t1));
@@ -551,27 +1064,31 @@ void rrpge_m_vidl(rrpge_object_t* hnd)
   }
 
   /* Line rendered in bufl & bufh, now combine the result to produce 6 bit
-  ** pixels. */
+  ** pixels, or directly the colors if the frame buffer's pixel format needs
+  ** them. */
+
+  if       ((lout == &buf[0]) || (hnd->frf == RRPGE_PIX_IDX8)){
+   rrpge_m_vidl_exp(lout, &bufl[0], &bufh[0]);
+  }else if (hnd->frf == RRPGE_PIX_RGB565){
+   rrpge_m_vidl_pix16((uint16*)(lout), &bufl[0], &bufh[0], &(hnd->frc[0]));
+  }else{
+   rrpge_m_vidl_pix32((uint32*)(lout), &bufl[0], &bufh[0], &(hnd->frc[0]));
+  }
 
-  for (i = 0U; i < 80U; i++){
-   m0 = bufl[i];
-   t1 = bufh[i];
-   t0 = ((m0 & 0x07070707U)     ) | ((t1 & 0x07070707U) << 3);
-   t1 = ((m0 & 0x70707070U) >> 4) | ((t1 & 0x70707070U) >> 1);
-   m0 = i << 3;
-   buf[m0 + 0U] = (uint8)((t1 >> 24)        );
-   buf[m0 + 1U] = (uint8)((t0 >> 24)        );
-   buf[m0 + 2U] = (uint8)((t1 >> 16) & 0xFFU);
-   buf[m0 + 3U] = (uint8)((t0 >> 16) & 0xFFU);
-   buf[m0 + 4U] = (uint8)((t1 >>  8) & 0xFFU);
-   buf[m0 + 5U] = (uint8)((t0 >>  8) & 0xFFU);
-   buf[m0 + 6U] = (uint8)((t1      ) & 0xFFU);
-   buf[m0 + 7U] = (uint8)((t0      ) & 0xFFU);
+ }else if (hnd->frb != RRPGE_M_NULL){
+
+  /* Odd line in double scan: repeats the line above. The pixel format
+  ** values are the log2 of the pixel sizes. */
+
+  for (i = 0U; i < (640U << (hnd->frf)); i++){
+   lout[i] = (lout - (hnd->frp))[i];
   }
 
  }
 
  /* Display list completed, the line is ready to be rendered */
 
- hnd->cb_lin(hnd, hnd->vid.vln, &buf[0]);
+ if (hnd->frb == RRPGE_M_NULL){
+  hnd->cb_lin(hnd, hnd->vid.vln, &buf[0]);
+ }
 }
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.13
+**  \date      2015.10.11
 */
 
 
@@ -16,6 +16,14 @@
 #include "rgm_info.h"
 
 
+/* Selects the line renderer kernels suiting the CPU. Called from the
+** Video emulation's init. */
+void rrpge_m_vidl_init(void);
+
+/* Converts a palette entry from the application state for the frame buffer's
+** pixel format. Called when the palette entry changes. */
+void rrpge_m_vidl_setpal(rrpge_object_t* hnd, auint id);
+
 /* Renders current graphics line. Also performs callback to host. */
 void rrpge_m_vidl(rrpge_object_t* hnd);
 
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.16
+**  \date      2015.10.12
 */
 
 
@@ -29,7 +29,11 @@
 **
 **  This must be called before any other RRPGE library function to set up the
 **  memory allocator. If omitted, every routine requiring allocation will
-**  return failure.
+**  return failure. The library's internal tables are built on the first call,
+**  later calls only change the allocator. Call it once, before starting any
+**  threads using the library: the allocator is not changed atomically, and
+**  the tables are only guarded against concurrent calls on compilers
+**  supporting atomic operations (GCC).
 **
 **  \param[in]   alc   Allocator function.
 **  \param[in]   fre   Free function.
@@ -38,6 +42,30 @@ void rrpge_init_lib(rrpge_malloc_t* alc, rrpge_free_t* fre);
 
 
 
+/**
+**  \brief     Sets up a zero filling allocator for emulation instances.
+**
+**  Emulation instances (rrpge_new_emu(), rrpge_new_emu_app(), rrpge_clone())
+**  are allocated by this allocator if set, otherwise by the allocator of
+**  rrpge_init_lib(). It must return zero filled memory, ideally committed only
+**  on first touch (such as an anonymous mapping, where the host may also
+**  request huge pages), so creating instances is cheap: the first reset of
+**  an instance does not clear its memories. If a releaser is also given,
+**  further resets release the memories through it instead of clearing them,
+**  so pages the application no longer uses are not kept committed.
+**
+**  Instances must be deleted with the same allocator set up as they were
+**  created with. Passing NULL for either the allocator or the free function
+**  turns the zero filling allocator off.
+**
+**  \param[in]   alz   Zero filling allocator function.
+**  \param[in]   frz   Free function for the zero filling allocator.
+**  \param[in]   rel   Releaser function, may be NULL.
+*/
+void rrpge_init_mem(rrpge_malloc_t* alz, rrpge_free_t* frz, rrpge_release_t* rel);
+
+
+
 /**
 **  \brief     Deletes any emulator library allocated object
 **
@@ -64,6 +92,74 @@ rrpge_object_t* rrpge_new_emu(rrpge_cbpack_t const* cb);
 
 
 
+/**
+**  \brief     Clones an emulator instance.
+**
+**  Creates a new emulator instance with the same emulation state as the
+**  passed one, ready to run without calling rrpge_init_run(). The line and
+**  kernel callbacks, and the rendering and native routine settings
+**  (rrpge_enarender(), rrpge_enanative()) are copied. The loaded application
+**  (code, initial data, header and descriptor) is shared between the
+**  instances, so the clone only needs memory for the emulation state. Of the
+**  memories only the pages the source wrote since its last reset are copied,
+**  so with a zero filling allocator (rrpge_init_mem()) the clone commits
+**  little more memory than the source changed. The source instance must be
+**  fully initialized (rrpge_init_run() completed with RRPGE_INI_RESET).
+**  Initializing any of the instances again gives it its own copy of the
+**  application. The instances may be used and deleted independently from
+**  different threads.
+**
+**  Not cloned: the frame buffer, its pixel format and the frame callback set
+**  by rrpge_setframe() belong to the source instance, so the clone renders
+**  through the line callback (as after rrpge_setframe() with no frame
+**  buffer). Call rrpge_setframe() on the clone to have it render frames. An
+**  input log the source records or replays is not attached to the clone.
+**  Breakpoints are not copied, and the clone starts with an empty execution
+**  profile (profiling is enabled for it if it was for the source).
+**
+**  \param[in]   hnd   Emulator instance to clone.
+**  \return            New emulator object or NULL if the source instance is
+**                     not initialized or allocation failed.
+*/
+rrpge_object_t* rrpge_clone(rrpge_object_t* hnd);
+
+
+
+/**
+**  \brief     Gets the application image of an emulator instance.
+**
+**  Returns the loaded application (code, initial data, header and
+**  descriptor) of a fully initialized emulator instance (rrpge_init_run()
+**  completed with RRPGE_INI_RESET), which may be used to create further
+**  instances of the same application by rrpge_new_emu_app(). The image is
+**  read only and reference counted: it has to be freed by rrpge_delete() once
+**  no more instances are to be created from it, and it remains valid while
+**  any instance created from it exists.
+**
+**  \param[in]   hnd   Emulator instance to get the application image of.
+**  \return            Application image or NULL if the instance is not
+**                     initialized.
+*/
+rrpge_app_t* rrpge_getapp(rrpge_object_t* hnd);
+
+
+
+/**
+**  \brief     Initializes emulator over an application image.
+**
+**  Like rrpge_new_emu(), but the new instance uses the passed application
+**  image (see rrpge_getapp()), so it is ready to run without calling
+**  rrpge_init_run(): the application is neither loaded nor checked again. It
+**  starts from reset state.
+**
+**  \param[in]   cb    Callback set filled with callbacks.
+**  \param[in]   app   Application image to use.
+**  \return            New emulator object or NULL if allocation failed.
+*/
+rrpge_object_t* rrpge_new_emu_app(rrpge_cbpack_t const* cb, rrpge_app_t* app);
+
+
+
 /**
 **  \brief     Runs initialization to completion.
 **
@@ -91,6 +187,13 @@ rrpge_iuint rrpge_init_run(rrpge_object_t* hnd, rrpge_iuint tg);
 **  only resuming the RRPGE system to the initial state. Only has effect if
 **  the emulator was sufficiently initialized (reached RRPGE_INI_RESET).
 **
+**  Only the memory pages written since the previous reset are restored, so
+**  resetting an instance which ran briefly is cheap. The memories are
+**  rewritten as a whole by the reset completing an initialization (so an
+**  instance initialized again with an other application keeps nothing of
+**  the previous one), and after the host replaced them (rrpge_attachstate(),
+**  rrpge_restore()).
+**
 **  /param[in]   hnd   Emulator instance to work with.
 */
 void rrpge_reset(rrpge_object_t* hnd);
@@ -146,6 +249,223 @@ rrpge_iuint rrpge_import(rrpge_object_t* hnd, rrpge_uint8 const* sta);
 
 
 
+/**
+**  \brief     Gets the size of snapshots.
+**
+**  \return            Size of the buffer rrpge_snapshot() needs in bytes.
+*/
+rrpge_iuint rrpge_snapsize(void);
+
+
+
+/**
+**  \brief     Takes a snapshot of the emulation.
+**
+**  Copies the complete emulation state including the internal state of the
+**  emulated components into the passed buffer in the library's native
+**  layout, without any conversion, so it is fast enough to be used every
+**  frame (for example for rewinding). The snapshot is only valid for the
+**  same build of the library within the same process: use rrpge_export()
+**  for saving states. Properties of the instance set by the host
+**  (callbacks, breakpoints, profiling, native User Library) are not part of
+**  the snapshot.
+**
+**  \param[in]   hnd   Emulator instance to take the snapshot of.
+**  \param[out]  buf   Snapshot buffer (rrpge_snapsize() bytes, aligned for
+**                     any type, such as by the allocator).
+*/
+void rrpge_snapshot(rrpge_object_t* hnd, void* buf);
+
+
+
+/**
+**  \brief     Restores a snapshot.
+**
+**  Restores an emulation state taken by rrpge_snapshot(). It can only succeed
+**  if the instance is initialized (rrpge_init_run() completed with
+**  RRPGE_INI_RESET) with the same application the snapshot was taken of.
+**  The snapshot may be restored into any instance of the application, so it
+**  may also be used to transfer states between instances. Kernel tasks which
+**  were in progress when taking the snapshot have to be ended by the host
+**  for the restored instance as well.
+**
+**  \param[in]   hnd   Emulator instance to restore into.
+**  \param[in]   buf   Snapshot buffer.
+**  \return            0 on success, failure code otherwise (RRPGE_ERR_INI if
+**                     the instance is not initialized or has an input log,
+**                     RRPGE_ERR_VER if the snapshot is not of its
+**                     application).
+*/
+rrpge_iuint rrpge_restore(rrpge_object_t* hnd, void const* buf);
+
+
+
+/**
+**  \brief     Creates a rewind buffer.
+**
+**  The rewind buffer captures the state of an emulator instance every given
+**  number of frames (see rrpge_rewind_frame()), so the emulation may be
+**  stepped back later (see rrpge_rewind_back()). A capture only stores the
+**  memory pages which changed since the previous capture along with the
+**  state of the emulated components, in a ring of the given size. The oldest
+**  captures are dropped as needed to fit. Besides the ring, the buffer holds
+**  a copy of the memories (about 4.3 Mbytes). It has to be freed by
+**  rrpge_delete(). It may be used with any instance of the application of the
+**  passed instance.
+**
+**  The captures rely on the dirty page tracking (see rrpge_getdirty()), and
+**  clear the dirty page bit maps: the host must not clear these while using
+**  a rewind buffer.
+**
+**  \param[in]   hnd   Emulator instance (must be initialized).
+**  \param[in]   bud   Size of the ring in bytes (memory budget). A capture
+**                     without changed pages takes about 32 Kbytes.
+**  \param[in]   per   Capture period in frames.
+**  \return            New rewind buffer or NULL if the instance is not
+**                     initialized or allocation failed.
+*/
+rrpge_rewind_t* rrpge_new_rewind(rrpge_object_t* hnd, rrpge_iuint bud,
+                                 rrpge_iuint per);
+
+
+
+/**
+**  \brief     Notifies a rewind buffer of a frame.
+**
+**  Should be called at every RRPGE_HLT_FRAME halt of the emulator instance
+**  for counting the frames, capturing its state as needed.
+**
+**  \param[in]   rew   Rewind buffer.
+**  \param[in]   hnd   Emulator instance.
+*/
+void rrpge_rewind_frame(rrpge_rewind_t* rew, rrpge_object_t* hnd);
+
+
+
+/**
+**  \brief     Gets the number of frames available for stepping back.
+**
+**  \param[in]   rew   Rewind buffer.
+**  \return            Number of frames since the oldest capture.
+*/
+rrpge_iuint rrpge_rewind_avail(rrpge_rewind_t* rew);
+
+
+
+/**
+**  \brief     Steps back the emulation.
+**
+**  Restores the newest capture made at least the given number of frames
+**  ago, or the oldest capture if there is no such one. The captures newer
+**  than the restored one are dropped, capturing continues from it. With a
+**  capture period of 1, the emulation may be stepped back by any number of
+**  frames within rrpge_rewind_avail(). Kernel tasks which were in progress
+**  at the restored capture have to be ended by the host as well. It has no
+**  effect while the instance records or replays an input log.
+**
+**  \param[in]   rew   Rewind buffer.
+**  \param[in]   hnd   Emulator instance.
+**  \param[in]   frm   Number of frames to step back.
+**  \return            Number of frames actually stepped back.
+*/
+rrpge_iuint rrpge_rewind_back(rrpge_rewind_t* rew, rrpge_object_t* hnd,
+                              rrpge_iuint frm);
+
+
+
+/**
+**  \brief     Starts recording an input log.
+**
+**  Records everything the emulator instance receives from the host into a
+**  log, so the session may be reproduced exactly by rrpge_play_start() and
+**  rrpge_play_run(). These are the rrpge_run() calls, the inputs
+**  (rrpge_dev_add(), rrpge_dev_rem(), rrpge_dev_push(), rrpge_pushpacket(),
+**  rrpge_set_clock(), rrpge_reset()), audio events consumed by
+**  rrpge_getaudio(), and the results of kernel tasks and kernel calls served
+**  by the host. Inputs are stamped with the frame and cycle they arrived at.
+**  The log is passed to the writer in blocks as it is produced. It is
+**  compact, a session without inputs takes a few bytes per audio event.
+**
+**  The log may only be replayed on an instance in the same state, so the
+**  recording should be started right after initialization (or a reset),
+**  before adding input devices. The emulation can not be altered by other
+**  means while recording or replaying: rrpge_restore(), rrpge_rewind_back(),
+**  rrpge_attachstate() and the memory and state setters of the debug
+**  interface are rejected. Kernel task results are taken at rrpge_taskend().
+**
+**  \param[in]   hnd   Emulator instance (must be initialized).
+**  \param[in]   wr    Writer receiving the log.
+**  \param[in]   ctx   Context passed to the writer.
+**  \return            0 on success, RRPGE_ERR_INI if the instance is not
+**                     initialized or already has a log.
+*/
+rrpge_iuint rrpge_rec_start(rrpge_object_t* hnd, rrpge_wrstream_t* wr, void* ctx);
+
+
+
+/**
+**  \brief     Ends recording an input log.
+**
+**  Writes the remaining data of the log and ends the recording. This is
+**  also done when deleting the instance.
+**
+**  \param[in]   hnd   Emulator instance.
+**  \return            Nonzero if the log was recorded and written
+**                     completely.
+*/
+rrpge_ibool rrpge_rec_stop(rrpge_object_t* hnd);
+
+
+
+/**
+**  \brief     Starts replaying an input log.
+**
+**  The instance has to be in the state the recording started from (for
+**  example a freshly initialized instance of the same application). While
+**  replaying, the instance only accepts input from the log: calls to the
+**  functions feeding it (see rrpge_rec_start()) have no effect, and the
+**  callbacks serving kernel tasks and kernel calls are not called. Other
+**  callbacks (such as the line callback) are called normally.
+**
+**  \param[in]   hnd   Emulator instance (must be initialized).
+**  \param[in]   rd    Reader providing the log.
+**  \param[in]   ctx   Context passed to the reader.
+**  \return            0 on success, RRPGE_ERR_INI if the instance is not
+**                     initialized or already has a log, RRPGE_ERR_VER if
+**                     the log is not valid or was recorded from a
+**                     different state.
+*/
+rrpge_iuint rrpge_play_start(rrpge_object_t* hnd, rrpge_rdstream_t* rd, void* ctx);
+
+
+
+/**
+**  \brief     Replays an input log up to the next run.
+**
+**  Replays the inputs of the log up to and including the next rrpge_run()
+**  call. The host may inspect the halt causes and fetch audio afterwards
+**  like after rrpge_run(). The replay runs as fast as possible, timing is
+**  up to the host.
+**
+**  \param[in]   hnd   Emulator instance.
+**  \return            Result (see \ref rrpge_play_results).
+*/
+rrpge_iuint rrpge_play_run(rrpge_object_t* hnd);
+
+
+
+/**
+**  \brief     Ends replaying an input log.
+**
+**  The instance accepts input from the host again afterwards. This is also
+**  done when deleting the instance.
+**
+**  \param[in]   hnd   Emulator instance.
+*/
+void rrpge_play_stop(rrpge_object_t* hnd);
+
+
+
 /**
 **  \brief     Runs the emulator.
 **
@@ -319,4 +639,52 @@ void rrpge_enarender(rrpge_object_t* hnd, rrpge_ibool tg);
 
 
 
+/**
+**  \brief     Sets up frame rendering.
+**
+**  Makes the instance render complete frames in a frame buffer supplied by
+**  the host instead of calling the line callback for every line. The frame
+**  buffer holds 400 lines of 640 pixels each in the requested pixel format
+**  (see \ref rrpge_pixel_formats), the lines following each other by the
+**  given pitch. With RRPGE_PIX_IDX8 the pixels are the palette indices the
+**  line callback would receive, the other formats hold the colors, which the
+**  library takes from the palette at the beginning of every frame and when
+**  the application sets a palette entry (so the host does not need to track
+**  the RRPGE_CB_SETPAL callback for them). When a rendered frame is
+**  completed, the frame callback is called (if any), so the host may process
+**  the frame at once, or at the RRPGE_HLT_FRAME halt cause. The buffer is
+**  written during rrpge_run(). The setting is not copied by rrpge_clone().
+**
+**  \param[in]   hnd   Emulation instance.
+**  \param[in]   buf   Frame buffer, NULL to return to the line callback. It
+**                     has to be aligned to the size of the pixels.
+**  \param[in]   pit   Pitch: distance of lines in the frame buffer in bytes
+**                     (at least 640 pixels, a multiple of the pixel size).
+**  \param[in]   fmt   Pixel format (see \ref rrpge_pixel_formats).
+**  \param[in]   cb    Frame callback. May be NULL.
+*/
+void rrpge_setframe(rrpge_object_t* hnd, void* buf, rrpge_iuint pit,
+                    rrpge_iuint fmt, rrpge_cb_frame_t* cb);
+
+
+
+/**
+**  \brief     Toggles native User Library routines.
+**
+**  Initially (after rrpge_new_emu()) native routines are OFF, and the User
+**  Library is emulated like any other application code. When turned ON, some
+**  frequently used User Library routines (PRAM pointer setups and fills) are
+**  run natively when entered through the User Library's jump table, if the
+**  User Library is intact in the application's code memory. The native
+**  routines produce the same emulation state and cycle counts, so this has no
+**  effect on the emulation state as seen through rrpge_peekstate(). It takes
+**  effect immediately.
+**
+**  \param[in]   hnd   Emulation instance.
+**  \param[in]   tg    0: Native routines OFF, nonzero: Native routines ON.
+*/
+void rrpge_enanative(rrpge_object_t* hnd, rrpge_ibool tg);
+
+
+
 #endif
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.04
+**  \date      2015.10.10
 */
 
 
@@ -36,6 +36,22 @@ typedef void rrpge_cb_line_t (rrpge_object_t* hnd, rrpge_iuint ln, rrpge_uint8 c
 
 
 
+/**
+**  \brief     Graphic frame output.
+**
+**  Alternative of the line callback when a frame buffer is set up by
+**  rrpge_setframe(). This is called when a frame is completed in the frame
+**  buffer, as the RRPGE_HLT_FRAME halt cause is produced. It is not called
+**  in frames where rendering is turned off. Note that this callback does not
+**  produce halt cause on execution.
+**
+**  \param[in]   hnd   Emulation instance the callback is called for.
+**  \param[in]   buf   The frame buffer as passed to rrpge_setframe().
+*/
+typedef void rrpge_cb_frame_t (rrpge_object_t* hnd, void const* buf);
+
+
+
 /**
 **  \brief     Generic kernel task callback.
 **
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.02
+**  \date      2015.10.12
 */
 
 
@@ -25,7 +25,10 @@
 **  with an RRPGE_HLT_BREAK cause before executing such an instruction.
 **  Calling rrpge_run() again will step over this breakpoint continuing the
 **  emulation. Any number of breakpoints may be set. The library might only
-**  respect these if they are first words of an opcode.
+**  respect these if they are first words of an opcode. While breakpoints are
+**  set, the instance uses its own copy of the pre-decoded code (about 2
+**  Megabytes). If it can not be allocated, the breakpoint is not set (which
+**  may be checked by rrpge_isbreak()).
 **
 **  \param[in]   hnd   Emulation instance.
 **  \param[in]   adr   Address to set as breakpoint (only low 16 bits used).
@@ -55,6 +58,102 @@ void rrpge_rembreak(rrpge_object_t* hnd, rrpge_iuint adr);
 
 
 
+/**
+**  \brief     Toggles execution profiling.
+**
+**  Initially (after rrpge_new_emu()) profiling is OFF. When turned ON, the
+**  library accumulates the number of executions, the CPU cycles consumed
+**  (including the stalls of User Peripheral Area accesses) and the
+**  Peripheral bus stall cycles generated (by PRAM and FIFO accesses) for
+**  every instruction by its code address. Profiling has no effect on the
+**  emulation state, however the emulation becomes slower. Turning it OFF
+**  keeps the accumulated profile. The memory of the profile (768 KBytes) is
+**  allocated when profiling is first turned ON: if this fails, profiling
+**  stays OFF. A clone (rrpge_clone()) of a profiling instance starts with an
+**  empty profile.
+**
+**  \param[in]   hnd   Emulation instance.
+**  \param[in]   tg    0: Profiling OFF, nonzero: Profiling ON.
+*/
+void rrpge_enaprofile(rrpge_object_t* hnd, rrpge_ibool tg);
+
+
+
+/**
+**  \brief     Clears the execution profile.
+**
+**  \param[in]   hnd   Emulation instance.
+*/
+void rrpge_clrprofile(rrpge_object_t* hnd);
+
+
+
+/**
+**  \brief     Gets the execution profile of a code address.
+**
+**  Returns the profile accumulated for the instruction at the given Code ROM
+**  address since the last rrpge_clrprofile() (see rrpge_enaprofile()). The
+**  counters are 32 bits, wrapping around. If profiling was never turned ON,
+**  all are zero.
+**
+**  \param[in]   hnd   Emulation instance.
+**  \param[in]   adr   Address to query (only low 16 bits used).
+**  \param[out]  cyc   CPU cycles consumed by the instruction. May be NULL.
+**  \param[out]  cys   Peripheral bus stall cycles generated. May be NULL.
+**  \return            Number of times the instruction was executed.
+*/
+rrpge_iuint rrpge_getprofile(rrpge_object_t* hnd, rrpge_iuint adr,
+                             rrpge_iuint* cyc, rrpge_iuint* cys);
+
+
+
+/**
+**  \brief     Gets the dirty page bit map of a memory.
+**
+**  The emulation marks every page of the Peripheral RAM and the CPU Data
+**  memory (including the stack) which is written by any means (the CPU, the
+**  peripherals, kernel calls, the host through the setters or the task
+**  callbacks) as dirty. A reset marks the pages it restores dirty (all pages
+**  on the first reset), rrpge_attachstate() marks all pages dirty.
+**  The bit map has one bit for each page of RRPGE_DIRTY_PAGE cells, page 0
+**  corresponding to the highest bit of the first word.
+**
+**  \param[in]   hnd   Emulation instance.
+**  \param[in]   mem   Memory to query (RRPGE_DIRTY_PRAM or RRPGE_DIRTY_DRAM).
+**  \param[out]  bmp   Bit map output. May be NULL to only get the size.
+**  \return            Size of the bit map in 32 bit words. Zero if the memory
+**                     is invalid.
+*/
+rrpge_iuint rrpge_getdirty(rrpge_object_t* hnd, rrpge_iuint mem,
+                           rrpge_uint32* bmp);
+
+
+
+/**
+**  \brief     Clears the dirty page bit map of a memory.
+**
+**  \param[in]   hnd   Emulation instance.
+**  \param[in]   mem   Memory to clear (RRPGE_DIRTY_PRAM or RRPGE_DIRTY_DRAM).
+*/
+void rrpge_clrdirty(rrpge_object_t* hnd, rrpge_iuint mem);
+
+
+
+/**
+**  \brief     Gets a value from the Code ROM.
+**
+**  Gets a 16 bit word from the Code ROM (the application's code and the User
+**  Library), such as for disassembling or profiling the executed code. The
+**  Code ROM can not be changed.
+**
+**  \param[in]   hnd   Emulation instance.
+**  \param[in]   adr   Address of cell to retrieve (only low 16 bits used).
+**  \return            Cell value (16 bits).
+*/
+rrpge_iuint rrpge_get_code(rrpge_object_t* hnd, rrpge_iuint adr);
+
+
+
 /**
 **  \brief     Gets a value from the PRAM.
 **
@@ -74,6 +173,7 @@ rrpge_iuint rrpge_get_pram(rrpge_object_t* hnd, rrpge_iuint adr);
 **
 **  Sets a 32 bit value in the Peripheral RAM. If the address is out of range,
 **  no effect. The value is truncated to 32 bits (if applicable).
+**  No effect while the instance records or replays an input log.
 **
 **  \param[in]   hnd   Emulation instance.
 **  \param[in]   adr   Address of cell to change.
@@ -103,6 +203,7 @@ rrpge_iuint rrpge_get_dram(rrpge_object_t* hnd, rrpge_iuint adr);
 **
 **  Sets a 16 bit value in the Data RAM. If the address is out of range, no
 **  effect. The value is truncated to 16 bits.
+**  No effect while the instance records or replays an input log.
 **
 **  \param[in]   hnd   Emulation instance.
 **  \param[in]   adr   Address of cell to change.
@@ -135,6 +236,7 @@ rrpge_iuint rrpge_get_state(rrpge_object_t* hnd, rrpge_iuint adr);
 **  within 0x040 - 0x3FF), no effect. The value is truncated to 16 bits, then
 **  it may also be limited according to the given State cell's constraints,
 **  see the RRPGE specification for details.
+**  No effect while the instance records or replays an input log.
 **
 **  \param[in]   hnd   Emulation instance.
 **  \param[in]   adr   Address of cell to change.
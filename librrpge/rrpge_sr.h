@@ -2,11 +2,11 @@
 **  \file
 **  \brief     LibRRPGE standard header package - serialization helpers
 **  \author    Sandor Zsuga (Jubatian)
-**  \copyright 2013 - 2014, GNU GPLv3 (version 3 of the GNU General Public
+**  \copyright 2013 - 2015, GNU GPLv3 (version 3 of the GNU General Public
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2014.12.10
+**  \date      2015.10.07
 */
 
 
@@ -74,4 +74,70 @@ void rrpge_raw2state(rrpge_uint8 const * src, rrpge_state_t* dst);
 
 
 
+/**
+**  \brief     Stream writer
+**
+**  Writer function interface for the compressed state serialization. It may
+**  for example write the data into a file.
+**
+**  \param[in]   ctx   Context passed to rrpge_state2cmp().
+**  \param[in]   buf   Data to write.
+**  \param[in]   len   Count of bytes to write.
+**  \return            Nonzero on success, zero if writing failed.
+*/
+typedef rrpge_ibool rrpge_wrstream_t (void* ctx, rrpge_uint8 const* buf, rrpge_iuint len);
+
+
+
+/**
+**  \brief     Stream reader
+**
+**  Reader function interface for the compressed state deserialization.
+**
+**  \param[in]   ctx   Context passed to rrpge_cmp2state().
+**  \param[out]  buf   Buffer to read into.
+**  \param[in]   len   Count of bytes to read.
+**  \return            Count of bytes read (less than requested if the stream
+**                     ended or reading failed).
+*/
+typedef rrpge_iuint rrpge_rdstream_t (void* ctx, rrpge_uint8* buf, rrpge_iuint len);
+
+
+
+/**
+**  \brief     Serializes state compressed.
+**
+**  Produces the raw binary representation of the state like
+**  rrpge_state2raw(), compressed. The state data is processed in blocks, and
+**  it is passed to the writer as it is produced, so the complete raw state is
+**  never needed in memory. Zero runs and repeating data (typical in the
+**  PRAM) are compressed well, an empty PRAM takes a few Kbytes.
+**
+**  \param[in]   src   Emulator state.
+**  \param[in]   wr    Writer function.
+**  \param[in]   ctx   Context passed to the writer.
+**  \return            Count of bytes written, zero if the writer failed.
+*/
+rrpge_iuint rrpge_state2cmp(rrpge_state_t const* src, rrpge_wrstream_t* wr, void* ctx);
+
+
+
+/**
+**  \brief     Deserializes compressed state.
+**
+**  Reads a state produced by rrpge_state2cmp() filling a state data
+**  structure (see rrpge_raw2state()).
+**
+**  \param[in]   rd    Reader function.
+**  \param[in]   ctx   Context passed to the reader.
+**  \param[out]  dst   Emulator state.
+**  \return            0 on success, failure code otherwise (RRPGE_ERR_VER if
+**                     the data is not a compressed state, RRPGE_ERR_UNK if it
+**                     is corrupt or ended early). The state may be partially
+**                     filled on failure.
+*/
+rrpge_iuint rrpge_cmp2state(rrpge_rdstream_t* rd, void* ctx, rrpge_state_t* dst);
+
+
+
 #endif
@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.08.26
+**  \date      2015.10.11
 */
 
 
@@ -74,6 +74,22 @@ typedef void  rrpge_free_t (void* ptr);
 
 
 
+/**
+**  \brief     Memory releaser
+**
+**  Releases the contents of a memory area allocated by a zero filling
+**  allocator (see rrpge_init_mem()): after it returns, the area must read
+**  zero. The host may give the backing pages of the area back to the system
+**  (such as by madvise(MADV_DONTNEED) on an anonymous mapping), clearing only
+**  the partial pages at its ends.
+**
+**  \param[in]   ptr   Start of the memory area.
+**  \param[in]   siz   Size of the memory area in bytes (uint8).
+*/
+typedef void  rrpge_release_t (void* ptr, rrpge_iuint siz);
+
+
+
 /**
 **  \brief     Emulator instance object
 **
@@ -82,6 +98,23 @@ typedef void  rrpge_free_t (void* ptr);
 */
 typedef struct rrpge_object_s rrpge_object_t;
 
+/**
+**  \brief     Application image object
+**
+**  Use for pointers (handles) to loaded application images which may be
+**  shared by emulator instances (see rrpge_getapp()). The RRPGE library
+**  implementation fills it up with content the way it needs.
+*/
+typedef struct rrpge_app_s rrpge_app_t;
+
+/**
+**  \brief     Rewind buffer object
+**
+**  Use for pointers (handles) to rewind buffers (see rrpge_new_rewind()). The
+**  RRPGE library implementation fills it up with content the way it needs.
+*/
+typedef struct rrpge_rewind_s rrpge_rewind_t;
+
 
 
 /**
@@ -308,6 +341,58 @@ typedef struct{
 
 
 
+/**
+**  \anchor    rrpge_pixel_formats
+**  \name      Frame buffer pixel formats for rrpge_setframe()
+**
+**  The formats in which the emulator may render in the host's frame buffer.
+**  The colors are produced from the palette (RRPGE_STA_PAL), expanding its 4
+**  bit color channels to the channel widths of the format.
+**
+**  \{ */
+/** 8 bit palette indices, as the line callback would receive them */
+#define RRPGE_PIX_IDX8        0U
+/** 16 bit RGB: 5 bits red (high), 6 bits green, 5 bits blue (low) */
+#define RRPGE_PIX_RGB565      1U
+/** 32 bit RGB: 8 bits unused (high), 8 bits red, green and blue (low) */
+#define RRPGE_PIX_XRGB8888    2U
+/** \} */
+
+
+
+/**
+**  \anchor    rrpge_play_results
+**  \name      Results of rrpge_play_run()
+**
+**  \{ */
+/** A rrpge_run() call was replayed */
+#define RRPGE_PLAY_RUN        0U
+/** The log ended, the replay is complete */
+#define RRPGE_PLAY_END        1U
+/** The log is corrupt or the replay diverged from the recording (or there
+**  is no replay in progress) */
+#define RRPGE_PLAY_BAD        2U
+/** \} */
+
+
+
+/**
+**  \anchor    dirty_pages
+**  \name      Dirty page tracking
+**
+**  Memories and page size for rrpge_getdirty() and rrpge_clrdirty().
+**
+**  \{ */
+/** Size of a page in memory cells */
+#define RRPGE_DIRTY_PAGE      256U
+/** Peripheral RAM (4096 pages, 128 words of bit map) */
+#define RRPGE_DIRTY_PRAM      0U
+/** CPU Data memory including the stack (384 pages, 12 words of bit map) */
+#define RRPGE_DIRTY_DRAM      1U
+/** \} */
+
+
+
 /**
 **  \anchor    rrpge_dev_types
 **  \name      Input device types
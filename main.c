@@ -6,7 +6,7 @@
 **             License) extended as RRPGEvt (temporary version of the RRPGE
 **             License): see LICENSE.GPLv3 and LICENSE.RRPGEvt in the project
 **             root.
-**  \date      2015.09.16
+**  \date      2015.10.11
 */
 
 
@@ -15,6 +15,7 @@
 #include "host/screen.h"
 #include "host/audio.h"
 #include "host/filels.h"
+#include "host/prof.h"
 #include "iface/render.h"
 
 #include "librrpge/rrpge.h"
@@ -35,6 +36,9 @@ static uint8  main_tdata[128U * 1024U];
 /* File handle for the application (must be open while emulating) */
 static FILE*  main_app;
 
+/* Execution profiling requested (dumped on exit) */
+static auint  main_prof = 0U;
+
 /* Application name string */
 static char const* main_appname = "RRPGE simple SDL emulator. Version: " EMULATOR_VERSION;
 static char const* main_appicon = "RRPGE";
@@ -45,9 +49,8 @@ static char const* main_copyrig = "Copyright: 2013 - 2015, GNU GPLv3 (version 3
 
 
 /* Subroutines */
-static const rrpge_cbd_sub_t main_cbsub[1] = {
- { RRPGE_CB_SETPAL,    &render_pal         }
-};
+/* static const rrpge_cbd_sub_t main_cbsub[0] = { */
+/* }; */
 /* Tasks */
 static const rrpge_cbd_tsk_t main_cbtsk[1] = {
  { RRPGE_CB_LOADBIN,   &main_loadbin       }
@@ -56,13 +59,15 @@ static const rrpge_cbd_tsk_t main_cbtsk[1] = {
 /* static const rrpge_cbd_fun_t main_cbfun[0] = { */
 /* }; */
 
-/* Callback structure for the emulator. Only line rendering for now. */
+/* Callback structure for the emulator. Rendering is set up by the renderer
+** to whole frames with colors (see render_reset()), so there is no line
+** callback, and the palette needs no tracking. */
 static const rrpge_cbpack_t main_cbpack={
- &render_line,
+ NULL,
  1,                           /* Task callbacks */
  &main_cbtsk[0],
- 1,                           /* Subroutine callbacks */
- &main_cbsub[0],
+ 0,                           /* Subroutine callbacks */
+ NULL,
  0,                           /* Function callbacks */
  NULL
 };
@@ -222,11 +227,13 @@ int main(int argc, char** argv)
 
 
 
- /* Check arguments: need an application */
+ /* Check arguments: need an application, optionally followed by "-p" to
+ ** profile it */
  if (argc <= 1){
   printf("Error: need an application to run as parameter!\n");
   exit(1);
  }else{
+  if ((argc > 2) && (strcmp(argv[2], "-p") == 0)){ main_prof = 1U; }
   printf("Opening %s...\n", argv[1]);
   main_app = fopen(argv[1], "rb");
   if (main_app == NULL){
@@ -257,9 +264,7 @@ int main(int argc, char** argv)
   goto loadfault;
  }
  mid = rrpge_dev_add(emu, RRPGE_DEV_POINT); /* Add mouse (pointing device) */
-
- /* Initialize renderer */
- render_reset(emu);
+ rrpge_enaprofile(emu, main_prof);
 
  /* Initialize SDL */
  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO)!=0) return -1;
@@ -268,6 +273,9 @@ int main(int argc, char** argv)
  if (screen_set()!=0) return -1;
  SDL_WM_SetCaption(main_appname, main_appicon);
 
+ /* Initialize renderer (it renders in the screen) */
+ render_reset(emu);
+
  /* Set up audio */
  if (audio_set(2048U) != 0U) return -1;
 
@@ -387,6 +395,8 @@ int main(int argc, char** argv)
 
  printf("Trying to exit\n");
 
+ if (main_prof != 0U){ prof_dump(emu, stdout); }
+
  rrpge_delete(emu);
  audio_free();
  screen_free();
@@ -400,7 +410,7 @@ int main(int argc, char** argv)
 
 loadfault:
 
- if (emu != NULL) free(emu);
+ if (emu != NULL) rrpge_delete(emu);
  fclose(main_app);
 
  exit(1);